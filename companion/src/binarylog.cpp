@@ -0,0 +1,266 @@
+/*
+ * Copyright (C) OpenTX
+ *
+ * Based on code named
+ *   th9x - http://code.google.com/p/th9x
+ *   er9x - http://code.google.com/p/er9x
+ *   gruvin9x - http://code.google.com/p/gruvin9x
+ *
+ * License GPLv2: http://www.gnu.org/licenses/gpl-2.0.html
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#include "binarylog.h"
+#include <QDateTime>
+#include <QObject>
+
+#define LOGS_MAGIC             "OTLG"
+#define LOGS_BINARY_VERSION    1
+#define LOGS_BLOCK_SCHEMA      'S'
+#define LOGS_BLOCK_RECORD      'R'
+#define LOGS_SCHEMA_END        0xFF
+
+BinaryLogReader::BinaryLogReader()
+{
+  reset();
+}
+
+bool BinaryLogReader::isBinaryLog(const QByteArray & data)
+{
+  return data.startsWith(LOGS_MAGIC);
+}
+
+bool BinaryLogReader::readByte(quint8 & value)
+{
+  if (pos >= end)
+    return false;
+  value = *pos++;
+  return true;
+}
+
+bool BinaryLogReader::readVarint(quint32 & value)
+{
+  value = 0;
+  for (int shift = 0; shift < 35; shift += 7) {
+    quint8 byte;
+    if (!readByte(byte))
+      return false;
+    value |= (quint32)(byte & 0x7F) << shift;
+    if (!(byte & 0x80))
+      return true;
+  }
+  return false;
+}
+
+bool BinaryLogReader::readSchema(QList<Field> & fields)
+{
+  fields.clear();
+  while (true) {
+    Field field;
+    if (!readByte(field.type))
+      return false;
+    if (field.type == LOGS_SCHEMA_END)
+      return true;
+    if (field.type >= FIELD_TYPES_COUNT) {
+      error = QObject::tr("Unknown field type %1").arg(field.type);
+      return false;
+    }
+    if (!readByte(field.prec))
+      return false;
+    QByteArray label;
+    quint8 c;
+    while (true) {
+      if (!readByte(c))
+        return false;
+      if (!c)
+        break;
+      label.append(c);
+    }
+    field.label = QString::fromLatin1(label);
+    fields.append(field);
+  }
+}
+
+bool BinaryLogReader::readRecord(QVector<qint32> & values)
+{
+  int count = values.size();
+  QVector<quint8> changed((count + 7) / 8);
+  for (int i = 0; i < changed.size(); i++) {
+    if (!readByte(changed[i]))
+      return false;
+  }
+  for (int i = 0; i < count; i++) {
+    if (changed[i / 8] & (1 << (i % 8))) {
+      quint32 zigzag;
+      if (!readVarint(zigzag))
+        return false;
+      quint32 delta = (zigzag >> 1) ^ (0 - (zigzag & 1));
+      values[i] = (qint32)((quint32)values[i] + delta);
+    }
+  }
+  return true;
+}
+
+int BinaryLogReader::valuesCount(const Field & field)
+{
+  switch (field.type) {
+    case FIELD_RTC:
+    case FIELD_GPS:
+    case FIELD_DATETIME:
+    case FIELD_SWITCHES:
+      return 2;
+    default:
+      return 1;
+  }
+}
+
+static QString formatPrec(qint32 value, int prec)
+{
+  if (prec == 0)
+    return QString::number(value);
+  qint64 divider = 1;
+  for (int i = 0; i < prec; i++)
+    divider *= 10;
+  qint64 absValue = qAbs((qint64)value);
+  return QString("%1%2.%3").arg(value < 0 ? "-" : "").arg(absValue / divider).arg(absValue % divider, prec, 10, QChar('0'));
+}
+
+QString BinaryLogReader::formatField(const Field & field, const qint32 * values)
+{
+  switch (field.type) {
+    case FIELD_TIME:
+      return QString::number(values[0]);
+
+    case FIELD_RTC:
+      return QDateTime::fromTime_t((quint32)values[0], Qt::UTC).toString("yyyy-MM-dd,HH:mm:ss") + QString(".%1").arg(values[1], 2, 10, QChar('0')) + "0";
+
+    case FIELD_GPS:
+      if (values[0] && values[1])
+        return formatPrec(values[0], 6) + " " + formatPrec(values[1], 6);
+      return QString();
+
+    case FIELD_DATETIME:
+      return QString("%1-%2-%3 %4:%5:%6").arg(values[0], 4)
+                                         .arg((values[1] >> 22) & 0x0F, 2, 10, QChar('0'))
+                                         .arg((values[1] >> 17) & 0x1F, 2, 10, QChar('0'))
+                                         .arg((values[1] >> 12) & 0x1F, 2, 10, QChar('0'))
+                                         .arg((values[1] >> 6) & 0x3F, 2, 10, QChar('0'))
+                                         .arg(values[1] & 0x3F, 2, 10, QChar('0'));
+
+    case FIELD_SWITCHES:
+      return "0x" + QString("%1%2").arg((quint32)values[0], 8, 16, QChar('0')).arg((quint32)values[1], 8, 16, QChar('0')).toUpper();
+
+    default:
+      return formatPrec(values[0], field.prec);
+  }
+}
+
+void BinaryLogReader::reset()
+{
+  error.clear();
+  pending.clear();
+  pendingOffset = 0;
+  started = false;
+  schema = false;
+  fields.clear();
+  values.clear();
+  header.clear();
+}
+
+bool BinaryLogReader::toCsv(const QByteArray & data, QStringList & lines)
+{
+  reset();
+  lines.clear();
+  addData(data, lines);
+  return finish();
+}
+
+bool BinaryLogReader::addData(const QByteArray & data, QStringList & lines)
+{
+  if (!error.isEmpty())
+    return false;
+
+  pending.append(data);
+  const quint8 * start = (const quint8 *)pending.constData();
+  pos = start;
+  end = start + pending.size();
+
+  if (!started) {
+    // the magic and the version
+    if (pending.size() < (int)sizeof(LOGS_MAGIC))
+      return true;
+    if (!isBinaryLog(pending)) {
+      error = QObject::tr("Not a binary log file");
+      return false;
+    }
+    pos += sizeof(LOGS_MAGIC) - 1;
+    quint8 version;
+    if (!readByte(version) || version != LOGS_BINARY_VERSION) {
+      error = QObject::tr("Unsupported binary log version");
+      return false;
+    }
+    started = true;
+  }
+
+  const quint8 * blockStart = pos;
+  quint8 block;
+  while (readByte(block)) {
+    if (block == LOGS_BLOCK_SCHEMA) {
+      if (!readSchema(fields))
+        break;
+      schema = true;
+      int count = 0;
+      QStringList labels;
+      foreach (const Field & field, fields) {
+        count += valuesCount(field);
+        labels << field.label;
+      }
+      values.fill(0, count);
+      if (labels.join(",") != header) {
+        header = labels.join(",");
+        lines << header;
+      }
+    }
+    else if (block == LOGS_BLOCK_RECORD && schema) {
+      // the values are deltas, they are only updated once the whole record is there
+      QVector<qint32> recordValues = values;
+      if (!readRecord(recordValues))
+        break;
+      values = recordValues;
+      QStringList columns;
+      const qint32 * value = values.constData();
+      foreach (const Field & field, fields) {
+        columns << formatField(field, value);
+        value += valuesCount(field);
+      }
+      lines << columns.join(",");
+    }
+    else {
+      error = QObject::tr("Unexpected block at offset %1").arg(pendingOffset + (pos - 1 - start));
+      break;
+    }
+    blockStart = pos;
+  }
+
+  // the incomplete block is parsed again with the next data
+  pendingOffset += blockStart - start;
+  pending.remove(0, blockStart - start);
+  return error.isEmpty();
+}
+
+bool BinaryLogReader::finish()
+{
+  if (error.isEmpty() && !started) {
+    error = isBinaryLog(pending) ? QObject::tr("Unsupported binary log version") : QObject::tr("Not a binary log file");
+  }
+  pending.clear();
+  return error.isEmpty();
+}
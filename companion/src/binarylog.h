@@ -0,0 +1,90 @@
+/*
+ * Copyright (C) OpenTX
+ *
+ * Based on code named
+ *   th9x - http://code.google.com/p/th9x
+ *   er9x - http://code.google.com/p/er9x
+ *   gruvin9x - http://code.google.com/p/gruvin9x
+ *
+ * License GPLv2: http://www.gnu.org/licenses/gpl-2.0.html
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#ifndef _BINARYLOG_H_
+#define _BINARYLOG_H_
+
+#include <QByteArray>
+#include <QList>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+/*
+ * Reader for the binary logs written by firmwares built with LOGS_BINARY
+ * (see radio/src/logs.cpp for the format). Logs are converted to the same
+ * lines as the CSV logs, radio/util/log2csv.py does the same conversion
+ * from the command line.
+ */
+class BinaryLogReader
+{
+  public:
+    BinaryLogReader();
+
+    static bool isBinaryLog(const QByteArray & data);
+
+    // returns false if data is not a binary log, a truncated last record is silently dropped
+    bool toCsv(const QByteArray & data, QStringList & lines);
+
+    // converts a log given by pieces of any size, the lines of the records completed by data are appended to lines
+    bool addData(const QByteArray & data, QStringList & lines);
+    // to be called after the last piece, returns false if the log was invalid
+    bool finish();
+
+    QString errorString() const { return error; }
+
+  private:
+    enum FieldType {
+      FIELD_VALUE,
+      FIELD_TIME,
+      FIELD_RTC,
+      FIELD_GPS,
+      FIELD_DATETIME,
+      FIELD_SWITCHES,
+      FIELD_TYPES_COUNT
+    };
+
+    struct Field {
+      quint8 type;
+      quint8 prec;
+      QString label;
+    };
+
+    const quint8 * pos;
+    const quint8 * end;
+    QString error;
+    QByteArray pending;   // the bytes of the incomplete block at the end of the data received so far
+    qint64 pendingOffset; // offset of pending in the log
+    bool started;
+    bool schema;
+    QList<Field> fields;
+    QVector<qint32> values;
+    QString header;
+
+    void reset();
+    bool readByte(quint8 & value);
+    bool readVarint(quint32 & value);
+    bool readSchema(QList<Field> & fields);
+    bool readRecord(QVector<qint32> & values);
+    static int valuesCount(const Field & field);
+    static QString formatField(const Field & field, const qint32 * values);
+};
+
+#endif // _BINARYLOG_H_
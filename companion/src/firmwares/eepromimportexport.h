@@ -23,9 +23,114 @@
 
 #include "customdebug.h"
 #include <QtCore>
-#include <QBitArray>
 #include <utility>
 
+/*
+ * Streaming bit codec used by the DataField tree. Bits are packed LSB first,
+ * the bit i of the stream being the bit (i % 8) of the byte (i / 8)
+ */
+class BitWriter {
+  public:
+    explicit BitWriter(QByteArray & output):
+      output(output)
+    {
+    }
+
+    // Writes the low bits of value, the bits above 64 (if any) are 0
+    void write(uint64_t value, unsigned int bits)
+    {
+      count += bits;
+      while (bits > 0) {
+        unsigned int chunk = std::min(bits, 32u);
+        cache |= (value & ((uint64_t(1) << chunk) - 1)) << cacheBits;
+        cacheBits += chunk;
+        while (cacheBits >= 8) {
+          output.append(char(cache & 0xFF));
+          cache >>= 8;
+          cacheBits -= 8;
+        }
+        value >>= chunk;
+        bits -= chunk;
+      }
+    }
+
+    // Writes 0 bits up to the given position
+    void fill(unsigned int position)
+    {
+      if (position > count) {
+        write(0, position - count);
+      }
+    }
+
+    // Writes the last incomplete byte
+    void flush()
+    {
+      if (cacheBits > 0) {
+        output.append(char(cache & 0xFF));
+        cache = 0;
+        cacheBits = 0;
+      }
+    }
+
+    unsigned int position() const
+    {
+      return count;
+    }
+
+  protected:
+    QByteArray & output;
+    uint64_t cache = 0;
+    unsigned int cacheBits = 0;
+    unsigned int count = 0;
+};
+
+class BitReader {
+  public:
+    explicit BitReader(const QByteArray & input):
+      data((const uint8_t *)input.constData()),
+      count(input.size() * 8)
+    {
+    }
+
+    // Reads up to 64 bits, the bits after the end of the input are read as 0
+    uint64_t read(unsigned int bits)
+    {
+      uint64_t result = 0;
+      unsigned int done = 0;
+      while (done < bits) {
+        unsigned int shift = offset % 8;
+        unsigned int chunk = std::min(8 - shift, bits - done);
+        if (offset < count) {
+          uint64_t byte = data[offset / 8] >> shift;
+          result |= (byte & ((1u << chunk) - 1)) << done;
+        }
+        offset += chunk;
+        done += chunk;
+      }
+      return result;
+    }
+
+    void skip(unsigned int bits)
+    {
+      offset += bits;
+    }
+
+    void seek(unsigned int position)
+    {
+      offset = position;
+    }
+
+    unsigned int position() const
+    {
+      return offset;
+    }
+
+  protected:
+    const uint8_t * data;
+    unsigned int count;
+    unsigned int offset = 0;
+};
+
 class DataField {
   Q_DECLARE_TR_FUNCTIONS(DataField)
 
@@ -45,60 +150,44 @@ class DataField {
     }
 
     virtual unsigned int size() = 0; // size in bits
-    virtual void ExportBits(QBitArray & output) = 0;
-    virtual void ImportBits(const QBitArray & input) = 0;
-
-    static QBitArray bytesToBits(QByteArray bytes)
-    {
-      QBitArray bits(bytes.count()*8);
-      // Convert from QByteArray to QBitArray
-      for (int i=0; i<bytes.count(); ++i)
-        for (int b=0; b<8; ++b)
-          bits.setBit(i*8+b, bytes.at(i)&(1<<b));
-      return bits;
-    }
-
-    static QByteArray bitsToBytes(QBitArray bits, int offset=0)
-    {
-      QByteArray bytes;
-      bytes.resize((offset+bits.count()+7)/8);
-      bytes.fill(0);
-      // Convert from QBitArray to QByteArray
-      for (int b=0; b<bits.count(); ++b)
-        bytes[(b+offset)/8] = ( bytes.at((b+offset)/8) | ((bits[b]?1:0)<<((b+offset)%8)));
-      return bytes;
-    }
+    // Each field writes / reads exactly size() bits
+    virtual void ExportBits(BitWriter & output) = 0;
+    virtual void ImportBits(BitReader & input) = 0;
 
     int Export(QByteArray & output)
     {
-      QBitArray result;
-      ExportBits(result);
-      output = bitsToBytes(result);
+      output.clear();
+      BitWriter writer(output);
+      ExportBits(writer);
+      writer.flush();
       return 0;
     }
 
     int Import(const QByteArray & input)
     {
-      QBitArray bits = bytesToBits(input);
-      if (unsigned(bits.size()) < size()) {
-        qDebug() << QString("Error importing %1: size too small %2 bits / %3 bits").arg(getName()).arg(bits.size()).arg(size());
+      unsigned int bits = input.size() * 8;
+      if (bits < size()) {
+        qDebug() << QString("Error importing %1: size too small %2 bits / %3 bits").arg(getName()).arg(bits).arg(size());
         return -1;
       }
-      ImportBits(bits);
+      BitReader reader(input);
+      ImportBits(reader);
       return 0;
     }
 
     virtual int dump(int level=0, int offset=0)
     {
-      QBitArray bits;
-      ExportBits(bits);
-      QByteArray bytes = bitsToBytes(bits);
-      int result = (offset+bits.count()) % 8;
+      QByteArray bytes;
+      BitWriter writer(bytes);
+      ExportBits(writer);
+      writer.flush();
+      int bits = writer.position();
+      int result = (offset+bits) % 8;
       for (int i=0; i<level; i++) printf("  ");
-      if (bits.count() % 8 == 0)
+      if (bits % 8 == 0)
         printf("%s (%dbytes) ", getName().toLatin1().constData(), bytes.count());
       else
-        printf("%s (%dbits) ", getName().toLatin1().constData(), bits.count());
+        printf("%s (%dbits) ", getName().toLatin1().constData(), bits);
       for (int i=0; i<bytes.count(); i++) {
         unsigned char c = bytes[i];
         if ((i==0 && offset) || (i==bytes.count()-1 && result!=0))
@@ -165,27 +254,20 @@ class BaseUnsignedField: public DataField {
 
     BaseUnsignedField() = delete;
 
-    void ExportBits(QBitArray & output) override
+    void ExportBits(BitWriter & output) override
     {
       container value = field;
       if (value > max) value = max;
       if (value < min) value = min;
 
-      output.resize(N);
-      for (int i=0; i<N; i++) {
-        if (value & ((container)1<<i)) {
-          output.setBit(i);
-        }
-      }
+      output.write(value, N);
     }
 
-    void ImportBits(const QBitArray & input) override
+    void ImportBits(BitReader & input) override
     {
-      field = 0;
-      for (int i=0; i<N; i++) {
-        if (input[i])
-          field |= ((container)1<<i);
-      }
+      const unsigned int bits = std::min<unsigned int>(N, 8 * sizeof(container));
+      field = input.read(bits);
+      input.skip(N - bits);
       qCDebug(eepromImport) << QString("\timported %1<%2>: 0x%3(%4)").arg(name).arg(N).arg(field, 0, 16).arg(field);
     }
 
@@ -231,17 +313,15 @@ class BoolField: public DataField {
 
     BoolField() = delete;
 
-    void ExportBits(QBitArray & output) override
+    void ExportBits(BitWriter & output) override
     {
-      output.resize(N);
-      if (field) {
-        output.setBit(0);
-      }
+      output.write(field ? 1 : 0, N);
     }
 
-    void ImportBits(const QBitArray & input) override
+    void ImportBits(BitReader & input) override
     {
-      field = input[0];
+      field = input.read(1);
+      input.skip(N - 1);
       qCDebug(eepromImport) << QString("\timported %1<%2>: 0x%3(%4)").arg(name).arg(N).arg(field, 0, 16).arg(field);
     }
 
@@ -277,31 +357,22 @@ class SignedField: public DataField {
     {
     }
 
-    void ExportBits(QBitArray & output) override
+    void ExportBits(BitWriter & output) override
     {
       int value = field;
       if (value > max) value = max;
       if (value < min) value = min;
 
-      output.resize(N);
-      for (int i=0; i<N; i++) {
-        if (((unsigned int)value) & (1<<i))
-          output.setBit(i);
-      }
+      output.write((unsigned int)value, N);
     }
 
-    void ImportBits(const QBitArray & input) override
+    void ImportBits(BitReader & input) override
     {
-      unsigned int value = 0;
-      for (int i=0; i<N; i++) {
-        if (input[i])
-          value |= (1<<i);
-      }
+      unsigned int value = input.read(N);
 
-      if (input[N-1]) {
-        for (unsigned int i=N; i<8*sizeof(int); i++) {
-          value |= (1<<i);
-        }
+      // sign extension
+      if (N < 8*sizeof(int) && (value & (1u << (N-1)))) {
+        value |= ~0u << (N % (8*sizeof(int)));
       }
 
       field = (int)value;
@@ -342,30 +413,18 @@ class CharField: public DataField {
     {
     }
 
-    void ExportBits(QBitArray & output) override
+    void ExportBits(BitWriter & output) override
     {
-      output.resize(N*8);
-      int b = 0;
       int len = truncate ? strlen(field) : N;
       for (int i=0; i<N; i++) {
-        int idx = (i>=len ? 0 : field[i]);
-        for (int j=0; j<8; j++, b++) {
-          if (idx & (1<<j))
-            output.setBit(b);
-        }
+        output.write(uint8_t(i>=len ? 0 : field[i]), 8);
       }
     }
 
-    void ImportBits(const QBitArray & input) override
+    void ImportBits(BitReader & input) override
     {
-      unsigned int b = 0;
       for (int i=0; i<N; i++) {
-        int8_t idx = 0;
-        for (int j=0; j<8; j++) {
-          if (input[b++])
-            idx |= (1<<j);
-        }
-        field[i] = idx;
+        field[i] = int8_t(input.read(8));
       }
       qCDebug(eepromImport) << QString("\timported %1<%2>: '%3'").arg(name).arg(N).arg(field);
     }
@@ -417,30 +476,18 @@ class ZCharField: public DataField {
     {
     }
 
-    void ExportBits(QBitArray & output) override
+    void ExportBits(BitWriter & output) override
     {
-      output.resize(N*8);
-      int b = 0;
       int len = strlen(field);
       for (int i=0; i<N; i++) {
-        int idx = i>=len ? 0 : char2zchar(field[i]);
-        for (int j=0; j<8; j++, b++) {
-          if (idx & (1<<j))
-            output.setBit(b);
-        }
+        output.write(uint8_t(i>=len ? 0 : char2zchar(field[i])), 8);
       }
     }
 
-    void ImportBits(const QBitArray & input) override
+    void ImportBits(BitReader & input) override
     {
-      unsigned int b = 0;
       for (int i=0; i<N; i++) {
-        int8_t idx = 0;
-        for (int j=0; j<8; j++) {
-          if (input[b++])
-            idx |= (1<<j);
-        }
-        field[i] = zchar2char(idx);
+        field[i] = zchar2char(int8_t(input.read(8)));
       }
 
       field[N] = '\0';
@@ -480,29 +527,18 @@ class StructField: public DataField {
       fields.append(field);
     }
 
-    void ExportBits(QBitArray & output) override
+    void ExportBits(BitWriter & output) override
     {
-      int offset = 0;
-      output.resize(size());
       foreach(DataField *field, fields) {
-        QBitArray bits;
-        field->ExportBits(bits);
-        for (int i=0; i<bits.size(); i++)
-          output[offset++] = bits[i];
+        field->ExportBits(output);
       }
     }
 
-    void ImportBits(const QBitArray & input) override
+    void ImportBits(BitReader & input) override
     {
       qCDebug(eepromImport) << QString("\timporting %1[%2]:").arg(name).arg(fields.size());
-      int offset = 0;
       foreach(DataField *field, fields) {
-        unsigned int size = field->size();
-        QBitArray bits(size);
-        for (unsigned int i=0; i<size; i++) {
-          bits[i] = input[offset++];
-        }
-        field->ImportBits(bits);
+        field->ImportBits(input);
       }
     }
 
@@ -540,13 +576,13 @@ class TransformedField: public DataField {
     ~TransformedField() override
     = default;
 
-    void ExportBits(QBitArray & output) override
+    void ExportBits(BitWriter & output) override
     {
       beforeExport();
       field.ExportBits(output);
     }
 
-    void ImportBits(const QBitArray & input) override
+    void ImportBits(BitReader & input) override
     {
       qCDebug(eepromImport) << QString("\timporting TransformedField %1:").arg(field.getName());
       field.ImportBits(input);
@@ -619,25 +655,29 @@ class UnionField: public DataField {
         maxSize = member->getField()->size();
     }
 
-    void ExportBits(QBitArray & output) override
+    void ExportBits(BitWriter & output) override
     {
+      // the members smaller than the union are padded with 0
+      unsigned int start = output.position();
       foreach(UnionMember *member, members) {
         if (member->select(selectField)) {
           member->getField()->ExportBits(output);
           break;
         }
       }
-      output.resize(maxSize);
+      output.fill(start + maxSize);
     }
 
-    void ImportBits(const QBitArray & input) override
+    void ImportBits(BitReader & input) override
     {
+      unsigned int start = input.position();
       foreach(UnionMember *member, members) {
         if (member->select(selectField)) {
           member->getField()->ImportBits(input);
           break;
         }
       }
+      input.seek(start + maxSize);
     }
 
     unsigned int size() override
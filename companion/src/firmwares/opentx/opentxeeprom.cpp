@@ -25,6 +25,7 @@
 #include "opentxeeprom.h"
 #include "customdebug.h"
 #include "opentxinterface.h"
+#include <QMutexLocker>
 
 using namespace Board;
 
@@ -255,11 +256,14 @@ class SwitchesConversionTable: public ConversionTable {
     };
 
     static std::list<Cache> internalCache;
+    static QMutex internalCacheMutex;
 
   public:
 
     static SwitchesConversionTable * getInstance(Board::Type board, unsigned int version, unsigned long flags=0)
     {
+      // models may be decoded from several threads at a time
+      QMutexLocker locker(&internalCacheMutex);
       for (auto & element : internalCache) {
         if (element.board == board && element.version == version && element.flags == flags)
           return element.table;
@@ -271,6 +275,7 @@ class SwitchesConversionTable: public ConversionTable {
     }
     static void Cleanup()
     {
+      QMutexLocker locker(&internalCacheMutex);
       for (auto & element : internalCache) {
         delete element.table;
       }
@@ -279,6 +284,7 @@ class SwitchesConversionTable: public ConversionTable {
 };
 
 std::list<SwitchesConversionTable::Cache> SwitchesConversionTable::internalCache;
+QMutex SwitchesConversionTable::internalCacheMutex;
 
 #define FLAG_NONONE       0x01
 #define FLAG_NOSWITCHES   0x02
@@ -384,11 +390,13 @@ class SourcesConversionTable: public ConversionTable {
         SourcesConversionTable * table;
     };
     static std::list<Cache> internalCache;
+    static QMutex internalCacheMutex;
 
   public:
 
     static SourcesConversionTable * getInstance(Board::Type board, unsigned int version, unsigned int variant, unsigned long flags=0)
     {
+      QMutexLocker locker(&internalCacheMutex);
       for (std::list<Cache>::iterator it=internalCache.begin(); it!=internalCache.end(); it++) {
         Cache & element = *it;
         if (element.board == board && element.version == version && element.variant == variant && element.flags == flags)
@@ -401,6 +409,7 @@ class SourcesConversionTable: public ConversionTable {
     }
     static void Cleanup()
     {
+      QMutexLocker locker(&internalCacheMutex);
       for (std::list<Cache>::iterator it=internalCache.begin(); it!=internalCache.end(); it++) {
         Cache & element = *it;
         if (element.table)
@@ -411,6 +420,7 @@ class SourcesConversionTable: public ConversionTable {
 };
 
 std::list<SourcesConversionTable::Cache> SourcesConversionTable::internalCache;
+QMutex SourcesConversionTable::internalCacheMutex;
 
 void OpenTxEepromCleanup(void)
 {
@@ -1670,7 +1680,7 @@ class FrskyScreenField: public DataField {
         none.Append(new SpareBitsField<20*8>(this));
     }
 
-    void ExportBits(QBitArray & output) override
+    void ExportBits(BitWriter & output) override
     {
       if (screen.type == TELEMETRY_SCREEN_SCRIPT)
         script.ExportBits(output);
@@ -1682,7 +1692,7 @@ class FrskyScreenField: public DataField {
         none.ExportBits(output);
     }
 
-    void ImportBits(const QBitArray & input) override
+    void ImportBits(BitReader & input) override
     {
       qCDebug(eepromImport) << QString("importing %1: type: %2").arg(name).arg(screen.type);
 
@@ -0,0 +1,416 @@
+/*
+ * Copyright (C) OpenTX
+ *
+ * Based on code named
+ *   th9x - http://code.google.com/p/th9x
+ *   er9x - http://code.google.com/p/er9x
+ *   gruvin9x - http://code.google.com/p/gruvin9x
+ *
+ * License GPLv2: http://www.gnu.org/licenses/gpl-2.0.html
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#include "logdata.h"
+#include "binarylog.h"
+#include <QDateTime>
+#include <QFile>
+#include <algorithm>
+#include <string.h>
+
+// number of records sent to the GUI thread at once
+#define LOG_CHUNK_RECORDS      5000
+
+// size of the pieces of a binary log read at once
+#define LOG_BINARY_READ_SIZE   (1024 * 1024)
+
+// the pyramid levels stop when they get below this size
+#define LOG_PYRAMID_MIN_POINTS 1000
+
+// returns the given field of a CSV line, or nullptr if the line is too short
+static const char * findField(const char * data, int length, int column, int & fieldLength)
+{
+  const char * end = data + length;
+  for (; column > 0; column--) {
+    const char * comma = (const char *)memchr(data, ',', end - data);
+    if (!comma) {
+      fieldLength = 0;
+      return nullptr;
+    }
+    data = comma + 1;
+  }
+  const char * comma = (const char *)memchr(data, ',', end - data);
+  fieldLength = (comma ? comma : end) - data;
+  return data;
+}
+
+static bool readDigits(const char * & p, const char * end, int count, int & value)
+{
+  value = 0;
+  for (int i = 0; i < count; i++, p++) {
+    if (p >= end || *p < '0' || *p > '9')
+      return false;
+    value = value * 10 + (*p - '0');
+  }
+  return true;
+}
+
+static bool readChar(const char * & p, const char * end, char c)
+{
+  if (p >= end || *p != c)
+    return false;
+  p++;
+  return true;
+}
+
+void LogData::clear()
+{
+  fields.clear();
+  chunks.clear();
+  chunkStarts.clear();
+  times.clear();
+  sessionStarts.clear();
+  columns.clear();
+}
+
+void LogData::setHeader(const QStringList & header)
+{
+  clear();
+  fields = header;
+}
+
+void LogData::append(const LogChunk & chunk)
+{
+  if (chunk.offsets.isEmpty())
+    return;
+
+  chunkStarts.append(times.count());
+  foreach (double time, chunk.times) {
+    if (times.isEmpty() || time - times.last() > LOG_SESSION_GAP) {
+      sessionStarts.append(times.count());
+    }
+    times.append(time);
+  }
+
+  chunks.append(chunk);
+  chunks.last().times.clear();
+}
+
+const char * LogData::lineData(int row, int & length) const
+{
+  int index = std::upper_bound(chunkStarts.constBegin(), chunkStarts.constEnd(), row) - chunkStarts.constBegin() - 1;
+  const LogChunk & chunk = chunks.at(index);
+  int record = row - chunkStarts.at(index);
+  int start = chunk.offsets.at(record);
+  int end = (record + 1 < chunk.offsets.count() ? chunk.offsets.at(record + 1) : chunk.text.size());
+  length = end - start - 1;  // without the '\n'
+  return chunk.text.constData() + start;
+}
+
+QByteArray LogData::line(int row) const
+{
+  int length;
+  const char * data = lineData(row, length);
+  return QByteArray(data, length);
+}
+
+QString LogData::cell(int row, int column) const
+{
+  int length;
+  const char * data = lineData(row, length);
+  const char * field = findField(data, length, column, length);
+  return field ? QString::fromUtf8(field, length) : QString();
+}
+
+QVector<double> LogData::column(int column)
+{
+  QVector<double> & values = columns[column];
+  int count = times.count();
+  if (values.count() < count) {
+    values.reserve(count);
+    for (int row = values.count(); row < count; row++) {
+      int length;
+      const char * data = lineData(row, length);
+      const char * field = findField(data, length, column, length);
+      values.append(field ? QByteArray::fromRawData(field, length).toDouble() : 0);
+    }
+  }
+  return values;
+}
+
+LogLoader::LogLoader(const QString & fileName) :
+  fileName(fileName),
+  aborted(0),
+  fieldsCount(-1),
+  errors(0),
+  lines(-1),
+  cachedHour(-1),
+  cachedHourTime(0)
+{
+  qRegisterMetaType<LogChunk>();
+}
+
+void LogLoader::run()
+{
+  QFile file(fileName);
+  if (!file.open(QIODevice::ReadOnly)) {
+    emit finished(0, 0, tr("Cannot open %1: %2").arg(fileName).arg(file.errorString()));
+    return;
+  }
+
+  bool valid = true;
+  if (BinaryLogReader::isBinaryLog(file.peek(4))) {
+    // converted by pieces, the whole file is never in memory
+    BinaryLogReader reader;
+    QStringList logLines;
+    bool converted = true;
+    while (converted && valid && !file.atEnd() && !aborted.load()) {
+      logLines.clear();
+      converted = reader.addData(file.read(LOG_BINARY_READ_SIZE), logLines);
+      foreach (const QString & line, logLines) {
+        if (aborted.load() || !(valid = processLine(line.toUtf8())))
+          break;
+      }
+    }
+    if (!(converted && reader.finish()) && lines < 0) {
+      emit finished(0, 0, tr("The selected logfile is invalid: %1").arg(reader.errorString()));
+      return;
+    }
+  }
+  else {
+    while (!file.atEnd() && !aborted.load()) {
+      if (!(valid = processLine(file.readLine())))
+        break;
+    }
+  }
+
+  file.close();
+  flushChunk();
+  emit finished(errors, lines, valid ? QString() : tr("The selected logfile is invalid"));
+}
+
+bool LogLoader::processLine(QByteArray line)
+{
+  line = line.trimmed();
+  lines++;
+
+  if (fieldsCount < 0) {
+    if (!line.startsWith("Date,Time"))
+      return false;
+    fieldsCount = line.count(',') + 1;
+    emit headerParsed(QString::fromUtf8(line).split(','));
+    return true;
+  }
+
+  double time;
+  if (line.count(',') + 1 != fieldsCount || !parseTimeStamp(line.constData(), line.size(), time)) {
+    errors++;
+    return true;
+  }
+
+  chunk.offsets.append(chunk.text.size());
+  chunk.times.append(time);
+  chunk.text.append(line);
+  chunk.text.append('\n');
+
+  if (chunk.offsets.count() >= LOG_CHUNK_RECORDS) {
+    flushChunk();
+  }
+
+  return true;
+}
+
+void LogLoader::flushChunk()
+{
+  if (!chunk.offsets.isEmpty()) {
+    emit chunkParsed(chunk);
+    chunk = LogChunk();
+  }
+}
+
+bool LogLoader::parseTimeStamp(const char * data, int length, double & result)
+{
+  // yyyy-MM-dd,HH:mm:ss[.zzz], in local time
+  const char * p = data;
+  const char * end = data + length;
+  int year, month, day, hour, minute, second;
+
+  if (!readDigits(p, end, 4, year) || !readChar(p, end, '-') ||
+      !readDigits(p, end, 2, month) || !readChar(p, end, '-') ||
+      !readDigits(p, end, 2, day) || !readChar(p, end, ',') ||
+      !readDigits(p, end, 2, hour) || !readChar(p, end, ':') ||
+      !readDigits(p, end, 2, minute) || !readChar(p, end, ':') ||
+      !readDigits(p, end, 2, second) || minute > 59 || second > 59) {
+    return false;
+  }
+
+  double fraction = 0;
+  if (readChar(p, end, '.')) {
+    double scale = 0.1;
+    for (; p < end && *p >= '0' && *p <= '9'; p++) {
+      fraction += (*p - '0') * scale;
+      scale /= 10;
+    }
+  }
+  if (p < end && *p != ',') {
+    return false;
+  }
+
+  // QDateTime is far too slow to be used on each record, it is only used once per hour of log
+  int hourKey = ((year * 13 + month) * 32 + day) * 24 + hour;
+  if (hourKey != cachedHour) {
+    QDateTime hourTime(QDate(year, month, day), QTime(hour, 0));
+    if (!hourTime.isValid())
+      return false;
+    cachedHour = hourKey;
+    cachedHourTime = hourTime.toMSecsSinceEpoch() / 1000.0;
+  }
+
+  result = cachedHourTime + minute * 60 + second + fraction;
+  return true;
+}
+
+void LogPlotPyramid::setData(const QVector<double> & x, const QVector<double> & y)
+{
+  levels.resize(1);
+  Level & samples = levels[0];
+
+  if (std::is_sorted(x.constBegin(), x.constEnd())) {
+    samples.x = x;
+    samples.y = y;
+  }
+  else {
+    // the clock may have been adjusted during the flight
+    QVector<int> order(x.size());
+    for (int i = 0; i < order.size(); i++) {
+      order[i] = i;
+    }
+    std::stable_sort(order.begin(), order.end(), [&x](int a, int b) { return x.at(a) < x.at(b); });
+    samples.x.clear();
+    samples.y.clear();
+    samples.x.reserve(order.size());
+    samples.y.reserve(order.size());
+    foreach (int i, order) {
+      samples.x.append(x.at(i));
+      samples.y.append(y.at(i));
+    }
+  }
+
+  // the first level halves the number of samples, the next ones divide it by 4
+  while (levels.last().x.size() > LOG_PYRAMID_MIN_POINTS) {
+    Level level;
+    decimate(levels.last(), levels.size() == 1 ? 4 : 8, level);
+    levels.append(level);
+  }
+}
+
+void LogPlotPyramid::decimate(const Level & source, int bucketSize, Level & result)
+{
+  const double * x = source.x.constData();
+  const double * y = source.y.constData();
+  int count = source.x.size();
+
+  result.x.reserve(2 * (count / bucketSize + 1));
+  result.y.reserve(2 * (count / bucketSize + 1));
+
+  for (int start = 0; start < count; start += bucketSize) {
+    int end = std::min(start + bucketSize, count);
+    int lowest = start, highest = start;
+    for (int i = start + 1; i < end; i++) {
+      if (y[i] < y[lowest])
+        lowest = i;
+      if (y[i] > y[highest])
+        highest = i;
+    }
+    // keep them in time order
+    int first = std::min(lowest, highest);
+    int second = std::max(lowest, highest);
+    result.x.append(x[first]);
+    result.y.append(y[first]);
+    if (second != first) {
+      result.x.append(x[second]);
+      result.y.append(y[second]);
+    }
+  }
+}
+
+void LogPlotPyramid::getRange(double lower, double upper, int maxPoints, QVector<double> & x, QVector<double> & y) const
+{
+  x.clear();
+  y.clear();
+
+  for (int i = 0; i < levels.size(); i++) {
+    const Level & level = levels.at(i);
+    int first = std::lower_bound(level.x.constBegin(), level.x.constEnd(), lower) - level.x.constBegin();
+    int last = std::upper_bound(level.x.constBegin(), level.x.constEnd(), upper) - level.x.constBegin();
+    if (last - first <= maxPoints || i == levels.size() - 1) {
+      // one more sample on each side, so that the lines go up to the edges of the plot
+      first = std::max(first - 1, 0);
+      last = std::min(last + 1, level.x.size());
+      x = level.x.mid(first, last - first);
+      y = level.y.mid(first, last - first);
+      return;
+    }
+  }
+}
+
+LogTableModel::LogTableModel(LogData & logData, QObject * parent) :
+  QAbstractTableModel(parent),
+  logData(logData)
+{
+}
+
+int LogTableModel::rowCount(const QModelIndex & parent) const
+{
+  return parent.isValid() ? 0 : logData.rowCount();
+}
+
+int LogTableModel::columnCount(const QModelIndex & parent) const
+{
+  return parent.isValid() ? 0 : logData.columnCount();
+}
+
+QVariant LogTableModel::data(const QModelIndex & index, int role) const
+{
+  if (!index.isValid() || role != Qt::DisplayRole)
+    return QVariant();
+  return logData.cell(index.row(), index.column());
+}
+
+QVariant LogTableModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+  if (orientation == Qt::Horizontal && role == Qt::DisplayRole && section < logData.columnCount())
+    return logData.header().at(section);
+  return QAbstractTableModel::headerData(section, orientation, role);
+}
+
+void LogTableModel::clear()
+{
+  beginResetModel();
+  logData.clear();
+  endResetModel();
+}
+
+void LogTableModel::setHeader(const QStringList & header)
+{
+  beginResetModel();
+  logData.setHeader(header);
+  endResetModel();
+}
+
+void LogTableModel::append(const LogChunk & chunk)
+{
+  if (chunk.offsets.isEmpty())
+    return;
+  int first = logData.rowCount();
+  beginInsertRows(QModelIndex(), first, first + chunk.offsets.count() - 1);
+  logData.append(chunk);
+  endInsertRows();
+}
@@ -0,0 +1,164 @@
+/*
+ * Copyright (C) OpenTX
+ *
+ * Based on code named
+ *   th9x - http://code.google.com/p/th9x
+ *   er9x - http://code.google.com/p/er9x
+ *   gruvin9x - http://code.google.com/p/gruvin9x
+ *
+ * License GPLv2: http://www.gnu.org/licenses/gpl-2.0.html
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#ifndef _LOGDATA_H_
+#define _LOGDATA_H_
+
+#include <QAbstractTableModel>
+#include <QAtomicInt>
+#include <QByteArray>
+#include <QHash>
+#include <QMetaType>
+#include <QStringList>
+#include <QVector>
+
+// a new flight session starts when two records are more than this apart (in seconds)
+#define LOG_SESSION_GAP        60
+
+// A block of records parsed by the LogLoader, handed over to the GUI thread
+struct LogChunk {
+  QByteArray text;          // the records, each one terminated by '\n'
+  QVector<int> offsets;     // start of each record in text
+  QVector<double> times;    // timestamp of each record, in seconds since the epoch
+};
+
+Q_DECLARE_METATYPE(LogChunk)
+
+/*
+ * The records of a log, kept as their raw text plus the timestamp of each record.
+ * The text stays in the chunks it was parsed in, so it takes about the size of the
+ * CSV file in memory and the offsets of the records stay small whatever the log size.
+ * Numeric columns are only parsed when they are asked for (when they are plotted),
+ * then cached and extended as new records are appended.
+ */
+class LogData
+{
+  public:
+    void clear();
+
+    void setHeader(const QStringList & header);
+    const QStringList & header() const { return fields; }
+    int columnCount() const { return fields.count(); }
+    int rowCount() const { return times.count(); }
+
+    void append(const LogChunk & chunk);
+
+    double time(int row) const { return times.at(row); }
+    const QVector<double> & timeColumn() const { return times; }
+    // first record of each flight session
+    const QVector<int> & sessions() const { return sessionStarts; }
+
+    QByteArray line(int row) const;
+    QString cell(int row, int column) const;
+    QVector<double> column(int column);
+
+  private:
+    QStringList fields;
+    QVector<LogChunk> chunks;   // without their times
+    QVector<int> chunkStarts;   // first record of each chunk
+    QVector<double> times;
+    QVector<int> sessionStarts;
+    QHash<int, QVector<double> > columns;
+
+    const char * lineData(int row, int & length) const;
+};
+
+/*
+ * Reads a CSV or binary log on a background thread and streams its records
+ * to the GUI thread by chunks, while the file is still being read.
+ */
+class LogLoader : public QObject
+{
+  Q_OBJECT
+
+  public:
+    explicit LogLoader(const QString & fileName);
+
+    // may be called from any thread
+    void abort() { aborted = 1; }
+
+  public slots:
+    void run();
+
+  signals:
+    void headerParsed(const QStringList & header);
+    void chunkParsed(const LogChunk & chunk);
+    void finished(int errors, int lines, const QString & error);
+
+  private:
+    QString fileName;
+    QAtomicInt aborted;
+    LogChunk chunk;
+    int fieldsCount;
+    int errors;
+    int lines;
+    int cachedHour;
+    double cachedHourTime;
+
+    bool processLine(QByteArray line);
+    void flushChunk();
+    // parses the "Date,Time" columns of a record, returns false if they are invalid
+    bool parseTimeStamp(const char * data, int length, double & result);
+};
+
+/*
+ * Min/max preserving downsampling pyramid of a plotted column. Each level keeps the lowest
+ * and the highest sample of each bucket of the level below, so that the peaks are still
+ * drawn whatever the zoom, while no more than about two samples per pixel are plotted.
+ */
+class LogPlotPyramid
+{
+  public:
+    void setData(const QVector<double> & x, const QVector<double> & y);
+
+    // returns the samples of the most detailed level which has no more than maxPoints samples in [lower, upper]
+    void getRange(double lower, double upper, int maxPoints, QVector<double> & x, QVector<double> & y) const;
+
+  private:
+    struct Level {
+      QVector<double> x, y;
+    };
+
+    QVector<Level> levels;
+
+    static void decimate(const Level & source, int bucketSize, Level & result);
+};
+
+class LogTableModel : public QAbstractTableModel
+{
+  Q_OBJECT
+
+  public:
+    explicit LogTableModel(LogData & logData, QObject * parent = nullptr);
+
+    int rowCount(const QModelIndex & parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex & parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex & index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+    void clear();
+    void setHeader(const QStringList & header);
+    void append(const LogChunk & chunk);
+
+  private:
+    LogData & logData;
+};
+
+#endif // _LOGDATA_H_
@@ -37,8 +37,6 @@ LogsDialog::LogsDialog(QWidget *parent) :
   cursorB(0),
   cursorLine(0)
 {
-  csvlog.clear();
-
   ui->setupUi(this);
   setWindowIcon(CompanionIcon("logs.png"));
 
@@ -102,6 +100,14 @@ LogsDialog::LogsDialog(QWidget *parent) :
 
   ui->SaveSession_PB->setEnabled(false);
 
+  logModel = new LogTableModel(logData, this);
+  ui->logTable->setModel(logModel);
+  ui->logTable->setSelectionBehavior(QAbstractItemView::SelectRows);
+
+  // while a log is loading, the plot is refreshed at this rate
+  plotTimer.setSingleShot(true);
+  plotTimer.setInterval(500);
+
   // connect slot that ties some axis selections together (especially opposite axes):
   connect(ui->customPlot, SIGNAL(selectionChangedByUser()), this, SLOT(selectionChanged()));
   // connect slots that takes care that when an axis is selected, only that direction can be dragged and zoomed:
@@ -110,19 +116,23 @@ LogsDialog::LogsDialog(QWidget *parent) :
 
   // make left axes transfer its range to right axes:
   connect(axisRect->axis(QCPAxis::atLeft), SIGNAL(rangeChanged(QCPRange)), this, SLOT(yAxisChangeRanges(QCPRange)));
+  // pick the level of detail of the graphs when zooming or panning:
+  connect(axisRect->axis(QCPAxis::atBottom), SIGNAL(rangeChanged(QCPRange)), this, SLOT(xAxisChangeRange(QCPRange)));
 
   // connect some interaction slots:
   connect(ui->customPlot, SIGNAL(titleDoubleClick(QMouseEvent*, QCPPlotTitle*)), this, SLOT(titleDoubleClick(QMouseEvent*, QCPPlotTitle*)));
   connect(ui->customPlot, SIGNAL(axisDoubleClick(QCPAxis*,QCPAxis::SelectablePart,QMouseEvent*)), this, SLOT(axisLabelDoubleClick(QCPAxis*,QCPAxis::SelectablePart)));
   connect(ui->customPlot, SIGNAL(legendDoubleClick(QCPLegend*,QCPAbstractLegendItem*,QMouseEvent*)), this, SLOT(legendDoubleClick(QCPLegend*,QCPAbstractLegendItem*)));
   connect(ui->FieldsTW, SIGNAL(itemSelectionChanged()), this, SLOT(plotLogs()));
-  connect(ui->logTable, SIGNAL(itemSelectionChanged()), this, SLOT(plotLogs()));
+  connect(ui->logTable->selectionModel(), SIGNAL(selectionChanged(QItemSelection, QItemSelection)), this, SLOT(plotLogs()));
+  connect(&plotTimer, SIGNAL(timeout()), this, SLOT(plotLogs()));
   connect(ui->Reset_PB, SIGNAL(clicked()), this, SLOT(plotLogs()));
   connect(ui->SaveSession_PB, SIGNAL(clicked()), this, SLOT(saveSession()));
 }
 
 LogsDialog::~LogsDialog()
 {
+  stopLogLoader();
   delete ui;
 }
 
@@ -236,18 +246,18 @@ void LogsDialog::selectionChanged()
   }
 }
 
-QList<QStringList> LogsDialog::filterGePoints(const QList<QStringList> & input)
+QVector<int> LogsDialog::filterGePoints()
 {
-  QList<QStringList> result;
+  QVector<int> result;
 
-  int n = input.count();
+  int n = logData.rowCount();
   if (n == 0) {
     return result;
   }
 
   int gpscol = 0;
-  for (int i=1; i<input.at(0).count(); i++) {
-    if (input.at(0).at(i) == "GPS") {
+  for (int i=1; i<logData.columnCount(); i++) {
+    if (logData.header().at(i) == "GPS") {
       gpscol=i;
     }
   }
@@ -258,16 +268,16 @@ The columns for altitude \"GAlt\" and for speed \"GSpd\" are optional"));
     return result;
   }
 
-  result.append(input.at(0));
-  bool rangeSelected = ui->logTable->selectionModel()->selectedRows().length() > 0;
+  QItemSelectionModel * selectionModel = ui->logTable->selectionModel();
+  bool rangeSelected = selectionModel->hasSelection();
 
   GpsGlitchFilter glitchFilter;
   GpsLatLonFilter latLonFilter;
 
-  for (int i = 1; i < n; i++) {
-    if ((ui->logTable->item(i-1, 1)->isSelected() && rangeSelected) || !rangeSelected) {
+  for (int i = 0; i < n; i++) {
+    if (!rangeSelected || selectionModel->isRowSelected(i, QModelIndex())) {
 
-      GpsCoord coord = extractGpsCoordinates(input.at(i).at(gpscol));
+      GpsCoord coord = extractGpsCoordinates(logData.cell(i, gpscol));
 
       // glitch filter
       if ( glitchFilter.isGlitch(coord) ) {
@@ -282,38 +292,40 @@ The columns for altitude \"GAlt\" and for speed \"GSpd\" are optional"));
       }
 
       // qDebug() << "point " << latitude << longitude;
-      result.append(input.at(i));
+      result.append(i);
     }
   }
 
-  // qDebug() << "filterGePoints(): filtered from" << input.count() << "to " << result.count() << "points";
+  // qDebug() << "filterGePoints(): filtered from" << n << "to " << result.count() << "points";
   return result;
 }
 
 void LogsDialog::exportToGoogleEarth()
 {
   // filter data points
-  QList<QStringList> dataPoints = filterGePoints(csvlog);
+  QVector<int> dataPoints = filterGePoints();
   int n = dataPoints.count(); // number of points to export
   if (n==0) return;
 
+  const QStringList & header = logData.header();
+
   int gpscol=0, altcol=0, speedcol=0;
   double altMultiplier = 1.0;
 
   QSet<int> nondataCols;
-  for (int i=1; i<dataPoints.at(0).count(); i++) {
+  for (int i=1; i<header.count(); i++) {
     // Long,Lat,Course,GPS Speed,GPS Alt
-    if (dataPoints.at(0).at(i) == "GPS") {
+    if (header.at(i) == "GPS") {
       gpscol=i;
     }
-    if (dataPoints.at(0).at(i).contains("GAlt")) {
+    if (header.at(i).contains("GAlt")) {
       altcol = i;
       nondataCols << i;
-      if (dataPoints.at(0).at(i).contains("(ft)")) {
+      if (header.at(i).contains("(ft)")) {
         altMultiplier = 0.3048;    // feet to meters
       }
     }
-    if (dataPoints.at(0).at(i).contains("GSpd")) {
+    if (header.at(i).contains("GSpd")) {
       speedcol = i;
       nondataCols << i;
     }
@@ -353,9 +365,9 @@ void LogsDialog::exportToGoogleEarth()
   outputStream << "\t\t\t<gx:SimpleArrayField name=\"GPSSpeed\" type=\"float\">\n\t\t\t\t<displayName>GPS Speed</displayName>\n\t\t\t</gx:SimpleArrayField>\n";
 
   // declare additional fields
-  for (int i=0; i<dataPoints.at(0).count()-2; i++) {
+  for (int i=0; i<header.count()-2; i++) {
     if (ui->FieldsTW->item(i, 0) && ui->FieldsTW->item(i, 0)->isSelected() && !nondataCols.contains(i+2)) {
-      QString origName = dataPoints.at(0).at(i+2);
+      QString origName = header.at(i+2);
       QString safeName = origName;
       safeName.replace(" ","_");
       outputStream << "\t\t\t<gx:SimpleArrayField name=\""<< safeName <<"\" ";
@@ -378,17 +390,17 @@ void LogsDialog::exportToGoogleEarth()
   outputStream << "\n\t\t\t\t\t<altitudeMode>absolute</altitudeMode>\n";
 
   // time data points
-  for (int i=1; i<n; i++) {
-    QString tstamp=dataPoints.at(i).at(0)+QString("T")+dataPoints.at(i).at(1)+QString("Z");
+  for (int i=0; i<n; i++) {
+    QString tstamp=logData.cell(dataPoints.at(i), 0)+QString("T")+logData.cell(dataPoints.at(i), 1)+QString("Z");
     outputStream << "\t\t\t\t\t<when>"<< tstamp <<"</when>\n";
   }
 
   // coordinate data points
   outputStream.setRealNumberNotation(QTextStream::FixedNotation);
   outputStream.setRealNumberPrecision(8);
-  for (int i=1; i<n; i++) {
-    GpsCoord coord = extractGpsCoordinates(dataPoints.at(i).at(gpscol));
-    int altitude = altcol ? (dataPoints.at(i).at(altcol).toFloat() * altMultiplier) : 0;
+  for (int i=0; i<n; i++) {
+    GpsCoord coord = extractGpsCoordinates(logData.cell(dataPoints.at(i), gpscol));
+    int altitude = altcol ? (logData.cell(dataPoints.at(i), altcol).toFloat() * altMultiplier) : 0;
     outputStream << "\t\t\t\t\t<gx:coord>" << coord.longitude << " " << coord.latitude << " " << altitude << " </gx:coord>\n" ;
   }
 
@@ -398,20 +410,20 @@ void LogsDialog::exportToGoogleEarth()
   if (speedcol) {
     // gps speed data points
     outputStream << "\t\t\t\t\t\t\t<gx:SimpleArrayData name=\"GPSSpeed\">\n";
-    for (int i=1; i<n; i++) {
-      outputStream << "\t\t\t\t\t\t\t\t<gx:value>"<< dataPoints.at(i).at(speedcol) <<"</gx:value>\n";
+    for (int i=0; i<n; i++) {
+      outputStream << "\t\t\t\t\t\t\t\t<gx:value>"<< logData.cell(dataPoints.at(i), speedcol) <<"</gx:value>\n";
     }
     outputStream << "\t\t\t\t\t\t\t</gx:SimpleArrayData>\n";
   }
 
   // add values for additional fields
-  for (int i=0; i<dataPoints.at(0).count()-2; i++) {
+  for (int i=0; i<header.count()-2; i++) {
     if (ui->FieldsTW->item(i, 0) && ui->FieldsTW->item(i, 0)->isSelected() && !nondataCols.contains(i+2)) {
-      QString safeName = dataPoints.at(0).at(i+2);;
+      QString safeName = header.at(i+2);
       safeName.replace(" ","_");
       outputStream << "\t\t\t\t\t\t\t<gx:SimpleArrayData name=\""<< safeName <<"\">\n";
-      for (int j=1; j<n; j++) {
-        outputStream << "\t\t\t\t\t\t\t\t<gx:value>"<< dataPoints.at(j).at(i+2) <<"</gx:value>\n";
+      for (int j=0; j<n; j++) {
+        outputStream << "\t\t\t\t\t\t\t\t<gx:value>"<< logData.cell(dataPoints.at(j), i+2) <<"</gx:value>\n";
       }
       outputStream << "\t\t\t\t\t\t\t</gx:SimpleArrayData>\n";
     }
@@ -545,6 +557,7 @@ void LogsDialog::removeAllGraphs()
 {
   ui->customPlot->clearGraphs();
   ui->customPlot->clearItems();
+  plotPyramids.clear();
   ui->customPlot->legend->setVisible(false);
   rightLegend->clearItems();
   rightLegend->setVisible(false);
@@ -571,41 +584,7 @@ void LogsDialog::on_fileOpen_BT_clicked()
   if (!fileName.isEmpty()) {
     g.logDir(fileName);
     ui->FileName_LE->setText(fileName);
-    if (cvsFileParse()) {
-      ui->FieldsTW->clear();
-      ui->logTable->clear();
-      ui->FieldsTW->setShowGrid(false);
-      ui->FieldsTW->setContentsMargins(0,0,0,0);
-      ui->FieldsTW->setRowCount(csvlog.at(0).count()-2);
-      ui->FieldsTW->setColumnCount(1);
-      ui->FieldsTW->setHorizontalHeaderLabels(QStringList(tr("Available fields")));
-      ui->logTable->setSelectionBehavior(QAbstractItemView::SelectRows);
-      for (int i=2; i<csvlog.at(0).count(); i++) {
-        QTableWidgetItem* item= new QTableWidgetItem(csvlog.at(0).at(i));
-        ui->FieldsTW->setItem(i-2, 0, item);
-      }
-      ui->FieldsTW->resizeRowsToContents();
-      ui->logTable->setColumnCount(csvlog.at(0).count());
-      ui->logTable->setRowCount(csvlog.count()-1);
-      ui->logTable->setHorizontalHeaderLabels(csvlog.at(0));
-
-      QAbstractItemModel *model = ui->logTable->model();
-      for (int i=1; i<csvlog.count(); i++) {
-        for (int j=0; j<csvlog.at(0).count(); j++) {
-          model->setData(model->index(i - 1, j, QModelIndex()), csvlog.at(i).at(j));
-        }
-      }
-
-      ui->logTable->horizontalHeader()->setSectionResizeMode(QHeaderView::ResizeToContents);
-      QVarLengthArray<int> sizes;
-      for (int i = 0; i < ui->logTable->columnCount(); i++) {
-        sizes.append(ui->logTable->columnWidth(i));
-      }
-      ui->logTable->horizontalHeader()->setSectionResizeMode(QHeaderView::Interactive);
-      for (int i = 0; i < ui->logTable->columnCount(); i++) {
-        ui->logTable->setColumnWidth(i, sizes.at(i));
-      }
-    }
+    loadLogFile(fileName);
   }
 }
 
@@ -613,114 +592,151 @@ void LogsDialog::saveSession()
 {
   int index = ui->sessions_CB->currentIndex();
   // ignore index 0 is its all sessions combined
-  if(index > 0) {
-    int n = csvlog.count();
-    QList<QStringList> sessionCsvLog;
-    // add CSV headers from first row of source file
-    sessionCsvLog.push_back(csvlog[0]);
-    // find session breaks
-    int currentSession = 0;
-    QDateTime lastvalue;
-    for (int i = 1; i < n; i++) {
-      QDateTime tmp = getRecordTimeStamp(i);
-      if (!lastvalue.isValid() || lastvalue.secsTo(tmp) > 60) {
-        currentSession++;
-      }
-      lastvalue = tmp;
-      if(currentSession == index) {
-        // add records to filtered list
-        sessionCsvLog.push_back(csvlog[i]);
-      }
-      else if (currentSession > index) {
-        break;
-      }
-    }
-    // save the filtered records to a new file
+  if (index > 0 && index <= logData.sessions().count()) {
+    int first = logData.sessions().at(index - 1);
+    int last = (index < logData.sessions().count() ? logData.sessions().at(index) : logData.rowCount());
+    // save the records of the session to a new file
     QString newFilename = logFilename;
     newFilename.append(QString("-Session%1.csv").arg(index));
     QString filename = QFileDialog::getSaveFileName(this, "Save log", newFilename, "CSV files (.csv);", 0, 0); // getting the filename (full path)
     QFile data(filename);
-    if(data.open(QFile::WriteOnly |QFile::Truncate)) {
-      QTextStream output(&data);
-      int numRecords = sessionCsvLog.count();
-      for(int i = 0; i < numRecords; i++){
-        output << sessionCsvLog[i].join(",") << '\n';
+    if (data.open(QFile::WriteOnly | QFile::Truncate)) {
+      // add CSV headers from first row of source file
+      data.write(logData.header().join(",").toUtf8() + '\n');
+      for (int i = first; i < last; i++) {
+        data.write(logData.line(i) + '\n');
       }
     }
-    sessionCsvLog.clear();
   }
 }
 
-bool LogsDialog::cvsFileParse()
+void LogsDialog::loadLogFile(const QString & fileName)
 {
-  QFile file(ui->FileName_LE->text());
-  int errors=0;
-  int lines=-1;
+  stopLogLoader();
 
-  if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) { // reading HEX TEXT file
-    return false;
+  plotLock = true;
+  plotTimer.stop();
+  ui->sessions_CB->clear();
+  ui->SaveSession_PB->setEnabled(false);
+  ui->FieldsTW->clear();
+  ui->FieldsTW->setRowCount(0);
+  logModel->clear();
+  plotLock = false;
+  removeAllGraphs();
+
+  logFilename = QFileInfo(fileName).baseName();
+
+  // the log is parsed on a separate thread, its records are added to the table (and plotted) as they arrive
+  LogLoader * loader = new LogLoader(fileName);
+  QThread * loaderThread = new QThread();
+  loader->moveToThread(loaderThread);
+
+  connect(loaderThread, &QThread::started,        loader,       &LogLoader::run);
+  connect(loader,       &LogLoader::headerParsed, this,         &LogsDialog::onLogHeaderParsed);
+  connect(loader,       &LogLoader::chunkParsed,  this,         &LogsDialog::onLogChunkParsed);
+  connect(loader,       &LogLoader::finished,     this,         &LogsDialog::onLogLoaded);
+  connect(loader,       &LogLoader::finished,     loaderThread, &QThread::quit);
+  connect(loaderThread, &QThread::finished,       loader,       &LogLoader::deleteLater);
+  connect(loaderThread, &QThread::finished,       loaderThread, &QThread::deleteLater);
+
+  logLoader = loader;
+  logLoaderThread = loaderThread;
+  setCursor(Qt::BusyCursor);
+  loaderThread->start(QThread::LowPriority);
+}
+
+void LogsDialog::stopLogLoader()
+{
+  if (logLoader) {
+    // the chunks already queued by this loader are ignored by the slots below
+    disconnect(logLoader, 0, this, 0);
+    logLoader->abort();
+    logLoader = nullptr;
   }
-  else {
-    csvlog.clear();
-    logFilename.clear();
-    QTextStream inputStream(&file);
-    QString buffer = file.readLine();
+  if (logLoaderThread) {
+    logLoaderThread->quit();
+    logLoaderThread->wait();
+    logLoaderThread = nullptr;
+  }
+  unsetCursor();
+}
 
-    if (buffer.startsWith("Date,Time")) {
-      file.reset();
-    }
-    else {
-      return false;
-    }
+void LogsDialog::onLogHeaderParsed(const QStringList & header)
+{
+  if (sender() != logLoader.data())
+    return;
 
-    int numfields=-1;
-    while (!file.atEnd()) {
-      QString line = file.readLine().trimmed();
-      QStringList columns = line.split(',');
-      if (numfields==-1) {
-        numfields=columns.count();
-      }
-      if (columns.count()==numfields) {
-        csvlog.append(columns);
-      }
-      else {
-        errors++;
-      }
-      lines++;
-    }
+  logModel->setHeader(header);
 
-    logFilename = QFileInfo(file.fileName()).baseName();
+  plotLock = true;
+  ui->FieldsTW->setShowGrid(false);
+  ui->FieldsTW->setContentsMargins(0,0,0,0);
+  ui->FieldsTW->setRowCount(header.count()-2);
+  ui->FieldsTW->setColumnCount(1);
+  ui->FieldsTW->setHorizontalHeaderLabels(QStringList(tr("Available fields")));
+  for (int i=2; i<header.count(); i++) {
+    QTableWidgetItem* item= new QTableWidgetItem(header.at(i));
+    ui->FieldsTW->setItem(i-2, 0, item);
   }
+  ui->FieldsTW->resizeRowsToContents();
+  plotLock = false;
+}
+
+void LogsDialog::onLogChunkParsed(const LogChunk & chunk)
+{
+  if (sender() != logLoader.data())
+    return;
+
+  bool first = (logData.rowCount() == 0);
+  logModel->append(chunk);
+
+  if (first) {
+    ui->logTable->resizeColumnsToContents();
+  }
+
+  // plot what has been loaded so far
+  if (!plotTimer.isActive() && ui->FieldsTW->selectedItems().length()) {
+    plotTimer.start();
+  }
+}
+
+void LogsDialog::onLogLoaded(int errors, int lines, const QString & error)
+{
+  if (sender() != logLoader.data())
+    return;
 
-  file.close();
-  if (errors > 1) {
+  logLoader = nullptr;
+  logLoaderThread = nullptr;
+  unsetCursor();
+
+  if (!error.isEmpty()) {
+    QMessageBox::warning(this, CPN_STR_APP_NAME, error);
+  }
+  else if (errors > 1) {
     QMessageBox::warning(this, CPN_STR_APP_NAME, tr("The selected logfile contains %1 invalid lines out of  %2 total lines").arg(errors).arg(lines));
   }
 
-  int n = csvlog.count();
-  if (n == 1) {
-    csvlog.clear();
-    return false;
+  if (logData.rowCount() == 0) {
+    plotLock = true;
+    ui->FieldsTW->clear();
+    ui->FieldsTW->setRowCount(0);
+    logModel->clear();
+    plotLock = false;
+    removeAllGraphs();
+    return;
   }
 
   plotLock = true;
   setFlightSessions();
   plotLock = false;
 
-  return true;
+  plotTimer.stop();
+  plotLogs();
 }
 
-struct FlightSession {
-  QDateTime start;
-  QDateTime end;
-};
-
-QDateTime LogsDialog::getRecordTimeStamp(int index)
+QDateTime LogsDialog::getRecordTimeStamp(int row)
 {
-  QString tstamp = csvlog.at(index).at(0) + " " + csvlog.at(index).at(1);
-  if (csvlog.at(index).at(1).contains("."))
-    return QDateTime::fromString(tstamp, "yyyy-MM-dd HH:mm:ss.zzz");
-  return QDateTime::fromString(tstamp, "yyyy-MM-dd HH:mm:ss");
+  return QDateTime::fromMSecsSinceEpoch(qRound64(logData.time(row) * 1000));
 }
 
 QString LogsDialog::generateDuration(const QDateTime & start, const QDateTime & end)
@@ -740,38 +756,29 @@ void LogsDialog::setFlightSessions()
   ui->sessions_CB->clear();
   ui->SaveSession_PB->setEnabled(false);
 
-  int n = csvlog.count();
+  int n = logData.rowCount();
   // qDebug() << "records" << n;
 
-  // find session breaks
-  QList<int> sessions;
-  QDateTime lastvalue;
-  for (int i = 1; i < n; i++) {
-    QDateTime tmp = getRecordTimeStamp(i);
-    if (!lastvalue.isValid() || lastvalue.secsTo(tmp) > 60) {
-      sessions.push_back(i-1);
-      // qDebug() << "session index" << i-1;
-    }
-    lastvalue = tmp;
-  }
-  sessions.push_back(n-1);
+  // session breaks have been indexed while the log was loading
+  const QVector<int> & sessions = logData.sessions();
 
   //now construct a list of sessions with their times
   //total time
-  int noSesions = sessions.size()-1;
+  int noSesions = sessions.size();
   QString label = QString("%1 ").arg(noSesions);
   label += tr(noSesions > 1 ? "sessions" : "session");
-  label += " <" + tr("time span") + generateDuration(getRecordTimeStamp(1), getRecordTimeStamp(n-1)) + ">";
+  label += " <" + tr("time span") + generateDuration(getRecordTimeStamp(0), getRecordTimeStamp(n-1)) + ">";
   ui->sessions_CB->addItem(label);
 
   // add individual sessions
-  if (sessions.size() > 2) {
-    for (int i = 1; i < sessions.size(); i++) {
-      QDateTime sessionStart = getRecordTimeStamp(sessions.at(i-1)+1);
-      QDateTime sessionEnd = getRecordTimeStamp(sessions.at(i));
+  if (sessions.size() > 1) {
+    for (int i = 0; i < sessions.size(); i++) {
+      int last = (i + 1 < sessions.size() ? sessions.at(i + 1) : n) - 1;
+      QDateTime sessionStart = getRecordTimeStamp(sessions.at(i));
+      QDateTime sessionEnd = getRecordTimeStamp(last);
       QString label = sessionStart.toString("HH:mm:ss") + " <" + tr("duration ") + generateDuration(sessionStart, sessionEnd) + ">";
-      ui->sessions_CB->addItem(label, sessions.at(i-1));
-      // qDebug() << "added label" << label << sessions.at(i-1);
+      ui->sessions_CB->addItem(label, sessions.at(i));
+      // qDebug() << "added label" << label << sessions.at(i);
     }
   }
 }
@@ -788,13 +795,13 @@ void LogsDialog::on_sessions_CB_currentIndexChanged(int index)
     if (index < ui->sessions_CB->count() - 1) {
       bottom = ui->sessions_CB->itemData(index + 1, Qt::UserRole).toInt();
     } else {
-      bottom = ui->logTable->rowCount();
+      bottom = logModel->rowCount();
     }
 
     QModelIndex topLeft = ui->logTable->model()->index(
       ui->sessions_CB->itemData(index, Qt::UserRole).toInt(), 0 , QModelIndex());
     QModelIndex bottomRight = ui->logTable->model()->index(
-      bottom - 1, ui->logTable->columnCount() - 1, QModelIndex());
+      bottom - 1, logModel->columnCount() - 1, QModelIndex());
 
     QItemSelection selection(topLeft, bottomRight);
     ui->logTable->selectionModel()->select(selection, QItemSelectionModel::Select);
@@ -833,51 +840,42 @@ void LogsDialog::plotLogs()
     std::sort(selectedRows.begin(), selectedRows.end());
   } else {
     hasLogSelection = false;
-    rowCount = ui->logTable->rowCount();
+    rowCount = logData.rowCount();
   }
 
+  if (rowCount == 0) {
+    removeAllGraphs();
+    return;
+  }
+
+  const QVector<double> & times = logData.timeColumn();
+
   plots.min_x = QDateTime::currentDateTime().toTime_t();
   plots.max_x = 0;
 
   foreach (QTableWidgetItem *plot, ui->FieldsTW->selectedItems()) {
     coords_t plotCoords;
     int plotColumn = plot->row() + 2; // Date and Time first
+    // only the plotted columns are parsed (once, then cached)
+    QVector<double> values = logData.column(plotColumn);
 
     plotCoords.min_y = INVALID_MIN;
     plotCoords.max_y = INVALID_MAX;
     plotCoords.yaxis = firstLeft;
     plotCoords.name = plot->text();
+    plotCoords.x.reserve(rowCount);
+    plotCoords.y.reserve(rowCount);
 
-    for (int row = 0; row < rowCount; row++) {
-      QTableWidgetItem *logValue;
-      double y;
-      double time;
-      QString time_str;
-
-      if (hasLogSelection) {
-        logValue = ui->logTable->item(selectedRows.at(row), plotColumn);
-        time_str = ui->logTable->item(selectedRows.at(row), 0)->text() +
-          QString(" ") + ui->logTable->item(selectedRows.at(row), 1)->text();
-      } else {
-        logValue = ui->logTable->item(row, plotColumn);
-        time_str = ui->logTable->item(row, 0)->text() + QString(" ") +
-          ui->logTable->item(row, 1)->text();
-      }
+    for (int i = 0; i < rowCount; i++) {
+      int row = hasLogSelection ? selectedRows.at(i) : i;
 
-      y = logValue->text().toDouble();
+      double y = values.at(row);
       plotCoords.y.push_back(y);
 
       if (plotCoords.min_y > y) plotCoords.min_y = y;
       if (plotCoords.max_y < y) plotCoords.max_y = y;
 
-      if (time_str.contains('.')) {
-        time = QDateTime::fromString(time_str, "yyyy-MM-dd HH:mm:ss.zzz")
-          .toTime_t();
-        time += time_str.mid(time_str.indexOf('.')).toDouble();
-      } else {
-        time = QDateTime::fromString(time_str, "yyyy-MM-dd HH:mm:ss")
-          .toTime_t();
-      }
+      double time = times.at(row);
       plotCoords.x.push_back(time);
 
       if (plots.min_x > time) plots.min_x = time;
@@ -1045,8 +1043,10 @@ void LogsDialog::plotLogs()
         break;
     }
 
-    ui->customPlot->graph(i)->setData(plots.coords.at(i).x,
-      plots.coords.at(i).y);
+    LogPlotPyramid pyramid;
+    pyramid.setData(plots.coords.at(i).x, plots.coords.at(i).y);
+    plotPyramids.append(pyramid);
+    setGraphData(i, axisRect->axis(QCPAxis::atBottom)->range());
     pen.setColor(colors.at(i % colors.size()));
     ui->customPlot->graph(i)->setPen(pen);
 
@@ -1109,6 +1109,22 @@ void LogsDialog::yAxisChangeRanges(QCPRange range)
 }
 
 
+void LogsDialog::xAxisChangeRange(QCPRange range)
+{
+  for (int i = 0; i < plotPyramids.size() && i < ui->customPlot->graphCount(); i++) {
+    setGraphData(i, range);
+  }
+}
+
+void LogsDialog::setGraphData(int index, const QCPRange & range)
+{
+  // two samples per pixel, as the pyramid keeps the min and the max of each bucket
+  int maxPoints = 2 * qMax(axisRect->width(), 500);
+  QVector<double> x, y;
+  plotPyramids.at(index).getRange(range.lower, range.upper, maxPoints, x, y);
+  ui->customPlot->graph(index)->setData(x, y);
+}
+
 void LogsDialog::addMaxAltitudeMarker(const coords_t & c, QCPGraph * graph) {
   // find max altitude
   int positionIndex = 0;
@@ -24,6 +24,7 @@
 #include <QtCore>
 #include <QDialog>
 #include "qcustomplot.h"
+#include "logdata.h"
 
 #define INVALID_MIN 999999
 #define INVALID_MAX -999999
@@ -82,9 +83,18 @@ private slots:
   void on_sessions_CB_currentIndexChanged(int index);
   void on_mapsButton_clicked();
   void yAxisChangeRanges(QCPRange range);
+  void xAxisChangeRange(QCPRange range);
+  void onLogHeaderParsed(const QStringList & header);
+  void onLogChunkParsed(const LogChunk & chunk);
+  void onLogLoaded(int errors, int lines, const QString & error);
 
 private:
-  QList<QStringList> csvlog;
+  LogData logData;
+  LogTableModel * logModel;
+  QPointer<LogLoader> logLoader;
+  QPointer<QThread> logLoaderThread;
+  QTimer plotTimer;
+  QVector<LogPlotPyramid> plotPyramids;
   Ui::LogsDialog *ui;
   QCPAxisRect *axisRect;
   QCPLegend *rightLegend;
@@ -102,12 +112,14 @@ private:
   QCPItemTracer * cursorB;
   QCPItemStraightLine * cursorLine;
 
-  bool cvsFileParse();
-  QList<QStringList> filterGePoints(const QList<QStringList> & input);
+  void loadLogFile(const QString & fileName);
+  void stopLogLoader();
+  QVector<int> filterGePoints();
   void exportToGoogleEarth();
-  QDateTime getRecordTimeStamp(int index);
+  QDateTime getRecordTimeStamp(int row);
   QString generateDuration(const QDateTime & start, const QDateTime & end);
   void setFlightSessions();
+  void setGraphData(int index, const QCPRange & range);
 
   void addMaxAltitudeMarker(const coords_t & c, QCPGraph * graph);
   void countNumberOfThrows(const coords_t & c, QCPGraph * graph);
@@ -24,8 +24,17 @@
 #include <QCryptographicHash>
 #include <QElapsedTimer>
 #include <QMutexLocker>
+#include <QRunnable>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QThread>
+#include <QThreadPool>
 
 #define SYNC_MAX_ERRORS       50  // give up after this many errors per destination
+#define SYNC_HASH_THREADS     4   // the files are often read from the same (USB) drive, more threads don't help
+
+#define MANIFEST_MAGIC        0x4F54534DU  // "OTSM"
+#define MANIFEST_VERSION      1            // MD5 hashes
 
 // a flood of log messages can make the UI unresponsive so we'll introduce a dynamic sleep period based on log frequency (values in [us])
 #define PAUSE_FACTOR          60UL
@@ -52,6 +61,134 @@
   #define FILTER_RE_SYNTX     QRegExp::WildcardUnix
 #endif
 
+SyncManifest::SyncManifest(const QString & folder) :
+  dirty(false)
+{
+  const QByteArray key = QCryptographicHash::hash(QDir(folder).absolutePath().toUtf8(), QCryptographicHash::Md5).toHex();
+  fileName = QStandardPaths::writableLocation(QStandardPaths::CacheLocation) % "/sync/" % QString::fromLatin1(key) % ".manifest";
+}
+
+void SyncManifest::load()
+{
+  QFile file(fileName);
+  if (!file.open(QIODevice::ReadOnly))
+    return;
+
+  QDataStream in(&file);
+  quint32 magic, version, count;
+  in >> magic >> version >> count;
+  if (magic != MANIFEST_MAGIC || version != MANIFEST_VERSION)
+    return;
+
+  entries.reserve(count);
+  for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; i++) {
+    QString path;
+    Entry entry;
+    in >> path >> entry.size >> entry.modified >> entry.hash;
+    entry.used = false;
+    if (in.status() == QDataStream::Ok)
+      entries.insert(path, entry);
+  }
+}
+
+bool SyncManifest::save(bool prune)
+{
+  QMutexLocker locker(&mutex);
+
+  if (prune) {
+    for (QHash<QString, Entry>::iterator it = entries.begin(); it != entries.end(); ) {
+      if (it->used) {
+        ++it;
+      }
+      else {
+        it = entries.erase(it);
+        dirty = true;
+      }
+    }
+  }
+
+  if (!dirty)
+    return true;
+
+  QDir().mkpath(QFileInfo(fileName).absolutePath());
+  QSaveFile file(fileName);
+  if (!file.open(QIODevice::WriteOnly))
+    return false;
+
+  QDataStream out(&file);
+  out << quint32(MANIFEST_MAGIC) << quint32(MANIFEST_VERSION) << quint32(entries.count());
+  for (QHash<QString, Entry>::const_iterator it = entries.constBegin(); it != entries.constEnd(); ++it) {
+    out << it.key() << it->size << it->modified << it->hash;
+  }
+
+  if (!file.commit())
+    return false;
+
+  dirty = false;
+  return true;
+}
+
+QByteArray SyncManifest::hash(const QString & path, qint64 size, qint64 modified)
+{
+  QMutexLocker locker(&mutex);
+  QHash<QString, Entry>::iterator it = entries.find(path);
+  if (it == entries.end() || it->size != size || it->modified != modified)
+    return QByteArray();
+  it->used = true;
+  return it->hash;
+}
+
+void SyncManifest::setHash(const QString & path, qint64 size, qint64 modified, const QByteArray & hash)
+{
+  QMutexLocker locker(&mutex);
+  entries.insert(path, {size, modified, hash, true});
+  dirty = true;
+}
+
+QByteArray SyncManifest::computeHash(const QString & filePath, QString * error)
+{
+  QFile file(filePath);
+  QCryptographicHash hash(QCryptographicHash::Md5);
+  if (!file.open(QFile::ReadOnly) || !hash.addData(&file)) {
+    if (error)
+      *error = file.errorString();
+    return QByteArray();
+  }
+  return hash.result();
+}
+
+namespace {
+
+// hashes one file of a folder on a worker thread and stores the result in the manifest of that folder
+class SyncHashTask : public QRunnable
+{
+  public:
+    SyncHashTask(SyncManifest & manifest, const QString & path, const QFileInfo & info) :
+      manifest(manifest),
+      path(path),
+      filePath(info.absoluteFilePath()),
+      size(info.size()),
+      modified(info.lastModified().toMSecsSinceEpoch())
+    {
+    }
+
+    void run() override
+    {
+      const QByteArray hash = SyncManifest::computeHash(filePath);
+      if (!hash.isEmpty())
+        manifest.setHash(path, size, modified, hash);
+    }
+
+  private:
+    SyncManifest & manifest;
+    QString path;
+    QString filePath;
+    qint64 size;
+    qint64 modified;
+};
+
+}  // namespace
+
 SyncProcess::SyncProcess(const SyncProcess::SyncOptions & options) :
   m_options(options),
   m_pauseTime(PAUSE_MINTM),
@@ -110,6 +247,8 @@ void SyncProcess::run()
   const QString gathering = tr("Gathering file information for %1...");
   const QString noFiles = tr("No files found in %1");
   int count = 0;
+  SyncManifest manifestA(folderA);
+  SyncManifest manifestB(folderB);
 
   m_stat.clear();
   m_startTime = QDateTime::currentDateTime();
@@ -118,6 +257,9 @@ void SyncProcess::run()
   emit fileCountChanged(0);
   emit statusUpdate(m_stat);
 
+  manifestA.load();
+  manifestB.load();
+
   if (direction == SYNC_A2B_B2A || direction == SYNC_A2B) {
     emit statusMessage(gathering.arg(folderA));
     count = getFilesCount(folderA);
@@ -130,7 +272,7 @@ void SyncProcess::run()
       if (m_options.direction == SYNC_A2B_B2A)
         count *= 2;  // assume this direction is only 50% of total, exact will be calculated later
       emit fileCountChanged(count);
-      updateDir(folderA, folderB);
+      updateDir(folderA, folderB, manifestA, manifestB);
       if (isStopRequsted())
         goto endrun;
     }
@@ -151,7 +293,7 @@ void SyncProcess::run()
     emit fileCountChanged(m_stat.count);
 
     if (count) {
-      updateDir(folderB, folderA);
+      updateDir(folderB, folderA, manifestB, manifestA);
     }
     else {
       PRINT_INFO(noFiles.arg(folderB));
@@ -166,6 +308,9 @@ void SyncProcess::run()
   }
 
   endrun:
+  // the files which were not seen are only forgotten when the whole folders have been walked
+  manifestA.save(!isStopRequsted());
+  manifestB.save(!isStopRequsted());
   finish();
 }
 
@@ -240,7 +385,47 @@ int SyncProcess::getFilesCount(const QString & directory)
   return result;
 }
 
-void SyncProcess::updateDir(const QString & source, const QString & destination)
+void SyncProcess::hashFiles(const QString & source, const QString & destination, SyncManifest & srcManifest, SyncManifest & dstManifest)
+{
+  const QDir srcDir(source), dstDir(destination);
+  const bool checkDate = (m_options.compareType == OVERWR_NEWER_IF_DIFF);
+  QThreadPool pool;
+  pool.setMaxThreadCount(qBound(1, QThread::idealThreadCount(), SYNC_HASH_THREADS));
+
+  // queue the files which will have to be compared and are not in the manifests yet
+  QFileInfoList infoList = dirInfoList(source);
+  QMutableListIterator<QFileInfo> it(infoList);
+  it.toBack();
+  while (it.hasPrevious() && !isStopRequsted()) {
+    const QFileInfo fi(it.previous());
+    it.remove();
+    if (fileFilter(fi) != FILE_ALLOW)
+      continue;
+    pushDirEntries(fi, it);
+    if (!fi.isFile())
+      continue;
+
+    const QString path = srcDir.relativeFilePath(fi.filePath());
+    const QFileInfo di(dstDir.absoluteFilePath(path));
+    // files of different sizes are never read, neither are the older ones when they would be skipped anyway
+    if (!di.isFile() || di.size() != fi.size() || (checkDate && fi.lastModified() <= di.lastModified()))
+      continue;
+
+    if (srcManifest.hash(path, fi.size(), fi.lastModified().toMSecsSinceEpoch()).isEmpty())
+      pool.start(new SyncHashTask(srcManifest, path, fi));
+    if (dstManifest.hash(path, di.size(), di.lastModified().toMSecsSinceEpoch()).isEmpty())
+      pool.start(new SyncHashTask(dstManifest, path, di));
+    QApplication::processEvents();
+  }
+
+  while (!pool.waitForDone(100)) {
+    QApplication::processEvents();
+    if (isStopRequsted())
+      pool.clear();
+  }
+}
+
+void SyncProcess::updateDir(const QString & source, const QString & destination, SyncManifest & srcManifest, SyncManifest & dstManifest)
 {
   SyncStatus pStat = m_stat;
   const QDir srcDir(source), dstDir(destination);
@@ -248,6 +433,10 @@ void SyncProcess::updateDir(const QString & source, const QString & destination)
   emit statusMessage(testRunStr % tr("Synchronizing: %1\n    To: %2").arg(source, destination));
   PRINT_INFO(testRunStr % tr("Starting synchronization:\n  %1 -> %2\n").arg(source, destination));
 
+  if (m_options.compareType == OVERWR_NEWER_IF_DIFF || m_options.compareType == OVERWR_IF_DIFF) {
+    hashFiles(source, destination, srcManifest, dstManifest);
+  }
+
   QFileInfoList infoList = dirInfoList(source);
   QMutableListIterator<QFileInfo> it(infoList);
   it.toBack();
@@ -257,7 +446,7 @@ void SyncProcess::updateDir(const QString & source, const QString & destination)
     if ((ffr = fileFilter(fi)) == FILE_ALLOW) {
       pushDirEntries(fi, it);
       if ((m_dirFilters & QDir::Dirs) || fi.isFile()) {
-        updateEntry(fi.filePath(), srcDir, dstDir);
+        updateEntry(fi.filePath(), srcDir, dstDir, srcManifest, dstManifest);
         if (fi.isFile())
           ++m_stat.index;
         emit statusUpdate(m_stat);
@@ -299,10 +488,23 @@ void SyncProcess::updateDir(const QString & source, const QString & destination)
   PRINT_SEP();
 }
 
-bool SyncProcess::updateEntry(const QString & entry, const QDir & source, const QDir & destination)
+QByteArray SyncProcess::fileHash(SyncManifest & manifest, const QString & path, const QFileInfo & info, QString * error)
+{
+  const qint64 modified = info.lastModified().toMSecsSinceEpoch();
+  QByteArray result = manifest.hash(path, info.size(), modified);
+  if (result.isEmpty()) {
+    result = SyncManifest::computeHash(info.absoluteFilePath(), error);
+    if (!result.isEmpty())
+      manifest.setHash(path, info.size(), modified, result);
+  }
+  return result;
+}
+
+bool SyncProcess::updateEntry(const QString & entry, const QDir & source, const QDir & destination, SyncManifest & srcManifest, SyncManifest & dstManifest)
 {
   const QString srcPath = QDir::toNativeSeparators(source.absoluteFilePath(entry));
-  const QString destPath = QDir::toNativeSeparators(destination.absoluteFilePath(source.relativeFilePath(entry)));
+  const QString path = source.relativeFilePath(entry);
+  const QString destPath = QDir::toNativeSeparators(destination.absoluteFilePath(path));
   const QFileInfo sourceInfo(srcPath);
   const QFileInfo destInfo(destPath);
   static QString lastMkPath;
@@ -359,20 +561,24 @@ bool SyncProcess::updateEntry(const QString & entry, const QDir & source, const
   }
 
   if (destExists && checkContent) {
-    if (!sourceFile.open(QFile::ReadOnly)) {
-      PRINT_ERROR(tr("Could not open source file '%1': %2").arg(srcPath, sourceFile.errorString()));
-      ++m_stat.errored;
-      return false;
-    }
-    if (!destinationFile.open(QFile::ReadOnly)) {
-      PRINT_ERROR(tr("Could not open destination file '%1': %2").arg(destPath, destinationFile.errorString()));
-      ++m_stat.errored;
-      return false;
+    bool skip = false;
+    // files of different sizes can't be identical, no need to read them
+    if (sourceInfo.size() == destInfo.size()) {
+      QString error;
+      const QByteArray sourceHash = fileHash(srcManifest, path, sourceInfo, &error);
+      if (sourceHash.isEmpty()) {
+        PRINT_ERROR(tr("Could not open source file '%1': %2").arg(srcPath, error));
+        ++m_stat.errored;
+        return false;
+      }
+      const QByteArray destinationHash = fileHash(dstManifest, path, destInfo, &error);
+      if (destinationHash.isEmpty()) {
+        PRINT_ERROR(tr("Could not open destination file '%1': %2").arg(destPath, error));
+        ++m_stat.errored;
+        return false;
+      }
+      skip = (sourceHash == destinationHash);
     }
-
-    const bool skip = QCryptographicHash::hash(sourceFile.readAll(), QCryptographicHash::Md5) == QCryptographicHash::hash(destinationFile.readAll(), QCryptographicHash::Md5);
-    sourceFile.close();
-    destinationFile.close();
     if (skip) {
       PRINT_SKIP(tr("Skipping identical file: %1").arg(srcPath));
       ++m_stat.skipped;
@@ -400,6 +606,14 @@ bool SyncProcess::updateEntry(const QString & entry, const QDir & source, const
       return false;
     }
 
+    if (!(m_options.flags & OPT_DRY_RUN)) {
+      // the copy has the same content as the source, it won't have to be read at the next run
+      const QByteArray hash = srcManifest.hash(path, sourceInfo.size(), sourceInfo.lastModified().toMSecsSinceEpoch());
+      const QFileInfo copyInfo(destPath);
+      if (!hash.isEmpty() && copyInfo.size() == sourceInfo.size())
+        dstManifest.setHash(path, copyInfo.size(), copyInfo.lastModified().toMSecsSinceEpoch(), hash);
+    }
+
     if (existed)
       ++m_stat.updated;
     else
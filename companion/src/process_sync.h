@@ -26,10 +26,47 @@
 #include <QDebug>
 #include <QDir>
 #include <QDirIterator>
+#include <QHash>
+#include <QMutex>
 #include <QReadWriteLock>
 #include <QRegExp>
 #include <QVector>
 
+/*
+ * Size, modification time and content hash of the files of a synchronized folder.
+ * It is kept between the runs (in the cache folder), so that the files which have not
+ * changed since the last synchronization don't have to be read again to be compared.
+ */
+class SyncManifest
+{
+  public:
+    explicit SyncManifest(const QString & folder);
+
+    void load();
+    // prune: forget the files which were not seen during this run
+    bool save(bool prune);
+
+    // returns an empty array if the file is unknown or has changed since it was hashed
+    QByteArray hash(const QString & path, qint64 size, qint64 modified);
+    void setHash(const QString & path, qint64 size, qint64 modified, const QByteArray & hash);
+
+    // returns an empty array if the file can't be read
+    static QByteArray computeHash(const QString & filePath, QString * error = nullptr);
+
+  private:
+    struct Entry {
+      qint64 size;
+      qint64 modified;
+      QByteArray hash;
+      bool used;
+    };
+
+    QString fileName;
+    QHash<QString, Entry> entries;
+    QMutex mutex;
+    bool dirty;
+};
+
 class SyncProcess : public QObject
 {
     Q_OBJECT
@@ -126,9 +163,11 @@ class SyncProcess : public QObject
     FileFilterResult fileFilter(const QFileInfo & fileInfo);
     QFileInfoList dirInfoList(const QString & directory);
     int getFilesCount(const QString & directory);
-    void updateDir(const QString & source, const QString & destination);
+    void updateDir(const QString & source, const QString & destination, SyncManifest & srcManifest, SyncManifest & dstManifest);
+    void hashFiles(const QString & source, const QString & destination, SyncManifest & srcManifest, SyncManifest & dstManifest);
     void pushDirEntries(const QFileInfo & fi, QMutableListIterator<QFileInfo> &it);
-    bool updateEntry(const QString & entry, const QDir & source, const QDir & destination);
+    bool updateEntry(const QString & entry, const QDir & source, const QDir & destination, SyncManifest & srcManifest, SyncManifest & dstManifest);
+    QByteArray fileHash(SyncManifest & manifest, const QString & path, const QFileInfo & info, QString * error = nullptr);
     void pause();
     void emitProgressMessage(const QString &text, int type);
 
@@ -21,6 +21,41 @@
 #include "categorized.h"
 #include "firmwares/opentx/opentxinterface.h"
 
+namespace {
+
+// A model of models.txt, extracted from the storage then decoded on the thread pool
+struct ModelLoadJob {
+  int index;
+  int category;
+  QString fileName;
+  QByteArray buffer;
+  QString error;
+};
+
+class ModelDecodeTask : public QRunnable
+{
+  public:
+    ModelDecodeTask(ModelLoadJob & job, ModelData & model):
+      job(job),
+      model(model)
+    {
+    }
+
+    void run() override
+    {
+      if (!loadModelFromByteArray(model, job.buffer)) {
+        job.error = CategorizedStorageFormat::tr("Error loading model %1").arg(job.fileName);
+      }
+      job.buffer.clear();
+    }
+
+  protected:
+    ModelLoadJob & job;
+    ModelData & model;
+};
+
+}
+
 bool CategorizedStorageFormat::load(RadioData & radioData)
 {
   QByteArray radioSettingsBuffer;
@@ -42,6 +77,8 @@ bool CategorizedStorageFormat::load(RadioData & radioData)
     return false;
   }
 
+  // 1st pass: parse models.txt and extract the models files (the storage is not thread safe)
+  std::vector<ModelLoadJob> jobs;
   QList<QByteArray> lines = modelsListBuffer.split('\n');
   int modelIndex = 0;
   int categoryIndex = -1;
@@ -77,31 +114,16 @@ bool CategorizedStorageFormat::load(RadioData & radioData)
       parts.removeFirst();
     }
     if (parts.size() == 1) {
-      // parse model file name and load
-      QString fileName = parts[0];
-      qDebug() << "Loading model from file" << fileName << "into slot" << modelIndex;
-      QByteArray modelBuffer;
-      if (!loadFile(modelBuffer, QString("MODELS/%1").arg(fileName))) {
-        setError(tr("Can't extract %1").arg(fileName));
-        return false;
-      }
-      if ((int)radioData.models.size() <= modelIndex) {
-        radioData.models.resize(modelIndex + 1);
-      }
-      if (!loadModelFromByteArray(radioData.models[modelIndex], modelBuffer)) {
-        setError(tr("Error loading models"));
-        return false;
-      }
-      strncpy(radioData.models[modelIndex].filename, qPrintable(fileName), sizeof(radioData.models[modelIndex].filename));
-      if (IS_FAMILY_HORUS_OR_T16(board) && !strcmp(radioData.generalSettings.currModelFilename, qPrintable(fileName))) {
-        radioData.generalSettings.currModelIndex = modelIndex;
-        qDebug() << "currModelIndex =" << modelIndex;
+      // parse model file name and extract it
+      ModelLoadJob job;
+      job.index = modelIndex++;
+      job.category = categoryIndex;
+      job.fileName = parts[0];
+      qDebug() << "Loading model from file" << job.fileName << "into slot" << job.index;
+      if (!loadFile(job.buffer, QString("MODELS/%1").arg(job.fileName))) {
+        job.error = tr("Can't extract %1").arg(job.fileName);
       }
-      if (getCurrentFirmware()->getCapability(HasModelCategories)) {
-        radioData.models[modelIndex].category = categoryIndex;
-      }
-      radioData.models[modelIndex].used = true;
-      modelIndex++;
+      jobs.push_back(job);
       continue;
     }
 
@@ -110,6 +132,51 @@ bool CategorizedStorageFormat::load(RadioData & radioData)
     qDebug() << "Invalid line" <<line;
     continue;
   }
+
+  // 2nd pass: decode the models concurrently, each one in its own slot
+  for (const ModelLoadJob & job: jobs) {
+    if ((int)radioData.models.size() <= job.index) {
+      radioData.models.resize(job.index + 1);
+    }
+  }
+
+  QThreadPool pool;
+  for (ModelLoadJob & job: jobs) {
+    if (job.error.isEmpty()) {
+      pool.start(new ModelDecodeTask(job, radioData.models[job.index]));
+    }
+  }
+  pool.waitForDone();
+
+  // 3rd pass: merge the results in models.txt order
+  QStringList errors;
+  for (const ModelLoadJob & job: jobs) {
+    if (!job.error.isEmpty()) {
+      radioData.models[job.index].clear();
+      errors << job.error;
+      continue;
+    }
+    ModelData & model = radioData.models[job.index];
+    strncpy(model.filename, qPrintable(job.fileName), sizeof(model.filename));
+    if (IS_FAMILY_HORUS_OR_T16(board) && !strcmp(radioData.generalSettings.currModelFilename, qPrintable(job.fileName))) {
+      radioData.generalSettings.currModelIndex = job.index;
+      qDebug() << "currModelIndex =" << job.index;
+    }
+    if (getCurrentFirmware()->getCapability(HasModelCategories)) {
+      model.category = job.category;
+    }
+    model.used = true;
+  }
+
+  if (!errors.isEmpty()) {
+    if (errors.size() == (int)jobs.size()) {
+      setError(tr("Error loading models") + "\n" + errors.join("\n"));
+      return false;
+    }
+    // the models which could be loaded are kept
+    setWarning(tr("Some models could not be loaded:") + "\n" + errors.join("\n"));
+  }
+
   return true;
 }
 
@@ -24,6 +24,21 @@
 
 #define MZ_ALLOCATION_SIZE    (32*1024)
 
+bool OtxFormat::openArchive(QFile & file, mz_zip_archive & archive, QByteArray & buffer)
+{
+  // the archive is read straight from the mapped file, it is only copied when it can't be mapped
+  const uchar * data = file.map(0, file.size());
+  size_t size = file.size();
+  if (!data) {
+    buffer = file.readAll();
+    data = (const uchar *)buffer.constData();
+    size = buffer.size();
+  }
+
+  memset(&archive, 0, sizeof(archive));
+  return mz_zip_reader_init_mem(&archive, data, size, 0);
+}
+
 bool OtxFormat::load(RadioData & radioData)
 {
   QFile file(filename);
@@ -33,13 +48,11 @@ bool OtxFormat::load(RadioData & radioData)
     return false;
   }
 
-  QByteArray archiveContents = file.readAll();
-
-  qDebug() << "File" << filename << "read, size:" << archiveContents.size();
+  qDebug() << "File" << filename << "opened, size:" << file.size();
 
   // open zip file
-  memset(&zip_archive, 0, sizeof(zip_archive));
-  if (!mz_zip_reader_init_mem(&zip_archive, archiveContents.data(), archiveContents.size(), 0)) {
+  QByteArray archiveContents;
+  if (!openArchive(file, zip_archive, archiveContents)) {
     qDebug() << tr("Error opening OTX archive %1").arg(filename);
     return false;
   }
@@ -53,13 +66,30 @@ bool OtxFormat::write(const RadioData & radioData)
 {
   qDebug() << "Saving to archive" << filename;
 
+  // the entries which didn't change are taken from the current file, without compressing them again
+  QFile previousFile(filename);
+  QByteArray previousContents;
+  has_previous_archive = previousFile.open(QFile::ReadOnly) && openArchive(previousFile, previous_archive, previousContents);
+
   memset(&zip_archive, 0, sizeof(zip_archive));
   if (!mz_zip_writer_init_heap(&zip_archive, 0, MZ_ALLOCATION_SIZE)) {
     setError(tr("Error initializing OTX archive writer"));
+    if (has_previous_archive) {
+      mz_zip_reader_end(&previous_archive);
+      has_previous_archive = false;
+    }
     return false;
   }
 
   bool result = CategorizedStorageFormat::write(radioData);
+
+  // the current file has to be closed before it is overwritten
+  if (has_previous_archive) {
+    mz_zip_reader_end(&previous_archive);
+    has_previous_archive = false;
+  }
+  previousFile.close();
+
   if (result) {
     // finalize archive and get contents
     char * archiveContents;
@@ -92,21 +122,46 @@ bool OtxFormat::write(const RadioData & radioData)
 
 bool OtxFormat::loadFile(QByteArray & filedata, const QString & filename)
 {
-  size_t size;
-  void * data = mz_zip_reader_extract_file_to_heap(&zip_archive, qPrintable(filename), &size, 0);
-  if (!data) {
+  mz_zip_archive_file_stat stat;
+  int index = mz_zip_reader_locate_file(&zip_archive, qPrintable(filename), nullptr, 0);
+  if (index < 0 || !mz_zip_reader_file_stat(&zip_archive, index, &stat)) {
     return false;
   }
 
-  qDebug() << QString("Extracted file %1, size=%2").arg(filename).arg(size);
-  filedata.clear();
-  filedata.append((char *)data, size);
-  mz_free(data);
+  // decompressed straight into the buffer
+  filedata.resize(stat.m_uncomp_size);
+  if (!mz_zip_reader_extract_to_mem(&zip_archive, index, filedata.data(), filedata.size(), 0)) {
+    filedata.clear();
+    return false;
+  }
+
+  qDebug() << QString("Extracted file %1, size=%2").arg(filename).arg(filedata.size());
   return true;
 }
 
+bool OtxFormat::isUnchanged(const QByteArray & filedata, int index)
+{
+  mz_zip_archive_file_stat stat;
+  if (!mz_zip_reader_file_stat(&previous_archive, index, &stat) || stat.m_uncomp_size != (mz_uint64)filedata.size())
+    return false;
+
+  if (stat.m_crc32 != mz_crc32(MZ_CRC32_INIT, (const mz_uint8 *)filedata.constData(), filedata.size()))
+    return false;
+
+  // inflating is much cheaper than deflating, make sure that it's not just a CRC collision
+  QByteArray previousData(filedata.size(), 0);
+  return mz_zip_reader_extract_to_mem(&previous_archive, index, previousData.data(), previousData.size(), 0) && previousData == filedata;
+}
+
 bool OtxFormat::writeFile(const QByteArray & filedata, const QString & filename)
 {
+  if (has_previous_archive) {
+    int index = mz_zip_reader_locate_file(&previous_archive, filename.toStdString().c_str(), nullptr, 0);
+    if (index >= 0 && isUnchanged(filedata, index) && mz_zip_writer_add_from_zip_reader(&zip_archive, &previous_archive, index)) {
+      return true;
+    }
+  }
+
   if (!mz_zip_writer_add_mem(&zip_archive, filename.toStdString().c_str(), filedata.data(), filedata.size(), MZ_DEFAULT_LEVEL)) {
     setError(tr("Error adding %1 to OTX archive").arg(filename));
     return false;
@@ -35,7 +35,8 @@ class OtxFormat : public CategorizedStorageFormat
 
   public:
     OtxFormat(const QString & filename):
-      CategorizedStorageFormat(filename)
+      CategorizedStorageFormat(filename),
+      has_previous_archive(false)
     {
     }
 
@@ -47,7 +48,13 @@ class OtxFormat : public CategorizedStorageFormat
     virtual bool loadFile(QByteArray & fileData, const QString & fileName);
     virtual bool writeFile(const QByteArray & fileData, const QString & fileName);
 
+    bool openArchive(QFile & file, mz_zip_archive & archive, QByteArray & buffer);
+    bool isUnchanged(const QByteArray & fileData, int index);
+
     mz_zip_archive zip_archive;
+    // the archive being overwritten, its unchanged entries are copied as they are
+    mz_zip_archive previous_archive;
+    bool has_previous_archive;
 };
 
 #endif // _OTX_H_
@@ -0,0 +1,81 @@
+/*
+ * Copyright (C) OpenTX
+ *
+ * Based on code named
+ *   th9x - http://code.google.com/p/th9x
+ *   er9x - http://code.google.com/p/er9x
+ *   gruvin9x - http://code.google.com/p/gruvin9x
+ *
+ * License GPLv2: http://www.gnu.org/licenses/gpl-2.0.html
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#include "gtests.h"
+#include "firmwares/eepromimportexport.h"
+
+TEST(EepromImportExport, BitCodec)
+{
+  QByteArray bytes;
+  BitWriter writer(bytes);
+  writer.write(0x5, 3);
+  writer.write(0x1FF, 8);   // only the 8 low bits are written
+  writer.write(0xDEADBEEF, 32);
+  writer.write(0x1, 70);
+  writer.fill(120);
+  writer.write(0x3, 2);
+  writer.flush();
+  EXPECT_EQ(122u, writer.position());
+  EXPECT_EQ(16, bytes.size());
+  EXPECT_EQ(char(0xFD), bytes.at(0));  // 101 then 11111 of 0xFF, LSB first
+
+  BitReader reader(bytes);
+  EXPECT_EQ(0x5u, reader.read(3));
+  EXPECT_EQ(0xFFu, reader.read(8));
+  EXPECT_EQ(0xDEADBEEFu, reader.read(32));
+  EXPECT_EQ(0x1u, reader.read(64));
+  reader.seek(120);
+  EXPECT_EQ(0x3u, reader.read(2));
+  // after the end of the input
+  EXPECT_EQ(0u, reader.read(16));
+}
+
+TEST(EepromImportExport, StructRoundTrip)
+{
+  unsigned int u = 5;
+  int s = -3;
+  bool b = true;
+  char name[11] = "Test";
+
+  StructField root(nullptr);
+  root.Append(new UnsignedField<3>(&root, u));
+  root.Append(new SignedField<5>(&root, s));
+  root.Append(new BoolField<1>(&root, b));
+  root.Append(new SpareBitsField<7>(&root));
+  root.Append(new ZCharField<10>(&root, name));
+
+  QByteArray bytes;
+  root.Export(bytes);
+  EXPECT_EQ(12, bytes.size());
+  EXPECT_EQ(char(0xED), bytes.at(0));  // 101 + 11101 (-3 on 5 bits)
+  EXPECT_EQ(char(0x01), bytes.at(1));
+
+  u = 0;
+  s = 0;
+  b = false;
+  memset(name, 0, sizeof(name));
+  EXPECT_EQ(0, root.Import(bytes));
+  EXPECT_EQ(5u, u);
+  EXPECT_EQ(-3, s);
+  EXPECT_TRUE(b);
+  EXPECT_STREQ("Test", name);
+
+  EXPECT_EQ(-1, root.Import(bytes.left(11)));
+}
@@ -0,0 +1,283 @@
+/*
+ * Copyright (C) OpenTX
+ *
+ * Based on code named
+ *   th9x - http://code.google.com/p/th9x
+ *   er9x - http://code.google.com/p/er9x
+ *   gruvin9x - http://code.google.com/p/gruvin9x
+ *
+ * License GPLv2: http://www.gnu.org/licenses/gpl-2.0.html
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#include "gtests.h"
+#include "logdata.h"
+#include "binarylog.h"
+#include <QTemporaryFile>
+#include <algorithm>
+
+class LogLoaderTest : public testing::Test
+{
+  protected:
+    LogData logData;
+    int errors = -1;
+    int lines = -1;
+    QString error;
+
+    void load(const QByteArray & content)
+    {
+      QTemporaryFile file;
+      ASSERT_TRUE(file.open());
+      file.write(content);
+      file.close();
+
+      // the loader runs in this thread, the signals are delivered at once
+      LogLoader loader(file.fileName());
+      QObject::connect(&loader, &LogLoader::headerParsed, [this](const QStringList & header) { logData.setHeader(header); });
+      QObject::connect(&loader, &LogLoader::chunkParsed, [this](const LogChunk & chunk) { logData.append(chunk); });
+      QObject::connect(&loader, &LogLoader::finished, [this](int e, int l, const QString & s) { errors = e; lines = l; error = s; });
+      loader.run();
+    }
+};
+
+// a record of a log starting at 10:00:00, one column with the given value
+static QByteArray logLine(int tenths, int value)
+{
+  int seconds = tenths / 10;
+  return QString("2020-05-01,%1:%2:%3.%4,%5\n")
+    .arg(10 + seconds / 3600, 2, 10, QChar('0'))
+    .arg(seconds / 60 % 60, 2, 10, QChar('0'))
+    .arg(seconds % 60, 2, 10, QChar('0'))
+    .arg(tenths % 10)
+    .arg(value).toUtf8();
+}
+
+static void writeVarint(QByteArray & data, quint32 value)
+{
+  while (value >= 0x80) {
+    data.append(char((value & 0x7F) | 0x80));
+    value >>= 7;
+  }
+  data.append(char(value));
+}
+
+static void writeDelta(QByteArray & data, qint32 delta)
+{
+  writeVarint(data, ((quint32)delta << 1) ^ (quint32)(delta >> 31));
+}
+
+// a binary log with a "Date,Time" and a "A" field, and 2 records
+static QByteArray binaryLog()
+{
+  QByteArray data("OTLG\x01", 5);
+  data.append('S');
+  data.append(char(2)).append(char(0)).append("Date,Time").append('\0');
+  data.append(char(0)).append(char(1)).append("A").append('\0');
+  data.append(char(0xFF));
+  // 2020-05-01 10:00:00.10 UTC, A = 12.3
+  data.append('R').append(char(0x07));
+  writeDelta(data, 1588327200);
+  writeDelta(data, 10);
+  writeDelta(data, 123);
+  // 10ms later, A = -12.3
+  data.append('R').append(char(0x06));
+  writeDelta(data, 10);
+  writeDelta(data, -246);
+  return data;
+}
+
+TEST_F(LogLoaderTest, parseCsv)
+{
+  load("Date,Time,RSSI(dB),GPS\n"
+       "2020-05-01,10:00:00.100,50,45.1 6.2\n"
+       "2020-05-01,10:00:00.200,51,45.2 6.3\n"
+       "garbage\n"
+       "2020-05-01,10:00:01.000,52\n"
+       "2020-13-01,10:00:01.000,53,0 0\n"
+       "2020-05-01,10:00:01.500,54,\n");
+
+  EXPECT_TRUE(error.isEmpty());
+  EXPECT_EQ(6, lines);
+  EXPECT_EQ(3, errors);  // the garbage, the missing column and the invalid date
+
+  ASSERT_EQ(4, logData.columnCount());
+  EXPECT_EQ(QString("RSSI(dB)"), logData.header().at(2));
+  ASSERT_EQ(3, logData.rowCount());
+  EXPECT_NEAR(0.1, logData.time(1) - logData.time(0), 1e-6);
+  EXPECT_NEAR(1.4, logData.time(2) - logData.time(0), 1e-6);
+  EXPECT_EQ(QString("45.2 6.3"), logData.cell(1, 3));
+  EXPECT_TRUE(logData.cell(2, 3).isEmpty());
+  EXPECT_EQ(QByteArray("2020-05-01,10:00:01.500,54,"), logData.line(2));
+
+  QVector<double> rssi = logData.column(2);
+  ASSERT_EQ(3, rssi.size());
+  EXPECT_EQ(50, rssi.at(0));
+  EXPECT_EQ(51, rssi.at(1));
+  EXPECT_EQ(54, rssi.at(2));
+}
+
+TEST_F(LogLoaderTest, invalidHeader)
+{
+  load("Time,RSSI(dB)\n"
+       "10:00:00.100,50\n");
+
+  EXPECT_FALSE(error.isEmpty());
+  EXPECT_EQ(0, logData.rowCount());
+}
+
+TEST_F(LogLoaderTest, sessions)
+{
+  QByteArray content = "Date,Time,A\n";
+  // 10 minutes at 10Hz, more than one chunk
+  for (int i = 0; i < 6000; i++) {
+    content += logLine(i, i);
+  }
+  // a new session after a 10 minutes gap
+  for (int i = 0; i < 600; i++) {
+    content += logLine(12000 + i, 6000 + i);
+  }
+  // another one, across an hour change
+  for (int i = 0; i < 21; i++) {
+    content += logLine(35990 + i, 6600 + i);
+  }
+  // less than LOG_SESSION_GAP later, still the same session
+  content += logLine(36010 + 599, 6621);
+
+  load(content);
+
+  EXPECT_TRUE(error.isEmpty());
+  EXPECT_EQ(0, errors);
+  ASSERT_EQ(6622, logData.rowCount());
+  ASSERT_EQ(3, logData.sessions().count());
+  EXPECT_EQ(0, logData.sessions().at(0));
+  EXPECT_EQ(6000, logData.sessions().at(1));
+  EXPECT_EQ(6600, logData.sessions().at(2));
+
+  // the records around the chunks and the hour limits
+  EXPECT_EQ(logLine(4999, 4999).trimmed(), logData.line(4999));
+  EXPECT_EQ(logLine(5000, 5000).trimmed(), logData.line(5000));
+  EXPECT_EQ(logLine(36010 + 599, 6621).trimmed(), logData.line(6621));
+  EXPECT_NEAR(0.1, logData.time(5000) - logData.time(4999), 1e-6);
+  EXPECT_NEAR(0.1, logData.time(6610) - logData.time(6609), 1e-6);
+
+  QVector<double> values = logData.column(2);
+  ASSERT_EQ(6622, values.size());
+  for (int i = 0; i < values.size(); i++) {
+    EXPECT_EQ(i, values.at(i));
+  }
+}
+
+TEST_F(LogLoaderTest, parseBinary)
+{
+  QByteArray content = binaryLog();
+  // a truncated last record is dropped
+  content.append('R').append(char(0x04));
+
+  load(content);
+
+  EXPECT_TRUE(error.isEmpty());
+  EXPECT_EQ(0, errors);
+  ASSERT_EQ(2, logData.rowCount());
+  EXPECT_EQ(QString("A"), logData.header().at(2));
+  EXPECT_EQ(QByteArray("2020-05-01,10:00:00.100,12.3"), logData.line(0));
+  EXPECT_EQ(QByteArray("2020-05-01,10:00:00.200,-12.3"), logData.line(1));
+}
+
+TEST(BinaryLogReader, byPieces)
+{
+  QByteArray content = binaryLog();
+
+  BinaryLogReader reader;
+  QStringList expected;
+  EXPECT_TRUE(reader.toCsv(content, expected));
+  ASSERT_EQ(3, expected.size());
+
+  // the records cut anywhere give the same lines
+  BinaryLogReader pieces;
+  QStringList lines;
+  for (int i = 0; i < content.size(); i++) {
+    EXPECT_TRUE(pieces.addData(content.mid(i, 1), lines));
+  }
+  EXPECT_TRUE(pieces.finish());
+  EXPECT_EQ(expected, lines);
+
+  EXPECT_FALSE(reader.toCsv("Date,Time\n", lines));
+  EXPECT_FALSE(reader.toCsv("OTLG", lines));
+}
+
+TEST(LogPlotPyramid, decimation)
+{
+  // a flat line with a peak up and a peak down
+  QVector<double> x, y;
+  for (int i = 0; i < 100000; i++) {
+    x.append(i);
+    y.append(0);
+  }
+  y[12345] = 1000;
+  y[67890] = -1000;
+
+  LogPlotPyramid pyramid;
+  pyramid.setData(x, y);
+
+  QVector<double> rx, ry;
+  pyramid.getRange(0, 99999, 100000, rx, ry);
+  EXPECT_EQ(x, rx);
+  EXPECT_EQ(y, ry);
+
+  // the levels are 100000, 25002, 3128 and 393 samples
+  pyramid.getRange(0, 99999, 30000, rx, ry);
+  EXPECT_EQ(25002, rx.size());
+  pyramid.getRange(0, 99999, 1000, rx, ry);
+  EXPECT_EQ(393, rx.size());
+  EXPECT_TRUE(std::is_sorted(rx.constBegin(), rx.constEnd()));
+  EXPECT_EQ(0, rx.first());
+  EXPECT_TRUE(ry.contains(1000));
+  EXPECT_TRUE(ry.contains(-1000));
+
+  // a range inside one bucket gives the samples of the first level and one more on each side
+  pyramid.getRange(12344.5, 12346.5, 2, rx, ry);
+  EXPECT_EQ(QVector<double>({12344, 12345, 12346, 12347}), rx);
+  EXPECT_EQ(QVector<double>({0, 1000, 0, 0}), ry);
+
+  // the same range with fewer points, the peak is still there
+  pyramid.getRange(12344.5, 12346.5, 1, rx, ry);
+  EXPECT_EQ(QVector<double>({12344, 12345, 12348}), rx);
+  EXPECT_EQ(QVector<double>({0, 1000, 0}), ry);
+}
+
+TEST(LogPlotPyramid, rangeEdges)
+{
+  LogPlotPyramid pyramid;
+  // the clock went back during the flight
+  pyramid.setData({0, 1, 2, 3, 4, 5, 6, 9, 7, 8}, {0, 10, 20, 30, 40, 50, 60, 90, 70, 80});
+
+  QVector<double> x, y;
+  pyramid.getRange(0, 9, 100, x, y);
+  EXPECT_EQ(QVector<double>({0, 1, 2, 3, 4, 5, 6, 7, 8, 9}), x);
+  EXPECT_EQ(QVector<double>({0, 10, 20, 30, 40, 50, 60, 70, 80, 90}), y);
+
+  // the first and the last sample
+  pyramid.getRange(0, 0, 100, x, y);
+  EXPECT_EQ(QVector<double>({0, 1}), x);
+  pyramid.getRange(9, 9, 100, x, y);
+  EXPECT_EQ(QVector<double>({8, 9}), x);
+
+  // between two samples
+  pyramid.getRange(3.2, 3.8, 100, x, y);
+  EXPECT_EQ(QVector<double>({3, 4}), x);
+
+  // outside of the samples
+  pyramid.getRange(-5, -1, 100, x, y);
+  EXPECT_EQ(QVector<double>({0}), x);
+  pyramid.getRange(20, 30, 100, x, y);
+  EXPECT_EQ(QVector<double>({9}), x);
+  EXPECT_EQ(QVector<double>({90}), y);
+}
@@ -498,6 +498,10 @@ const int16_t alawTable[256] = { -5504, -5248, -6016, -5760, -4480, -4224, -4992
 const int16_t ulawTable[256] = { -32124, -31100, -30076, -29052, -28028, -27004, -25980, -24956, -23932, -22908, -21884, -20860, -19836, -18812, -17788, -16764, -15996, -15484, -14972, -14460, -13948, -13436, -12924, -12412, -11900, -11388, -10876, -10364, -9852, -9340, -8828, -8316, -7932, -7676, -7420, -7164, -6908, -6652, -6396, -6140, -5884, -5628, -5372, -5116, -4860, -4604, -4348, -4092, -3900, -3772, -3644, -3516, -3388, -3260, -3132, -3004, -2876, -2748, -2620, -2492, -2364, -2236, -2108, -1980, -1884, -1820, -1756, -1692, -1628, -1564, -1500, -1436, -1372, -1308, -1244, -1180, -1116, -1052, -988, -924, -876, -844, -812, -780, -748, -716, -684, -652, -620, -588, -556, -524, -492, -460, -428, -396, -372, -356, -340, -324, -308, -292, -276, -260, -244, -228, -212, -196, -180, -164, -148, -132, -120, -112, -104, -96, -88, -80, -72, -64, -56, -48, -40, -32, -24, -16, -8, 0, 32124, 31100, 30076, 29052, 28028, 27004, 25980, 24956, 23932, 22908, 21884, 20860, 19836, 18812, 17788, 16764, 15996, 15484, 14972, 14460, 13948, 13436, 12924, 12412, 11900, 11388, 10876, 10364, 9852, 9340, 8828, 8316, 7932, 7676, 7420, 7164, 6908, 6652, 6396, 6140, 5884, 5628, 5372, 5116, 4860, 4604, 4348, 4092, 3900, 3772, 3644, 3516, 3388, 3260, 3132, 3004, 2876, 2748, 2620, 2492, 2364, 2236, 2108, 1980, 1884, 1820, 1756, 1692, 1628, 1564, 1500, 1436, 1372, 1308, 1244, 1180, 1116, 1052, 988, 924, 876, 844, 812, 780, 748, 716, 684, 652, 620, 588, 556, 524, 492, 460, 428, 396, 372, 356, 340, 324, 308, 292, 276, 260, 244, 228, 212, 196, 180, 164, 148, 132, 120, 112, 104, 96, 88, 80, 72, 64, 56, 48, 40, 32, 24, 16, 8, 0 };
 
 AudioQueue audioQueue __DMA;      // to place it in the RAM section on Horus, to have file buffers in RAM for DMA access
+
+#if defined(SIMU)
+simuAudioCallbackFunc simuAudioCallback = nullptr;
+#endif
 AudioBuffer audioBuffers[AUDIO_BUFFER_COUNT] __DMA;
 
 AudioQueue::AudioQueue()
@@ -543,98 +547,263 @@ void audioTask(void * pdata)
 }
 #endif
 
-inline void mixSample(audio_data_t * result, int sample, unsigned int fade)
+#if defined(SOFTWARE_VOLUME)
+// Scales the buffer by currentSpeakerVolume / VOLUME_LEVEL_MAX, with a 16.16 gain instead of a division per sample
+inline void applySoftwareVolume(AudioBuffer * buffer)
 {
-  *result = limit(AUDIO_DATA_MIN, *result + ((sample >> fade) >> (16-AUDIO_BITS_PER_SAMPLE)), AUDIO_DATA_MAX);
+  if (currentSpeakerVolume >= VOLUME_LEVEL_MAX)
+    return;
+
+  int32_t gain = ((int32_t)currentSpeakerVolume << 16) / VOLUME_LEVEL_MAX;
+  for (uint32_t i=0; i<buffer->size; i++) {
+    int32_t sample = (int32_t)buffer->data[i] - AUDIO_DATA_SILENCE;
+    buffer->data[i] = (audio_data_t)(((sample * gain) >> 16) + AUDIO_DATA_SILENCE);
+  }
 }
+#endif
 
 #if defined(SDCARD)
 
 #define RIFF_CHUNK_SIZE 12
 uint8_t wavBuffer[AUDIO_BUFFER_SIZE*2] __DMA;
 
+AudioPromptsCache audioPromptsCache;
+
+#if defined(AUDIO_PROMPT_DATA_MAXSIZE)
+uint8_t audioPromptsData[AUDIO_PROMPTS_CACHE_SIZE][AUDIO_PROMPT_DATA_MAXSIZE] __SDRAM;
+
+uint8_t * AudioPromptsCache::getData(const AudioPromptInfo * prompt) const
+{
+  return audioPromptsData[prompt - entries];
+}
+#endif
+
+AudioPromptInfo * AudioPromptsCache::find(const char * filename)
+{
+  for (auto & entry: entries) {
+    if (entry.filename[0] && !strcmp(entry.filename, filename)) {
+      entry.lastUse = get_tmr10ms();
+      return &entry;
+    }
+  }
+  return nullptr;
+}
+
+AudioPromptInfo * AudioPromptsCache::add(const AudioPromptInfo & info)
+{
+  tmr10ms_t now = get_tmr10ms();
+  AudioPromptInfo * result = nullptr;
+
+  // the least recently used entry, unless it's still being played (or it has just been prefetched)
+  for (auto & entry: entries) {
+    if (!entry.filename[0]) {
+      result = &entry;
+      break;
+    }
+    if (!entry.users && now - entry.lastUse > AUDIO_PROMPT_IN_USE_DELAY && (!result || (int32_t)(entry.lastUse - result->lastUse) < 0)) {
+      result = &entry;
+    }
+  }
+
+  if (result) {
+    *result = info;
+    result->lastUse = now;
+    result->users = 0;
+#if defined(AUDIO_PROMPT_DATA_MAXSIZE)
+    result->loaded = 0;
+#endif
+  }
+  return result;
+}
+
+// Opens a wav file and parses its RIFF header, the file is left at the beginning of the samples
+static FRESULT openWavFile(FIL * file, AudioPromptInfo & info)
+{
+  UINT read = 0;
+  FRESULT result = f_open(file, info.filename, FA_OPEN_EXISTING | FA_READ);
+  if (result != FR_OK) {
+    return result;
+  }
+
+  result = f_read(file, wavBuffer, RIFF_CHUNK_SIZE+8, &read);
+  if (result == FR_OK && read == RIFF_CHUNK_SIZE+8 && !memcmp(wavBuffer, "RIFF", 4) && !memcmp(wavBuffer+8, "WAVEfmt ", 8)) {
+    uint32_t size = *((uint32_t *)(wavBuffer+16));
+    result = (size < 256 ? f_read(file, wavBuffer, size+8, &read) : FR_DENIED);
+    if (result == FR_OK && read == size+8) {
+      info.codec = ((uint16_t *)wavBuffer)[0];
+      info.freq = ((uint16_t *)wavBuffer)[2];
+      uint32_t *wavSamplesPtr = (uint32_t *)(wavBuffer + size);
+      uint32_t size = wavSamplesPtr[1];
+      if (info.freq != 0 && info.freq * (AUDIO_SAMPLE_RATE / info.freq) == AUDIO_SAMPLE_RATE) {
+        info.resampleRatio = (AUDIO_SAMPLE_RATE / info.freq);
+        info.readSize = (info.codec == CODEC_ID_PCM_S16LE ? 2*AUDIO_BUFFER_SIZE : AUDIO_BUFFER_SIZE) / info.resampleRatio;
+      }
+      else {
+        result = FR_DENIED;
+      }
+      while (result == FR_OK && memcmp(wavSamplesPtr, "data", 4) != 0) {
+        result = f_lseek(file, f_tell(file)+size);
+        if (result == FR_OK) {
+          result = f_read(file, wavBuffer, 8, &read);
+          if (read != 8) result = FR_DENIED;
+          wavSamplesPtr = (uint32_t *)wavBuffer;
+          size = wavSamplesPtr[1];
+        }
+      }
+      info.size = size;
+      info.offset = f_tell(file);
+    }
+    else {
+      result = FR_DENIED;
+    }
+  }
+  else {
+    result = FR_DENIED;
+  }
+
+  if (result != FR_OK) {
+    f_close(file);
+  }
+  return result;
+}
+
+bool AudioPromptsCache::load(const char * filename)
+{
+  static FIL file;  // too big for the audio task stack, only used from this task
+  AudioPromptInfo info;
+  strcpy(info.filename, filename);
+  if (openWavFile(&file, info) != FR_OK) {
+    return false;
+  }
+
+  AudioPromptInfo * prompt = add(info);
+#if defined(AUDIO_PROMPT_DATA_MAXSIZE)
+  if (prompt && fitsData(prompt)) {
+    UINT read = 0;
+    if (f_read(&file, getData(prompt), prompt->size, &read) == FR_OK && read == prompt->size) {
+      prompt->loaded = prompt->size;
+    }
+  }
+#endif
+
+  f_close(&file);
+  return prompt != nullptr;
+}
+
+// the entry stays in the cache as long as the context is playing it, paused or not
+void WavContext::setPrompt(AudioPromptInfo * prompt)
+{
+  if (state.prompt && state.prompt->users) {
+    state.prompt->users--;
+  }
+  state.prompt = prompt;
+  if (prompt) {
+    prompt->users++;
+  }
+}
+
 int WavContext::mixBuffer(AudioBuffer *buffer, int volume, unsigned int fade)
 {
   FRESULT result = FR_OK;
   UINT read = 0;
 
   if (fragment.file[1]) {
-    result = f_open(&state.file, fragment.file, FA_OPEN_EXISTING | FA_READ);
-    fragment.file[1] = 0;
-    if (result == FR_OK) {
-      result = f_read(&state.file, wavBuffer, RIFF_CHUNK_SIZE+8, &read);
-      if (result == FR_OK && read == RIFF_CHUNK_SIZE+8 && !memcmp(wavBuffer, "RIFF", 4) && !memcmp(wavBuffer+8, "WAVEfmt ", 8)) {
-        uint32_t size = *((uint32_t *)(wavBuffer+16));
-        result = (size < 256 ? f_read(&state.file, wavBuffer, size+8, &read) : FR_DENIED);
-        if (result == FR_OK && read == size+8) {
-          state.codec = ((uint16_t *)wavBuffer)[0];
-          state.freq = ((uint16_t *)wavBuffer)[2];
-          uint32_t *wavSamplesPtr = (uint32_t *)(wavBuffer + size);
-          uint32_t size = wavSamplesPtr[1];
-          if (state.freq != 0 && state.freq * (AUDIO_SAMPLE_RATE / state.freq) == AUDIO_SAMPLE_RATE) {
-            state.resampleRatio = (AUDIO_SAMPLE_RATE / state.freq);
-            state.readSize = (state.codec == CODEC_ID_PCM_S16LE ? 2*AUDIO_BUFFER_SIZE : AUDIO_BUFFER_SIZE) / state.resampleRatio;
-          }
-          else {
-            result = FR_DENIED;
-          }
-          while (result == FR_OK && memcmp(wavSamplesPtr, "data", 4) != 0) {
-            result = f_lseek(&state.file, f_tell(&state.file)+size);
-            if (result == FR_OK) {
-              result = f_read(&state.file, wavBuffer, 8, &read);
-              if (read != 8) result = FR_DENIED;
-              wavSamplesPtr = (uint32_t *)wavBuffer;
-              size = wavSamplesPtr[1];
-            }
-          }
-          state.size = size;
-        }
-        else {
-          result = FR_DENIED;
+    AudioPromptInfo info;
+    AudioPromptInfo * cached = audioPromptsCache.find(fragment.file);
+    const AudioPromptInfo * prompt = cached;
+    state.inMemory = false;
+    if (prompt) {
+#if defined(AUDIO_PROMPT_DATA_MAXSIZE)
+      state.inMemory = audioPromptsCache.isLoaded(prompt);
+#endif
+      if (!state.inMemory) {
+        // the header is already known, go straight to the samples
+        result = f_open(&state.file, fragment.file, FA_OPEN_EXISTING | FA_READ);
+        if (result == FR_OK) {
+          result = f_lseek(&state.file, prompt->offset);
         }
       }
-      else {
-        result = FR_DENIED;
+    }
+    else {
+      strcpy(info.filename, fragment.file);
+      result = openWavFile(&state.file, info);
+      if (result == FR_OK) {
+        cached = audioPromptsCache.add(info);
+        prompt = &info;
       }
     }
+    // the previous prompt was released when its play ended
+    state.prompt = nullptr;
+    RTOS_LOCK_MUTEX(audioMutex);
+    if (fragment.type == FRAGMENT_FILE) {
+      setPrompt(cached);
+    }
+    fragment.file[1] = 0;
+    RTOS_UNLOCK_MUTEX(audioMutex);
+    if (result == FR_OK) {
+      state.codec = prompt->codec;
+      state.freq = prompt->freq;
+      state.resampleRatio = prompt->resampleRatio;
+      state.readSize = prompt->readSize;
+      state.size = prompt->size;
+    }
   }
 
   if (result == FR_OK) {
+    const uint8_t * data = wavBuffer;
     read = 0;
-    result = f_read(&state.file, wavBuffer, state.readSize, &read);
+#if defined(AUDIO_PROMPT_DATA_MAXSIZE)
+    uint32_t position = (state.prompt ? state.prompt->size - state.size : 0);
+    if (state.inMemory) {
+      if (!state.prompt) {
+        // stopped, or the cache has been flushed
+        return 0;
+      }
+      data = audioPromptsCache.getData(state.prompt) + position;
+      read = min<uint32_t>(state.readSize, state.size);
+    }
+    else
+#endif
+    {
+      result = f_read(&state.file, wavBuffer, state.readSize, &read);
+    }
     if (result == FR_OK) {
       if (read > state.size) {
         read = state.size;
       }
       state.size -= read;
 
+#if defined(AUDIO_PROMPT_DATA_MAXSIZE)
+      if (state.prompt && !state.inMemory && audioPromptsCache.fitsData(state.prompt) && state.prompt->loaded == position) {
+        // keep the samples for the next time this prompt is played. The reads are aligned on readSize,
+        // the load of an interrupted play is resumed when the next play reaches this position
+        memcpy(audioPromptsCache.getData(state.prompt) + position, wavBuffer, read);
+        state.prompt->loaded += read;
+      }
+#endif
+      if (state.prompt) {
+        state.prompt->lastUse = get_tmr10ms();
+      }
+
       if (read != state.readSize) {
-        f_close(&state.file);
-        fragment.clear();
+        if (!state.inMemory) {
+          f_close(&state.file);
+        }
+        RTOS_LOCK_MUTEX(audioMutex);
+        clear();
+        RTOS_UNLOCK_MUTEX(audioMutex);
       }
 
       audio_data_t * samples = buffer->data;
       if (state.codec == CODEC_ID_PCM_S16LE) {
-        read /= 2;
-        for (uint32_t i=0; i<read; i++) {
-          for (uint8_t j=0; j<state.resampleRatio; j++) {
-            mixSample(samples++, ((int16_t *)wavBuffer)[i], fade+2-volume);
-          }
-        }
+        const int16_t * pcm = (const int16_t *)data;
+        samples = mixSamples(samples, read / 2, state.resampleRatio, fade+2-volume, [pcm](uint32_t i) -> int32_t { return pcm[i]; });
       }
       else if (state.codec == CODEC_ID_PCM_ALAW) {
-        for (uint32_t i=0; i<read; i++) {
-          for (uint8_t j=0; j<state.resampleRatio; j++) {
-            mixSample(samples++, alawTable[wavBuffer[i]], fade+2-volume);
-          }
-        }
+        samples = mixSamples(samples, read, state.resampleRatio, fade+2-volume, [data](uint32_t i) -> int32_t { return alawTable[data[i]]; });
       }
       else if (state.codec == CODEC_ID_PCM_MULAW) {
-        for (uint32_t i=0; i<read; i++) {
-          for (uint8_t j=0; j<state.resampleRatio; j++) {
-            mixSample(samples++, ulawTable[wavBuffer[i]], fade+2-volume);
-          }
-        }
+        samples = mixSamples(samples, read, state.resampleRatio, fade+2-volume, [data](uint32_t i) -> int32_t { return ulawTable[data[i]]; });
       }
 
       return samples - buffer->data;
@@ -642,7 +811,9 @@ int WavContext::mixBuffer(AudioBuffer *buffer, int volume, unsigned int fade)
   }
 
   if (result != FR_OK) {
+    RTOS_LOCK_MUTEX(audioMutex);
     clear();
+    RTOS_UNLOCK_MUTEX(audioMutex);
   }
   return 0;
 }
@@ -718,12 +889,16 @@ int ToneContext::mixBuffer(AudioBuffer * buffer, int volume, unsigned int fade)
       points = (float(end) - toneIdx) / state.step;
     }
 
-    for (int i=0; i<points; i++) {
-      int16_t sample = sineValues[int(toneIdx)] * state.volume;
-      mixSample(&buffer->data[i], sample, fade);
-      toneIdx += state.step;
-      if ((unsigned int)toneIdx >= DIM(sineValues))
-        toneIdx -= DIM(sineValues);
+    float toneStep = state.step;
+    float toneVolume = state.volume;
+    if (points > 0) {
+      mixSamples(buffer->data, points, 1, fade, [&toneIdx, toneStep, toneVolume](uint32_t) -> int32_t {
+        int16_t sample = sineValues[int(toneIdx)] * toneVolume;
+        toneIdx += toneStep;
+        if ((unsigned int)toneIdx >= DIM(sineValues))
+          toneIdx -= DIM(sineValues);
+        return sample;
+      });
     }
 
     if (remainingDuration > AUDIO_BUFFER_DURATION) {
@@ -748,12 +923,47 @@ int ToneContext::mixBuffer(AudioBuffer * buffer, int volume, unsigned int fade)
   return result;
 }
 
+#if defined(SDCARD)
+// Parses the next queued file while the current fragment is playing, so that it starts without
+// waiting for the SD card. With SDRAM, its samples are loaded too if it's short enough
+void AudioQueue::prefetchNextPrompt()
+{
+  char filename[AUDIO_FILENAME_MAXLEN+1];
+  filename[0] = '\0';
+
+  RTOS_LOCK_MUTEX(audioMutex);
+  const AudioFragment * next = fragmentsFifo.peek();
+  if (next && next->type == FRAGMENT_FILE) {
+    strcpy(filename, next->file);
+  }
+  RTOS_UNLOCK_MUTEX(audioMutex);
+
+  if (filename[0] && !audioPromptsCache.find(filename)) {
+    // only one attempt per file, a missing file would be retried on each wakeup otherwise
+    uint32_t filenameHash = hash(filename, strlen(filename));
+    if (filenameHash != lastPrefetchHash) {
+      lastPrefetchHash = filenameHash;
+      audioPromptsCache.load(filename);
+    }
+  }
+}
+#endif
+
 void AudioQueue::wakeup()
 {
   DEBUG_TIMER_START(debugTimerAudioConsume);
   audioConsumeCurrentBuffer();
   DEBUG_TIMER_STOP(debugTimerAudioConsume);
 
+#if defined(SDCARD)
+  RTOS_LOCK_MUTEX(audioMutex);
+  if (audioPromptsCache.checkInvalidated()) {
+    normalContext.releasePrompt();
+    backgroundContext.releasePrompt();
+  }
+  RTOS_UNLOCK_MUTEX(audioMutex);
+#endif
+
   AudioBuffer * buffer;
   while ((buffer = buffersFifo.getEmptyBuffer()) != nullptr) {
     int result;
@@ -761,9 +971,7 @@ void AudioQueue::wakeup()
     int size = 0;
 
     // write silence in the buffer
-    for (uint32_t i=0; i<AUDIO_BUFFER_SIZE; i++) {
-      buffer->data[i] = AUDIO_DATA_SILENCE; /* silence */
-    }
+    fillSamples(buffer->data, AUDIO_BUFFER_SIZE, AUDIO_DATA_SILENCE);
 
     // mix the priority context (only tones)
     result = priorityContext.mixBuffer(buffer, g_eeGeneral.beepVolume, fade);
@@ -806,10 +1014,7 @@ void AudioQueue::wakeup()
 
 #if defined(SOFTWARE_VOLUME)
       if (currentSpeakerVolume > 0) {
-        for (uint32_t i=0; i<buffer->size; ++i) {
-          int32_t tmpSample = (int32_t) ((uint32_t) (buffer->data[i]) - AUDIO_DATA_SILENCE);  // conversion from uint16_t
-          buffer->data[i] = (int16_t) (((tmpSample * currentSpeakerVolume) / VOLUME_LEVEL_MAX) + AUDIO_DATA_SILENCE);
-        }
+        applySoftwareVolume(buffer);
         buffersFifo.audioPushBuffer();
       }
       else {
@@ -827,6 +1032,11 @@ void AudioQueue::wakeup()
     audioConsumeCurrentBuffer();
     DEBUG_TIMER_STOP(debugTimerAudioConsume);
   }
+
+#if defined(SDCARD)
+  // the buffers are full (or there is nothing to play), time to read ahead
+  prefetchNextPrompt();
+#endif
 }
 
 inline unsigned int getToneLength(uint16_t len)
@@ -855,6 +1065,10 @@ bool AudioQueue::isPlaying(uint8_t id)
 
 void AudioQueue::playTone(uint16_t freq, uint16_t len, uint16_t pause, uint8_t flags, int8_t freqIncr)
 {
+#if defined(SIMU)
+  if (simuAudioCallback)
+    simuAudioCallback(freq, len, nullptr);
+#endif
 #if defined(SIMU) && !defined(SIMU_AUDIO)
   return;
 #endif
@@ -890,6 +1104,8 @@ void AudioQueue::playFile(const char * filename, uint8_t flags, uint8_t id)
 {
 #if defined(SIMU)
   TRACE("playFile(\"%s\", flags=%x, id=%d)", filename, flags, id);
+  if (simuAudioCallback)
+    simuAudioCallback(0, 0, filename);
   if (strlen(filename) > AUDIO_FILENAME_MAXLEN) {
     TRACE("file name too long! maximum length is %d characters", AUDIO_FILENAME_MAXLEN);
     return;
@@ -945,6 +1161,7 @@ void AudioQueue::stopSD()
 {
   sdAvailableSystemAudioFiles.reset();
   stopAll();
+  audioPromptsCache.invalidate();
   playTone(0, 0, 100, PLAY_NOW);        // insert a 100ms pause
 }
 
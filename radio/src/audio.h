@@ -104,6 +104,7 @@ enum AudioBufferState
   #define AUDIO_BITS_PER_SAMPLE        16
 #elif defined(PCBX12S)
   typedef int16_t audio_data_t;
+  #define AUDIO_DATA_SIGNED
   #define AUDIO_DATA_SILENCE           0
   #define AUDIO_DATA_MIN               INT16_MIN
   #define AUDIO_DATA_MAX               INT16_MAX
@@ -126,6 +127,76 @@ struct AudioBuffer {
 
 extern AudioBuffer audioBuffers[AUDIO_BUFFER_COUNT];
 
+// Saturates a mixed sample to the DAC range, with a single instruction on Cortex-M3/M4
+inline audio_data_t saturateSample(int32_t value)
+{
+#if defined(AUDIO_DATA_SIGNED) && defined(__SSAT) && !defined(SIMU)
+  return __SSAT(value, AUDIO_BITS_PER_SAMPLE);
+#elif !defined(AUDIO_DATA_SIGNED) && defined(__USAT) && !defined(SIMU)
+  return __USAT(value, AUDIO_BITS_PER_SAMPLE);
+#else
+  return limit<int32_t>(AUDIO_DATA_MIN, value, AUDIO_DATA_MAX);
+#endif
+}
+
+// Mixes one sample, the block helpers below give the same results
+inline void mixSample(audio_data_t * result, int sample, unsigned int fade)
+{
+  *result = saturateSample(*result + ((sample >> fade) >> (16-AUDIO_BITS_PER_SAMPLE)));
+}
+
+// Fills count samples with value, two samples per word store
+inline void fillSamples(audio_data_t * result, uint32_t count, audio_data_t value)
+{
+  typedef uint32_t __attribute__((__may_alias__)) audio_pair_t;
+  if (count > 0 && ((uintptr_t)result & 2)) {
+    *result++ = value;
+    count--;
+  }
+  audio_pair_t pair = (uint16_t)value | ((uint32_t)(uint16_t)value << 16);
+  audio_pair_t * pairs = (audio_pair_t *)result;
+  for (uint32_t i=0; i<count/2; i++) {
+    pairs[i] = pair;
+  }
+  if (count & 1) {
+    result[count-1] = value;
+  }
+}
+
+// Decodes, attenuates, resamples and mixes count samples in one pass.
+// Each decoded sample is scaled once and added to the `ratio` output samples it stands for.
+// decode(i) is called once for each input sample, in order.
+template <class Decoder>
+inline audio_data_t * mixSamples(audio_data_t * result, uint32_t count, uint8_t ratio, unsigned int fade, Decoder decode)
+{
+  unsigned int shift = fade + (16-AUDIO_BITS_PER_SAMPLE);
+  if (ratio == 1) {
+    for (uint32_t i=0; i<count; i++) {
+      result[i] = saturateSample(result[i] + (decode(i) >> shift));
+    }
+    return result + count;
+  }
+  else if (ratio == 2) {
+    for (uint32_t i=0; i<count; i++) {
+      int32_t sample = decode(i) >> shift;
+      result[0] = saturateSample(result[0] + sample);
+      result[1] = saturateSample(result[1] + sample);
+      result += 2;
+    }
+    return result;
+  }
+  else {
+    for (uint32_t i=0; i<count; i++) {
+      int32_t sample = decode(i) >> shift;
+      for (uint8_t j=0; j<ratio; j++) {
+        *result = saturateSample(*result + sample);
+        result++;
+      }
+    }
+    return result;
+  }
+}
+
 enum FragmentTypes {
   FRAGMENT_EMPTY,
   FRAGMENT_TONE,
@@ -214,10 +285,91 @@ class ToneContext {
 
 };
 
+#if defined(SDCARD)
+#if defined(SDRAM)
+  #define AUDIO_PROMPTS_CACHE_SIZE     32
+  #define AUDIO_PROMPT_DATA_MAXSIZE    (16*1024)  // the samples of the prompts up to this size are kept in SDRAM
+#else
+  #define AUDIO_PROMPTS_CACHE_SIZE     8
+#endif
+
+#define AUDIO_PROMPT_IN_USE_DELAY      10  // 100ms, a prompt being played is refreshed every 10ms
+
+// The parsed RIFF header of a recently played (or prefetched) wav file
+struct AudioPromptInfo {
+  char filename[AUDIO_FILENAME_MAXLEN+1];
+  uint32_t offset;      // of the samples in the file
+  uint32_t size;        // of the samples
+  uint32_t freq;
+  tmr10ms_t lastUse;
+  uint8_t users;        // contexts playing this prompt, even paused, the entry can't be replaced
+  uint16_t readSize;
+  uint8_t codec;
+  uint8_t resampleRatio;
+#if defined(AUDIO_PROMPT_DATA_MAXSIZE)
+  uint32_t loaded;      // size of the samples already in the cache data
+#endif
+};
+
+class AudioPromptsCache {
+  public:
+    AudioPromptInfo * find(const char * filename);
+    AudioPromptInfo * add(const AudioPromptInfo & info);
+    // reads the header (and the samples when they fit in the cache) of a file not played yet
+    bool load(const char * filename);
+
+    // called from any task when the SD content may have changed
+    void invalidate()
+    {
+      invalidated = true;
+    }
+
+    // called from the audio task, returns true when the entries have been flushed
+    bool checkInvalidated()
+    {
+      if (invalidated) {
+        invalidated = false;
+        memclear(entries, sizeof(entries));
+        return true;
+      }
+      return false;
+    }
+
+#if defined(AUDIO_PROMPT_DATA_MAXSIZE)
+    uint8_t * getData(const AudioPromptInfo * prompt) const;
+
+    bool isLoaded(const AudioPromptInfo * prompt) const
+    {
+      return prompt->loaded == prompt->size;
+    }
+
+    bool fitsData(const AudioPromptInfo * prompt) const
+    {
+      return prompt->size <= AUDIO_PROMPT_DATA_MAXSIZE;
+    }
+#endif
+
+  protected:
+    AudioPromptInfo entries[AUDIO_PROMPTS_CACHE_SIZE];
+    volatile bool invalidated;
+};
+
+extern AudioPromptsCache audioPromptsCache;
+#endif
+
 class WavContext {
   public:
 
-    inline void clear() { fragment.clear(); };
+    // called with audioMutex locked (or from the audio task)
+    inline void clear()
+    {
+#if defined(SDCARD)
+      if (isStarted()) {
+        setPrompt(nullptr);
+      }
+#endif
+      fragment.clear();
+    };
 
     int mixBuffer(AudioBuffer *buffer, int volume, unsigned int fade);
     bool hasPromptId(uint8_t id) const { return fragment.id == id; };
@@ -230,13 +382,34 @@ class WavContext {
     void stop(uint8_t id)
     {
       if (fragment.id == id) {
+        clear();
+      }
+    }
+
+#if defined(SDCARD)
+    // the prompts cache entries have been flushed, a file played from the cache data is stopped
+    void releasePrompt()
+    {
+      if (isStarted() && state.inMemory) {
         fragment.clear();
       }
+      state.prompt = nullptr;
     }
+#endif
 
   private:
     AudioFragment fragment;
 
+    // the state is only valid once the file has been opened
+    bool isStarted() const
+    {
+      return fragment.type == FRAGMENT_FILE && !fragment.file[1];
+    }
+
+#if defined(SDCARD)
+    void setPrompt(AudioPromptInfo * prompt);
+#endif
+
     struct {
       FIL      file;
       uint8_t  codec;
@@ -244,6 +417,10 @@ class WavContext {
       uint32_t size;
       uint8_t  resampleRatio;
       uint16_t readSize;
+#if defined(SDCARD)
+      AudioPromptInfo * prompt;   // the cache entry of the file, if any
+      bool     inMemory;          // the samples are read from the cache data
+#endif
     } state;
 };
 
@@ -255,7 +432,7 @@ class MixedContext {
 
     MixedContext()
     {
-      clear();
+      tone.clear();
     }
 
     void setFragment(const AudioFragment * frag)
@@ -267,6 +444,9 @@ class MixedContext {
 
     inline void clear()
     {
+      if (isFile()) {
+        wav.clear();  // releases its prompt
+      }
       tone.clear();   // the biggest member of the uninon
     }
 
@@ -284,6 +464,15 @@ class MixedContext {
       return 0;
     }
 
+#if defined(SDCARD)
+    void releasePrompt()
+    {
+      if (isFile()) {
+        wav.releasePrompt();
+      }
+    }
+#endif
+
   private:
     union {
       AudioFragment fragment;   // a hack: fragment is used to access the fragment members of tone and wav
@@ -467,6 +656,11 @@ class AudioFragmentFifo
       widx = ridx;                      // clean the queue
     }
 
+    const AudioFragment * peek() const
+    {
+      return empty() ? nullptr : &fragments[ridx];
+    }
+
     const AudioFragment * get()
     {
       if (!empty()) {
@@ -520,6 +714,10 @@ class AudioQueue {
     AudioBufferFifo buffersFifo;
 
   private:
+#if defined(SDCARD)
+    void prefetchNextPrompt();
+    uint32_t lastPrefetchHash = 0;
+#endif
     volatile bool _started;
     MixedContext normalContext;
     WavContext   backgroundContext;
@@ -531,6 +729,12 @@ class AudioQueue {
 extern uint8_t currentSpeakerVolume;
 extern AudioQueue audioQueue;
 
+#if defined(SIMU)
+  // lets the simulator record the tones and files which are queued, even without audio output
+  typedef void (*simuAudioCallbackFunc)(uint16_t freq, uint16_t len, const char * filename);
+  extern simuAudioCallbackFunc simuAudioCallback;
+#endif
+
 enum {
   // IDs for special functions [0:64]
   // IDs for global functions [64:128]
@@ -38,7 +38,7 @@ bool bin_free(void * ptr)
 }
 
 void * bin_malloc(size_t size) {
-  //try to allocate from our space
+  //try to allocate from the smallest size class which fits
   void * res = slots1.malloc(size);
   return res ? res : slots2.malloc(size);
 }
@@ -56,13 +56,20 @@ void * bin_realloc(void * ptr, size_t size)
     }
 
     //we have existing data
-    // if it fits in current slot, return it
-    // TODO if new size is smaller, try to relocate in smaller slot
+    // if it fits in current slot, return it, unless it can move to a smaller slot
     if ( slots1.can_fit(ptr, size) ) {
       // TRACE("OUR realloc %p[%lu] fits in slot1", ptr, size);
       return ptr;
     }
     if ( slots2.can_fit(ptr, size) ) {
+      if (size <= slots1.slotSize()) {
+        void * res = slots1.malloc(size);
+        if (res) {
+          memcpy(res, ptr, size);
+          slots2.free(ptr);
+          return res;
+        }
+      }
       // TRACE("OUR realloc %p[%lu] fits in slot2", ptr, size);
       return ptr;
     }
@@ -85,7 +92,6 @@ void * bin_realloc(void * ptr, size_t size)
   }
 }
 
-
 void *bin_l_alloc (void *ud, void *ptr, size_t osize, size_t nsize)
 {
   (void)ud; (void)osize;  /* not used */
@@ -113,6 +119,15 @@ void *bin_l_alloc (void *ud, void *ptr, size_t osize, size_t nsize)
       return 0;
     }
 #endif // #if defined(DEBUG)
+    // a libc block shrinking to a slot size moves into our slots, keeping the heap for big blocks
+    if (ptr && nsize < osize && !(slots1.is_member(ptr) || slots2.is_member(ptr))) {
+      void * res = bin_malloc(nsize);
+      if (res) {
+        memcpy(res, ptr, nsize);
+        free(ptr);
+        return res;
+      }
+    }
     // try our allocator, if it fails use libc allocator
     void * res = bin_realloc(ptr, nsize);
     if (res && ptr) {
@@ -23,51 +23,67 @@
 
 #include "debug.h"
 
+// Fixed size slots allocator: free slots are chained in a free list stored
+// in the slots themselves, so both malloc() and free() are O(1)
 template <int SIZE_SLOT, int NUM_BINS> class BinAllocator {
+  static_assert(SIZE_SLOT % 4 == 0, "BinAllocator slots must keep 4 bytes alignment");
+  static_assert(NUM_BINS < 0xFFFF, "BinAllocator too many slots");
 private:
-  PACK(struct Bin {
+  union Bin {
     char data[SIZE_SLOT];
-    bool Used;
-  });
-  struct Bin Bins[NUM_BINS];
-  int NoUsedBins;
+    uint16_t next;    // index of next free slot while this one is free
+    uint32_t align;
+  };
+  union Bin Bins[NUM_BINS];
+  uint16_t FirstFreeBin;
+  uint16_t NoUsedBins;
+  uint16_t MaxUsedBins;
+  uint32_t NoFailures;
 public:
-  BinAllocator() : NoUsedBins(0) {
-    memclear(Bins, sizeof(Bins));
+  BinAllocator() {
+    clear();
+  }
+  void clear() {
+    for (int n = 0; n < NUM_BINS; ++n) {
+      Bins[n].next = n + 1;
+    }
+    FirstFreeBin = 0;
+    NoUsedBins = 0;
+    MaxUsedBins = 0;
+    NoFailures = 0;
   }
   bool free(void * ptr) {
-    for (size_t n = 0; n < NUM_BINS; ++n) {
-      if (ptr == Bins[n].data) {
-        Bins[n].Used = false;
-        --NoUsedBins;
-        // TRACE("\tBinAllocator<%d> free %lu ------", SIZE_SLOT, n);
-        return true;
-      }
+    if (!is_member(ptr)) {
+      return false;
     }
-    return false;
+    uint16_t n = (union Bin *)ptr - Bins;
+    Bins[n].next = FirstFreeBin;
+    FirstFreeBin = n;
+    --NoUsedBins;
+    // TRACE("\tBinAllocator<%d> free %lu ------", SIZE_SLOT, n);
+    return true;
   }
   bool is_member(void * ptr) {
-    return (ptr >= Bins[0].data && ptr <= Bins[NUM_BINS-1].data);
+    // only slot starts are ever handed out, so the range is enough
+    return (ptr >= (void *)&Bins[0] && ptr <= (void *)&Bins[NUM_BINS-1]);
   }
   void * malloc(size_t size) {
     if (size > SIZE_SLOT) {
       // TRACE("BinAllocator<%d> malloc [%lu] size > SIZE_SLOT", SIZE_SLOT, size);
       return 0;
     }
-    if (NoUsedBins >= NUM_BINS) {
+    if (FirstFreeBin >= NUM_BINS) {
       // TRACE("BinAllocator<%d> malloc [%lu] no free slots", SIZE_SLOT, size);
+      ++NoFailures;
       return 0;
     }
-    for (size_t n = 0; n < NUM_BINS; ++n) {
-      if (!Bins[n].Used) {
-        Bins[n].Used = true;
-        ++NoUsedBins;
-        // TRACE("\tBinAllocator<%d> malloc %lu[%lu]", SIZE_SLOT, n, size);
-        return Bins[n].data;
-      }
+    union Bin * bin = &Bins[FirstFreeBin];
+    FirstFreeBin = bin->next;
+    if (++NoUsedBins > MaxUsedBins) {
+      MaxUsedBins = NoUsedBins;
     }
-    // TRACE("BinAllocator<%d> malloc [%lu] no free slots", SIZE_SLOT , size);
-    return 0;
+    // TRACE("\tBinAllocator<%d> malloc %lu[%lu]", SIZE_SLOT, bin - Bins, size);
+    return bin->data;
   }
   size_t size(void * ptr) {
     return is_member(ptr) ? SIZE_SLOT : 0;
@@ -75,16 +91,19 @@ public:
   bool can_fit(void * ptr, size_t size) {
     return is_member(ptr) && size <= SIZE_SLOT;  //todo is_member check is redundant
   }
+  unsigned int slotSize() { return SIZE_SLOT; }
   unsigned int capacity() { return NUM_BINS; }
   unsigned int size() { return NoUsedBins; }
+  unsigned int highWaterMark() { return MaxUsedBins; }
+  unsigned int failures() { return NoFailures; }
 };
 
 #if defined(SIMU)
-typedef BinAllocator<39,300> BinAllocator_slots1;
-typedef BinAllocator<79,100> BinAllocator_slots2;
+typedef BinAllocator<40,300> BinAllocator_slots1;
+typedef BinAllocator<80,100> BinAllocator_slots2;
 #else
-typedef BinAllocator<29,200> BinAllocator_slots1;
-typedef BinAllocator<91,50> BinAllocator_slots2;
+typedef BinAllocator<32,200> BinAllocator_slots1;
+typedef BinAllocator<92,50> BinAllocator_slots2;
 #endif
 
 #if defined(USE_BIN_ALLOCATOR)
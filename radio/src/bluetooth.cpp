@@ -52,9 +52,9 @@ void Bluetooth::write(const uint8_t * data, uint8_t length)
     BLUETOOTH_TRACE("BT>");
     for (int i = 0; i < length; i++) {
       BLUETOOTH_TRACE(" %02X", data[i]);
-      btTxFifo.push(data[i]);
     }
     BLUETOOTH_TRACE(CRLF);
+    btTxFifo.pushMany(data, length);
   }
   else {
     BLUETOOTH_TRACE("[BT] TX fifo full!" CRLF);
@@ -66,11 +66,8 @@ void Bluetooth::write(const uint8_t * data, uint8_t length)
 void Bluetooth::writeString(const char * str)
 {
   BLUETOOTH_TRACE("BT> %s" CRLF, str);
-  while (*str != 0) {
-    btTxFifo.push(*str++);
-  }
-  btTxFifo.push('\r');
-  btTxFifo.push('\n');
+  btTxFifo.pushMany((const uint8_t *)str, strlen(str));
+  btTxFifo.pushMany((const uint8_t *)CRLF, 2);
   bluetoothWriteWakeup();
 }
 
@@ -20,6 +20,7 @@
 
 #include "opentx.h"
 #include "diskio.h"
+#include "bin_allocator.h"
 #include <ctype.h>
 #include <malloc.h>
 #include <new>
@@ -752,6 +753,12 @@ int cliMemoryInfo(const char ** argv)
   serialPrint("------------");
   serialPrint("\tTotal   %u", s + w + e);
 #endif
+#endif
+
+#if defined(USE_BIN_ALLOCATOR)
+  serialPrint("\nBin allocator:");
+  serialPrint("\tslots1 %u/%u (max %u, failures %u) x %u bytes", slots1.size(), slots1.capacity(), slots1.highWaterMark(), slots1.failures(), slots1.slotSize());
+  serialPrint("\tslots2 %u/%u (max %u, failures %u) x %u bytes", slots2.size(), slots2.capacity(), slots2.highWaterMark(), slots2.failures(), slots2.slotSize());
 #endif
   return 0;
 }
@@ -1072,6 +1079,7 @@ int cliDisplay(const char ** argv)
     DiskCacheStats stats = diskCache.getStats();
     uint32_t hitRate = diskCache.getHitRate();
     serialPrint("Disk Cache stats: w:%u r: %u, h: %u(%0.1f%%), m: %u", stats.noWrites, (stats.noHits + stats.noMisses), stats.noHits, hitRate*0.1f, stats.noMisses);
+    serialPrint("  evictions: %u, read-aheads: %u, write-backs: %u", stats.noEvictions, stats.noReadAheads, stats.noWriteBacks);
   }
 #endif
   else if (toLongLongInt(argv, 1, &address) > 0) {
@@ -1093,6 +1101,11 @@ int cliDebugVars(const char ** argv)
   serialPrint("sdReadRetries=%d", sdReadRetries);
 #elif defined(PCBTARANIS)
   serialPrint("telemetryErrors=%d", telemetryErrors);
+  serialPrint("telemetryFifo overflows=%d, highWater=%d", telemetryFifo.getOverflows(), telemetryFifo.getHighWater());
+#endif
+#if defined(AUX_SERIAL) && defined(STM32)
+  extern Fifo<uint8_t, 512> auxSerialTxFifo;
+  serialPrint("auxSerialTxFifo overflows=%d, highWater=%d", auxSerialTxFifo.getOverflows(), auxSerialTxFifo.getHighWater());
 #endif
 
   return 0;
@@ -1120,6 +1133,23 @@ int cliRepeat(const char ** argv)
   return 0;
 }
 
+int cliMixerScheduler(const char ** argv)
+{
+  if (argv[1] && !strcmp(argv[1], "reset")) {
+    resetMixerSchedulerStats();
+    return 0;
+  }
+
+  serialPrint("mixer duration avg=%dus max=%dus", mixerDurationAverage / 2, maxMixerDuration / 2);
+  for (uint8_t i=0; i<NUM_MODULES; i++) {
+    const MixerSchedulerStats & stats = mixerSchedulerStats[i];
+    serialPrint("module %d: period=%dms max lateness=%dms", i, stats.period, stats.maxLateness);
+    serialPrint("  lateness (ticks of %dms) 0:%d 1:%d 2-3:%d 4-7:%d 8-15:%d 16+:%d", RTOS_MS_PER_TICK, stats.lateness[0], stats.lateness[1], stats.lateness[2], stats.lateness[3], stats.lateness[4], stats.lateness[5]);
+    serialPrint("  jitter   (ticks of %dms) 0:%d 1:%d 2-3:%d 4-7:%d 8-15:%d 16+:%d", RTOS_MS_PER_TICK, stats.jitter[0], stats.jitter[1], stats.jitter[2], stats.jitter[3], stats.jitter[4], stats.jitter[5]);
+  }
+  return 0;
+}
+
 #if defined(JITTER_MEASURE)
 int cliShowJitter(const char ** argv)
 {
@@ -1209,6 +1239,7 @@ const CliCommand cliCommands[] = {
   { "help", cliHelp, "[<command>]" },
   { "debugvars", cliDebugVars, "" },
   { "repeat", cliRepeat, "<interval> <command>" },
+  { "scheduler", cliMixerScheduler, "[reset]" },
 #if defined(JITTER_MEASURE)
   { "jitter", cliShowJitter, "" },
 #endif
@@ -21,6 +21,7 @@
 #include "opentx.h"
 
 int8_t * curveEnd[MAX_CURVES];
+
 void loadCurves()
 {
   bool showWarning= false;
@@ -50,6 +51,7 @@ void loadCurves()
     curveEnd[i] = tmp;
 
   }
+  invalidateCurvesCache();
   if (showWarning) {
     POPUP_WARNING("Invalid curve data repaired");
     const char * w = "check your curves, logic switches";
@@ -157,6 +159,51 @@ int32_t compute_tangent(CurveInfo * crv, int8_t * points, int i)
     return m;
 }
 
+// The tangents of the smooth curves are computed once per edit, instead of twice per
+// hermite_spline() call, and stored at the same offset as the curve points.
+// Edits only invalidate the cache, it is rebuilt by the menus task (which does the edits)
+// once they are finished, and published under mixerMutex. Until then the tangents are
+// computed on the fly.
+struct CurvesCache {
+  uint32_t edits;                     // incremented on each invalidation
+  uint32_t built;                     // value of edits the tangents were computed for
+  int32_t tangents[MAX_CURVE_POINTS];
+};
+
+CurvesCache curvesCache = { 1, 0 };
+
+void invalidateCurvesCache()
+{
+  curvesCache.edits++;
+}
+
+void updateCurvesCache()
+{
+  uint32_t edits = curvesCache.edits;
+  if (curvesCache.built == edits) {
+    return;
+  }
+
+  int32_t tangents[MAX_POINTS_PER_CURVE];
+  for (uint8_t idx=0; idx<MAX_CURVES; idx++) {
+    CurveInfo & crv = g_model.curves[idx];
+    int8_t * points = curveAddress(idx);
+    uint8_t count = crv.points + 5;
+    uint32_t offset = points - g_model.points;
+    if (!crv.smooth || offset + count > MAX_CURVE_POINTS) {
+      continue;
+    }
+    for (int i=0; i<count; i++) {
+      tangents[i] = compute_tangent(&crv, points, i);
+    }
+    pauseMixerCalculations();
+    memcpy(&curvesCache.tangents[offset], tangents, count * sizeof(int32_t));
+    resumeMixerCalculations();
+  }
+
+  curvesCache.built = edits;
+}
+
 /* The following is a hermite cubic spline.
    The basis functions can be found here:
    http://en.wikipedia.org/wiki/Cubic_Hermite_spline
@@ -167,6 +214,8 @@ int16_t hermite_spline(int16_t x, uint8_t idx)
   CurveInfo &crv = g_model.curves[idx];
   int8_t *points = curveAddress(idx);
   uint8_t count = crv.points+5;
+  uint32_t offset = points - g_model.points;
+  const int32_t * tangents = (curvesCache.built == curvesCache.edits && offset + count <= MAX_CURVE_POINTS ? &curvesCache.tangents[offset] : nullptr);
   bool custom = (crv.type == CURVE_TYPE_CUSTOM);
 
   if (x < -RESX)
@@ -188,8 +237,8 @@ int16_t hermite_spline(int16_t x, uint8_t idx)
     if (x >= p0x && x <= p3x) {
       int32_t p0y = calc100toRESX(points[i]);
       int32_t p3y = calc100toRESX(points[i+1]);
-      int32_t m0 = compute_tangent(&crv, points, i);
-      int32_t m3 = compute_tangent(&crv, points, i+1);
+      int32_t m0 = (tangents ? tangents[i] : compute_tangent(&crv, points, i));
+      int32_t m3 = (tangents ? tangents[i+1] : compute_tangent(&crv, points, i+1));
       int32_t y;
       int32_t h = p3x - p0x;
       int32_t t = (h > 0 ? (MMULT * (x - p0x)) / h : 0);
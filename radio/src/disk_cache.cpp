@@ -21,7 +21,15 @@
 #include <string.h>
 #include "opentx.h"
 
-#if defined(SIMU) && !defined(SIMU_DISKIO)
+#if defined(SIMU) && !defined(SIMU_DISKIO) && defined(GTESTS)
+  // the tests provide a RAM disk
+  DRESULT simuDiskRead(BYTE drv, BYTE * buff, DWORD sector, UINT count);
+  DRESULT simuDiskWrite(BYTE drv, const BYTE * buff, DWORD sector, UINT count);
+  uint32_t simuDiskSectors();
+  #define __disk_read         simuDiskRead
+  #define __disk_write        simuDiskWrite
+  #define sdGetNoSectors      simuDiskSectors
+#elif defined(SIMU) && !defined(SIMU_DISKIO)
   #define __disk_read(...)    (RES_OK)
   #define __disk_write(...)   (RES_OK)
 #endif
@@ -36,21 +44,21 @@ DiskCache diskCache;
 
 DiskCacheBlock::DiskCacheBlock():
   startSector(0),
-  endSector(0) 
+  endSector(0),
+  lastUse(0),
+  dirty(0),
+  next(DISK_CACHE_NO_BLOCK),
+  reused(0)
 {
 }
 
-bool DiskCacheBlock::read(BYTE * buff, DWORD sector, UINT count)
+void DiskCacheBlock::read(BYTE * buff, DWORD sector, UINT count) const
 {
-  if (sector >= startSector && (sector+count) <= endSector) {
-    TRACE_DISK_CACHE("\tcache read(%u, %u) from %p", (uint32_t)sector, (uint32_t)count, this);
-    memcpy(buff, data + ((sector - startSector) * BLOCK_SIZE), count * BLOCK_SIZE);
-    return true;
-  }
-  return false;
+  TRACE_DISK_CACHE("\tcache read(%u, %u) from %p", (uint32_t)sector, (uint32_t)count, this);
+  memcpy(buff, data + ((sector - startSector) * BLOCK_SIZE), count * BLOCK_SIZE);
 }
 
-DRESULT DiskCacheBlock::fill(BYTE drv, BYTE * buff, DWORD sector, UINT count)
+DRESULT DiskCacheBlock::fill(BYTE drv, DWORD sector)
 {
   DRESULT res = __disk_read(drv, data, sector, DISK_CACHE_BLOCK_SECTORS);
   if (res != RES_OK) {
@@ -58,22 +66,55 @@ DRESULT DiskCacheBlock::fill(BYTE drv, BYTE * buff, DWORD sector, UINT count)
   }
   startSector = sector;
   endSector = sector + DISK_CACHE_BLOCK_SECTORS;
-  memcpy(buff, data, count * BLOCK_SIZE);
-  TRACE_DISK_CACHE("\tcache %p FILLED from read(%u, %u)", this, (uint32_t)sector, (uint32_t)count);
+  dirty = 0;
+  reused = 0;
+  TRACE_DISK_CACHE("\tcache %p FILLED from sector %u", this, (uint32_t)sector);
   return RES_OK;
 }
 
-void DiskCacheBlock::free(DWORD sector, UINT count) 
+void DiskCacheBlock::update(const BYTE * buff, DWORD sector, UINT count, bool deferred)
 {
-  if (sector < endSector && (sector+count) > startSector) {
-    TRACE_DISK_CACHE("\tINVALIDATING disk cache block %p (%u)", this, startSector);
-    endSector = 0;
+  DWORD start = max<DWORD>(sector, startSector);
+  DWORD end = min<DWORD>(sector + count, endSector);
+  if (start >= end) {
+    return;
+  }
+  TRACE_DISK_CACHE("\tcache %p UPDATED (%u, %u)", this, (uint32_t)start, (uint32_t)(end - start));
+  memcpy(data + (start - startSector) * BLOCK_SIZE, buff + (start - sector) * BLOCK_SIZE, (end - start) * BLOCK_SIZE);
+  uint16_t mask = ((1u << (end - start)) - 1) << (start - startSector);
+  if (deferred)
+    dirty |= mask;
+  else
+    dirty &= ~mask;
+}
+
+DRESULT DiskCacheBlock::flush(BYTE drv)
+{
+  // contiguous dirty sectors are written with a single multi-block write
+  unsigned i = 0;
+  while (dirty) {
+    while (!(dirty & (1u << i))) {
+      i++;
+    }
+    unsigned count = 0;
+    while (i + count < DISK_CACHE_BLOCK_SECTORS && (dirty & (1u << (i + count)))) {
+      count++;
+    }
+    TRACE_DISK_CACHE("\tcache %p WRITE BACK (%u, %u)", this, (uint32_t)(startSector + i), count);
+    DRESULT res = __disk_write(drv, data + i * BLOCK_SIZE, startSector + i, count);
+    if (res != RES_OK) {
+      return res;
+    }
+    dirty &= ~(((1u << count) - 1) << i);
+    i += count;
   }
+  return RES_OK;
 }
 
 void DiskCacheBlock::free()
 {
   endSector = 0;
+  dirty = 0;
 }
 
 bool DiskCacheBlock::empty() const
@@ -81,79 +122,340 @@ bool DiskCacheBlock::empty() const
   return (endSector == 0);
 }
 
+bool DiskCacheBlock::overlaps(DWORD sector, UINT count) const
+{
+  return sector < endSector && (sector + count) > startSector;
+}
+
 DiskCache::DiskCache():
-  lastBlock(0)
+  useCounter(0),
+  lastReadEnd(0),
+  reusedBlocks(0),
+  writeBackTime(0),
+  writeBackPending(false)
 {
-  stats.noHits = 0;
-  stats.noMisses = 0;
-  stats.noWrites = 0;
+  memclear(&stats, sizeof(stats));
+  memset(hashTable, DISK_CACHE_NO_BLOCK, sizeof(hashTable));
   blocks = new DiskCacheBlock[DISK_CACHE_BLOCKS_NUM];
 }
 
 void DiskCache::clear()
 {
-  lastBlock = 0;
-  stats.noHits = 0;
-  stats.noMisses = 0;
-  stats.noWrites = 0;
+  // the cached blocks may not match the card anymore (USB mass storage), pending writes go first
+  if (flush(0) != RES_OK) {
+    TRACE_ERROR("disk cache: pending writes lost");
+  }
+
+  useCounter = 0;
+  lastReadEnd = 0;
+  reusedBlocks = 0;
+  writeBackPending = false;
+  memclear(&stats, sizeof(stats));
+  memset(hashTable, DISK_CACHE_NO_BLOCK, sizeof(hashTable));
   for (int n=0; n<DISK_CACHE_BLOCKS_NUM; ++n) {
     blocks[n].free();
+    blocks[n].next = DISK_CACHE_NO_BLOCK;
+    blocks[n].reused = 0;
   }
 }
 
-DRESULT DiskCache::read(BYTE drv, BYTE * buff, DWORD sector, UINT count)
+uint8_t DiskCache::hash(DWORD sector)
 {
-  // TODO: check if not caching first sectors would improve anything
-  // if (sector < 1000) {
-  //   ++stats.noMisses;
-  //   return __disk_read(drv, buff, sector, count);  
-  // }
+  return (sector / DISK_CACHE_BLOCK_SECTORS) & (DISK_CACHE_HASH_SIZE - 1);
+}
 
-  // if read is bigger than cache block, then read it directly without using cache
-  if (count > DISK_CACHE_BLOCK_SECTORS) {
-    TRACE_DISK_CACHE("\t\t big read(%u, %u)",  (uint32_t)sector, (uint32_t)count);
-    return __disk_read(drv, buff, sector, count);
+DiskCacheBlock * DiskCache::find(DWORD sector)
+{
+  for (uint8_t n = hashTable[hash(sector)]; n != DISK_CACHE_NO_BLOCK; n = blocks[n].next) {
+    if (blocks[n].startSector == sector && !blocks[n].empty()) {
+      return &blocks[n];
+    }
   }
-  
-  // if block + cache block size is beyond the end of the disk, then read it directly without using cache
-  if (sector+DISK_CACHE_BLOCK_SECTORS >= sdGetNoSectors()) {
-    TRACE_DISK_CACHE("\t\t cache would be beyond end of disk %u (%u)", (uint32_t)sector, sdGetNoSectors());
-    return __disk_read(drv, buff, sector, count);
+  return nullptr;
+}
+
+void DiskCache::release(uint8_t index)
+{
+  DiskCacheBlock & block = blocks[index];
+  uint8_t * link = &hashTable[hash(block.startSector)];
+  while (*link != DISK_CACHE_NO_BLOCK) {
+    if (*link == index) {
+      *link = block.next;
+      break;
+    }
+    link = &blocks[*link].next;
   }
+  block.next = DISK_CACHE_NO_BLOCK;
+  if (block.reused) {
+    block.reused = 0;
+    --reusedBlocks;
+  }
+  block.free();
+}
+
+void DiskCache::protect(DiskCacheBlock * block)
+{
+  if (block->reused) {
+    return;
+  }
+
+  // keep enough unprotected blocks for sequential reads, the least recently
+  // used protected block goes back to the unprotected ones
+  if (reusedBlocks >= DISK_CACHE_REUSED_MAX) {
+    DiskCacheBlock * oldest = nullptr;
+    for (int n=0; n<DISK_CACHE_BLOCKS_NUM; ++n) {
+      if (blocks[n].reused && (!oldest || blocks[n].lastUse < oldest->lastUse)) {
+        oldest = &blocks[n];
+      }
+    }
+    oldest->reused = 0;
+    --reusedBlocks;
+  }
+
+  block->reused = 1;
+  ++reusedBlocks;
+}
 
+void DiskCache::touch(DiskCacheBlock * block)
+{
+  block->lastUse = ++useCounter;
+}
+
+DRESULT DiskCache::flushBlock(BYTE drv, DiskCacheBlock & block)
+{
+  if (!block.dirty) {
+    return RES_OK;
+  }
+  ++stats.noWriteBacks;
+  return block.flush(drv);
+}
+
+DRESULT DiskCache::flush(BYTE drv, DWORD sector, UINT count)
+{
+  DRESULT result = RES_OK;
   for (int n=0; n<DISK_CACHE_BLOCKS_NUM; ++n) {
-    if (blocks[n].read(buff, sector, count)) {
-      ++stats.noHits;
-      return RES_OK;
+    if (blocks[n].overlaps(sector, count)) {
+      DRESULT res = flushBlock(drv, blocks[n]);
+      if (res != RES_OK) {
+        result = res;
+      }
     }
   }
+  return result;
+}
 
-  ++stats.noMisses;
+DRESULT DiskCache::flush(BYTE drv)
+{
+  if (!writeBackPending) {
+    return RES_OK;
+  }
+  DRESULT result = RES_OK;
+  for (int n=0; n<DISK_CACHE_BLOCKS_NUM; ++n) {
+    DRESULT res = flushBlock(drv, blocks[n]);
+    if (res != RES_OK) {
+      result = res;
+    }
+  }
+  writeBackPending = (result != RES_OK);
+  return result;
+}
 
-  // find free block
+bool DiskCache::writeBackExpired() const
+{
+  return writeBackPending && (tmr10ms_t)(get_tmr10ms() - writeBackTime) >= DISK_CACHE_WRITE_BACK_DELAY;
+}
+
+// Called periodically from perMain(): deferred writes must reach the card
+// even when there is no further disk access
+void DiskCache::wakeup(BYTE drv)
+{
+  if (!writeBackExpired()) {
+    return;
+  }
+
+#if defined(SIMU) && !defined(SIMU_DISKIO)
+  flush(drv);
+#else
+  // FatFs calls are the other users of the cache, take the same lock
+  ff_req_grant(g_FATFS_Obj.sobj);
+  if (writeBackExpired()) {
+    flush(drv);
+  }
+  ff_rel_grant(g_FATFS_Obj.sobj);
+#endif
+}
+
+DiskCacheBlock * DiskCache::allocate(BYTE drv, DWORD sector)
+{
+  // Victim selection is a segmented LRU: blocks which were only ever read
+  // sequentially (audio, bitmaps) are evicted before the protected blocks
+  // re-read at random (FAT, directories), so streaming a file does not flush
+  // the whole cache
+  int victim = -1;
+  int victimReused = 0;
   for (int n=0; n<DISK_CACHE_BLOCKS_NUM; ++n) {
-    if (blocks[n].empty()) {
-      TRACE_DISK_CACHE("\t\t using free block");
-      return blocks[n].fill(drv, buff, sector, count);
+    DiskCacheBlock & block = blocks[n];
+    if (block.empty()) {
+      victim = n;
+      break;
+    }
+    if (victim < 0 || block.reused < victimReused || (block.reused == victimReused && block.lastUse < blocks[victim].lastUse)) {
+      victim = n;
+      victimReused = block.reused;
+    }
+  }
+
+  DiskCacheBlock & block = blocks[victim];
+  if (!block.empty()) {
+    TRACE_DISK_CACHE("\t\t evicting block %p (%u)", &block, (uint32_t)block.startSector);
+    ++stats.noEvictions;
+    if (flushBlock(drv, block) != RES_OK) {
+      return nullptr;
+    }
+    release(victim);
+  }
+
+  block.startSector = sector;
+  block.next = hashTable[hash(sector)];
+  hashTable[hash(sector)] = victim;
+  touch(&block);
+  return &block;
+}
+
+void DiskCache::readAhead(BYTE drv, DWORD sector)
+{
+  for (int n=0; n<DISK_CACHE_READ_AHEAD; ++n, sector += DISK_CACHE_BLOCK_SECTORS) {
+    if (sector + DISK_CACHE_BLOCK_SECTORS > sdGetNoSectors()) {
+      return;
+    }
+    if (find(sector)) {
+      continue;
+    }
+    DiskCacheBlock * block = allocate(drv, sector);
+    if (!block) {
+      return;
+    }
+    if (block->fill(drv, sector) != RES_OK) {
+      release(block - blocks);
+      return;
+    }
+    ++stats.noReadAheads;
+  }
+}
+
+DRESULT DiskCache::read(BYTE drv, BYTE * buff, DWORD sector, UINT count)
+{
+  if (writeBackExpired()) {
+    flush(drv);
+  }
+
+  bool sequential = (sector == lastReadEnd);
+  lastReadEnd = sector + count;
+
+  // if read is bigger than cache block, then read it directly without using cache
+  if (count > DISK_CACHE_BLOCK_SECTORS) {
+    TRACE_DISK_CACHE("\t\t big read(%u, %u)",  (uint32_t)sector, (uint32_t)count);
+    DRESULT res = flush(drv, sector, count);
+    if (res != RES_OK) {
+      return res;
     }
+    return __disk_read(drv, buff, sector, count);
   }
 
-  // use next block (round robin)
-  // TODO: use better strategy to select which used block gets used here
-  if (++lastBlock >= DISK_CACHE_BLOCKS_NUM) {
-    lastBlock = 0;
+  while (count > 0) {
+    DWORD start = sector - (sector % DISK_CACHE_BLOCK_SECTORS);
+    UINT n = min<UINT>(count, start + DISK_CACHE_BLOCK_SECTORS - sector);
+
+    bool filled = false;
+    DiskCacheBlock * block = find(start);
+    if (block) {
+      ++stats.noHits;
+      if (!sequential) {
+        protect(block);
+      }
+      touch(block);
+    }
+    else {
+      ++stats.noMisses;
+      // if cache block is beyond the end of the disk, then read it directly without using cache
+      if (start + DISK_CACHE_BLOCK_SECTORS > sdGetNoSectors()) {
+        TRACE_DISK_CACHE("\t\t cache would be beyond end of disk %u (%u)", (uint32_t)sector, sdGetNoSectors());
+        return __disk_read(drv, buff, sector, count);
+      }
+      block = allocate(drv, start);
+      if (!block) {
+        return __disk_read(drv, buff, sector, count);
+      }
+      DRESULT res = block->fill(drv, start);
+      if (res != RES_OK) {
+        release(block - blocks);
+        return res;
+      }
+      filled = true;
+    }
+
+    block->read(buff, sector, n);
+    if (filled && sequential) {
+      readAhead(drv, start + DISK_CACHE_BLOCK_SECTORS);
+    }
+    buff += n * BLOCK_SIZE;
+    sector += n;
+    count -= n;
   }
-  
-  return blocks[lastBlock].fill(drv, buff, sector, count);
+
+  return RES_OK;
 }
 
 DRESULT DiskCache::write(BYTE drv, const BYTE* buff, DWORD sector, UINT count)
 {
   ++stats.noWrites;
-  for(int n=0; n < DISK_CACHE_BLOCKS_NUM; ++n) {
-    blocks[n].free(sector, count);
+
+  // FatFs writes the FAT, directory and FSInfo sectors from its window: they are
+  // written through, after the deferred file data, so that the file system on
+  // the card stays consistent if the power is lost or the card removed
+  if (buff == g_FATFS_Obj.win) {
+    DRESULT res = flush(drv);
+    if (res != RES_OK) {
+      return res;
+    }
+  }
+  else {
+    // small writes of file data into a cached block are deferred, repeated
+    // writes to the same sectors (log files) then reach the card once
+    DWORD start = sector - (sector % DISK_CACHE_BLOCK_SECTORS);
+    if (sector + count <= start + DISK_CACHE_BLOCK_SECTORS) {
+      DiskCacheBlock * block = find(start);
+      if (block) {
+        block->update(buff, sector, count, true);
+        touch(block);
+        if (!writeBackPending) {
+          writeBackPending = true;
+          writeBackTime = get_tmr10ms();
+        }
+        else if (writeBackExpired()) {
+          return flush(drv);
+        }
+        return RES_OK;
+      }
+    }
+  }
+
+  // everything else is written through, cached copies are updated
+  DRESULT res = __disk_write(drv, buff, sector, count);
+  for (int n=0; n<DISK_CACHE_BLOCKS_NUM; ++n) {
+    DiskCacheBlock & block = blocks[n];
+    if (block.overlaps(sector, count)) {
+      if (res == RES_OK) {
+        block.update(buff, sector, count, false);
+      }
+      else {
+        TRACE_DISK_CACHE("\tINVALIDATING disk cache block %p (%u)", &block, (uint32_t)block.startSector);
+        flushBlock(drv, block);
+        release(n);
+      }
+    }
   }
-  return __disk_write(drv, buff, sector, count);  
+  return res;
 }
 
 const DiskCacheStats & DiskCache::getStats() const 
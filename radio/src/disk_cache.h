@@ -25,25 +25,44 @@
 #include "sdio_sd.h"
 
 // tunable parameters
-#define DISK_CACHE_BLOCKS_NUM      32   // no cache blocks
-#define DISK_CACHE_BLOCK_SECTORS   16   // no sectors
+#define DISK_CACHE_BLOCKS_NUM        32   // no cache blocks
+#define DISK_CACHE_BLOCK_SECTORS     16   // no sectors (max 16, see DiskCacheBlock::dirty)
+#define DISK_CACHE_HASH_SIZE         64   // no hash buckets (power of 2)
+#define DISK_CACHE_REUSED_MAX        (DISK_CACHE_BLOCKS_NUM / 2)  // max no protected blocks
+#define DISK_CACHE_READ_AHEAD        1    // no blocks read ahead on sequential reads
+#define DISK_CACHE_WRITE_BACK_DELAY  100  // max time (10ms units) file data sectors stay dirty in the cache
 
 #define DISK_CACHE_BLOCK_SIZE   (DISK_CACHE_BLOCK_SECTORS * BLOCK_SIZE)
+#define DISK_CACHE_NO_BLOCK     0xFF
 
+#if DISK_CACHE_BLOCK_SECTORS > 16
+  #error "DISK_CACHE_BLOCK_SECTORS must be <= 16"
+#endif
+
+// A cache block always holds DISK_CACHE_BLOCK_SECTORS sectors starting
+// on a DISK_CACHE_BLOCK_SECTORS boundary
 class DiskCacheBlock
 {
+  friend class DiskCache;
+
 public:
   DiskCacheBlock();
-  bool read(BYTE* buff, DWORD sector, UINT count);
-  DRESULT fill(BYTE drv, BYTE* buff, DWORD sector, UINT count);
-  void free(DWORD sector, UINT count);
+  void read(BYTE* buff, DWORD sector, UINT count) const;
+  DRESULT fill(BYTE drv, DWORD sector);
+  void update(const BYTE* buff, DWORD sector, UINT count, bool deferred);
+  DRESULT flush(BYTE drv);
   void free();
   bool empty() const;
+  bool overlaps(DWORD sector, UINT count) const;
 
 private:
   uint8_t data[DISK_CACHE_BLOCK_SIZE];
   DWORD startSector;
   DWORD endSector;
+  uint32_t lastUse;   // LRU stamp
+  uint16_t dirty;     // one bit per sector not yet written to the card
+  uint8_t next;       // next block in the same hash bucket
+  uint8_t reused;     // block was hit outside of a sequential read
 };
 
 struct DiskCacheStats
@@ -51,6 +70,9 @@ struct DiskCacheStats
   uint32_t noHits;
   uint32_t noMisses;
   uint32_t noWrites;
+  uint32_t noEvictions;
+  uint32_t noReadAheads;
+  uint32_t noWriteBacks;
 };
 
 class DiskCache
@@ -59,14 +81,32 @@ class DiskCache
     DiskCache();
     DRESULT read(BYTE drv, BYTE* buff, DWORD sector, UINT count);
     DRESULT write(BYTE drv, const BYTE* buff, DWORD sector, UINT count);
+    DRESULT flush(BYTE drv);
+    void wakeup(BYTE drv);
     const DiskCacheStats & getStats() const;
     int getHitRate() const;
     void clear();
 
   private:
     DiskCacheStats stats;
-    uint32_t lastBlock;
     DiskCacheBlock * blocks;
+    uint8_t hashTable[DISK_CACHE_HASH_SIZE];
+    uint32_t useCounter;
+    DWORD lastReadEnd;
+    uint8_t reusedBlocks;
+    tmr10ms_t writeBackTime;
+    bool writeBackPending;
+
+    static uint8_t hash(DWORD sector);
+    DiskCacheBlock * find(DWORD sector);
+    DiskCacheBlock * allocate(BYTE drv, DWORD sector);
+    void release(uint8_t index);
+    void protect(DiskCacheBlock * block);
+    void touch(DiskCacheBlock * block);
+    DRESULT flushBlock(BYTE drv, DiskCacheBlock & block);
+    DRESULT flush(BYTE drv, DWORD sector, UINT count);
+    void readAhead(BYTE drv, DWORD sector);
+    bool writeBackExpired() const;
 };
 
 extern DiskCache diskCache;
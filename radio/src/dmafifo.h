@@ -68,6 +68,24 @@ class DMAFifo
       }
     }
 
+    // Returns the contiguous bytes written by the DMA and not read yet. When the data
+    // wraps, the rest is returned by the next call, once this span is consumed with skip()
+    const uint8_t * span(uint32_t & count)
+    {
+#if defined(SIMU)
+      count = 0;
+#else
+      uint32_t widx = (N - stream->NDTR) & (N-1);
+      count = (widx >= ridx ? widx - ridx : N - ridx);
+#endif
+      return &fifo[ridx];
+    }
+
+    void skip(uint32_t count)
+    {
+      ridx = (ridx + count) & (N-1);
+    }
+
     uint8_t * buffer()
     {
       return fifo;
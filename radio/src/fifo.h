@@ -22,7 +22,14 @@
 #define _FIFO_H_
 
 #include <inttypes.h>
+#include <atomic>
 
+/*
+ * Single producer / single consumer ring buffer, used between the ISRs and the tasks.
+ * The producer only writes widx, the consumer only writes ridx, the data slots are
+ * published / released with explicit fences, so that no lock is needed.
+ * One slot is always left empty, a Fifo<T, N> holds N-1 elements at most.
+ */
 template <class T, int N>
 class Fifo
 {
@@ -31,7 +38,9 @@ class Fifo
   public:
     Fifo():
       widx(0),
-      ridx(0)
+      ridx(0),
+      overflows(0),
+      highWater(0)
     {
     }
 
@@ -40,32 +49,100 @@ class Fifo
       widx = ridx = 0;
     }
 
+    // Producer side
+
     void push(T element)
     {
-      uint32_t next = nextIndex(widx);
+      uint32_t w = widx;
+      uint32_t next = nextIndex(w);
       if (next != ridx) {
-        fifo[widx] = element;
+        acquire();
+        fifo[w] = element;
+        release();
         widx = next;
+        updateHighWater(next);
+      }
+      else {
+        overflows++;
       }
     }
 
+    // Pushes as many elements as possible, returns the count of elements pushed
+    uint32_t pushMany(const T * elements, uint32_t count)
+    {
+      uint32_t w = widx;
+      uint32_t available = (N - 1 - w + ridx) & (N - 1);
+      if (count > available) {
+        overflows += count - available;
+        count = available;
+      }
+      acquire();
+      for (uint32_t i = 0; i < count; i++) {
+        fifo[(w + i) & (N - 1)] = elements[i];
+      }
+      release();
+      w = (w + count) & (N - 1);
+      widx = w;
+      updateHighWater(w);
+      return count;
+    }
+
+    // Consumer side
+
     void skip()
     {
       ridx = nextIndex(ridx);
     }
 
+    void skip(uint32_t count)
+    {
+      release();
+      ridx = (ridx + count) & (N - 1);
+    }
+
     bool pop(T & element)
     {
       if (isEmpty()) {
         return false;
       }
       else {
-        element = fifo[ridx];
-        ridx = nextIndex(ridx);
+        uint32_t r = ridx;
+        acquire();
+        element = fifo[r];
+        release();
+        ridx = nextIndex(r);
         return true;
       }
     }
 
+    // Pops up to count elements, returns the count of elements popped
+    uint32_t popMany(T * elements, uint32_t count)
+    {
+      uint32_t r = ridx;
+      uint32_t available = (N + widx - r) & (N - 1);
+      if (count > available) {
+        count = available;
+      }
+      acquire();
+      for (uint32_t i = 0; i < count; i++) {
+        elements[i] = fifo[(r + i) & (N - 1)];
+      }
+      release();
+      ridx = (r + count) & (N - 1);
+      return count;
+    }
+
+    // Returns the contiguous readable elements (which may not be all of them when the data wraps),
+    // they stay valid until consumed with skip(count)
+    const T * span(uint32_t & count) const
+    {
+      uint32_t r = ridx;
+      uint32_t w = widx;
+      acquire();
+      count = (w >= r ? w - r : N - r);
+      return &fifo[r];
+    }
+
     bool isEmpty() const
     {
       return (ridx == widx);
@@ -87,6 +164,11 @@ class Fifo
       return (N > (size() + n));
     }
 
+    uint32_t freeSpace() const
+    {
+      return N - 1 - size();
+    }
+
     bool probe(T & element) const
     {
       if (isEmpty()) {
@@ -98,15 +180,57 @@ class Fifo
       }
     }
 
+    // Statistics
+
+    // Count of elements dropped because the Fifo was full
+    uint32_t getOverflows() const
+    {
+      return overflows;
+    }
+
+    // Max count of elements the Fifo has held
+    uint32_t getHighWater() const
+    {
+      return highWater;
+    }
+
+    void resetStats()
+    {
+      overflows = 0;
+      highWater = 0;
+    }
+
   protected:
     T fifo[N];
     volatile uint32_t widx;
     volatile uint32_t ridx;
+    volatile uint32_t overflows;
+    volatile uint32_t highWater;
 
     static inline uint32_t nextIndex(uint32_t idx)
     {
       return (idx + 1) & (N - 1);
     }
+
+    // The ISRs and the tasks run on the same core, the fences only need to keep
+    // the compiler from moving the slots accesses across the indexes accesses
+    static inline void acquire()
+    {
+      std::atomic_signal_fence(std::memory_order_acquire);
+    }
+
+    static inline void release()
+    {
+      std::atomic_signal_fence(std::memory_order_release);
+    }
+
+    inline void updateHighWater(uint32_t w)
+    {
+      uint32_t count = (N + w - ridx) & (N - 1);
+      if (count > highWater) {
+        highWater = count;
+      }
+    }
 };
 
 #endif // _FIFO_H_
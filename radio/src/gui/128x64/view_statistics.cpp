@@ -135,8 +135,10 @@ void menuStatisticsDebug(event_t event)
 #if defined(LUA)
       maxLuaInterval = 0;
       maxLuaDuration = 0;
+      luaResetUsage();
 #endif
       maxMixerDuration  = 0;
+      resetMixerSchedulerStats();
       break;
 
     case EVT_KEY_FIRST(KEY_UP):
@@ -244,6 +246,9 @@ void menuStatisticsDebug(event_t event)
   lcdDrawTextAlignedLeft(y, STR_TMIXMAXMS);
   lcdDrawNumber(MENU_DEBUG_COL1_OFS, y, DURATION_MS_PREC2(maxMixerDuration), PREC2|LEFT);
   lcdDrawText(lcdLastRightPos, y, "ms");
+  lcdDrawText(lcdLastRightPos+2, y+1, "[L]", SMLSIZE);
+  lcdDrawNumber(lcdLastRightPos, y, getMixerSchedulerMaxLateness(), LEFT);
+  lcdDrawText(lcdLastRightPos, y, "ms");
   y += FH;
 
   lcdDrawTextAlignedLeft(y, STR_FREE_STACK);
@@ -275,6 +280,7 @@ void menuStatisticsDebug2(event_t event)
   switch(event) {
     case EVT_KEY_FIRST(KEY_ENTER):
       telemetryErrors  = 0;
+      telemetryFifo.resetStats();
       break;
 
     case EVT_KEY_FIRST(KEY_UP):
@@ -306,6 +312,9 @@ void menuStatisticsDebug2(event_t event)
   lcdDrawTextAlignedLeft(y, "Tlm RX Err");
   lcdDrawNumber(MENU_DEBUG_COL1_OFS, y, telemetryErrors, RIGHT);
   y += FH;
+  lcdDrawTextAlignedLeft(y, "Tlm RX Ovf");
+  lcdDrawNumber(MENU_DEBUG_COL1_OFS, y, telemetryFifo.getOverflows(), RIGHT);
+  y += FH;
 
 #if defined(BLUETOOTH)
   lcdDrawTextAlignedLeft(y, "BT status");
@@ -313,6 +322,22 @@ void menuStatisticsDebug2(event_t event)
   y += FH;
 #endif
 
+#if defined(LUA)
+  // reset with the statistics of the first debug page
+  lcdDrawTextAlignedLeft(y, "Lua GC");
+  lcdDrawNumber(MENU_DEBUG_COL1_OFS, y, maxLuaGcDuration / 10, PREC2|LEFT);
+  lcdDrawText(lcdLastRightPos, y, "ms");
+  y += FH;
+
+  // the longest run of a script, and which one
+  lcdDrawTextAlignedLeft(y, "Lua max");
+  lcdDrawNumber(MENU_DEBUG_COL1_OFS, y, luaGetMaxScriptDuration() / 10, PREC2|LEFT);
+  lcdDrawText(lcdLastRightPos, y, "ms");
+  y += FH;
+  lcdDrawText(MENU_DEBUG_COL1_OFS, y, luaGetMaxScriptName());
+  y += FH;
+#endif
+
   lcdDrawText(LCD_W/2, 7*FH+1, STR_MENUTORESET, CENTERED);
   lcdInvertLastLine();
 }
@@ -63,6 +63,7 @@ void runPopupCurvePreset(event_t event)
     if (crv.type == CURVE_TYPE_CUSTOM) {
       resetCustomCurveX(points, 5+crv.points);
     }
+    storageDirty(EE_MODEL);
   }
 }
 
@@ -77,6 +78,7 @@ void onCurveOneMenu(const char * result)
     int8_t * points = curveAddress(s_currIdxSubMenu);
     for (int i=0; i<5+crv.points; i++)
       points[i] = -points[i];
+    storageDirty(EE_MODEL);
   }
   else if (result == STR_CLEAR) {
     CurveInfo & crv = g_model.curves[s_currIdxSubMenu];
@@ -86,6 +88,7 @@ void onCurveOneMenu(const char * result)
     if (crv.type == CURVE_TYPE_CUSTOM) {
       resetCustomCurveX(points, 5+crv.points);
     }
+    storageDirty(EE_MODEL);
   }
 }
 
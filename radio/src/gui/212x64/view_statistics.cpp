@@ -127,8 +127,10 @@ void menuStatisticsDebug(event_t event)
 #if defined(LUA)
       maxLuaInterval = 0;
       maxLuaDuration = 0;
+      luaResetUsage();
 #endif
       maxMixerDuration  = 0;
+      resetMixerSchedulerStats();
       break;
 
     case EVT_KEY_FIRST(KEY_UP):
@@ -193,6 +195,9 @@ void menuStatisticsDebug(event_t event)
   lcdDrawTextAlignedLeft(y, STR_TMIXMAXMS);
   lcdDrawNumber(MENU_DEBUG_COL1_OFS, y, DURATION_MS_PREC2(maxMixerDuration), PREC2|LEFT);
   lcdDrawText(lcdLastRightPos, y, "ms");
+  lcdDrawText(lcdLastRightPos+2, y+1, "[Late]", SMLSIZE);
+  lcdDrawNumber(lcdLastRightPos, y, getMixerSchedulerMaxLateness(), LEFT);
+  lcdDrawText(lcdLastRightPos, y, "ms");
   y += FH;
 
   lcdDrawTextAlignedLeft(y, STR_FREE_STACK);
@@ -245,12 +250,28 @@ void menuStatisticsDebug2(event_t event)
 
     case EVT_KEY_LONG(KEY_ENTER):
       telemetryErrors = 0;
+      telemetryFifo.resetStats();
       break;
   }
 
   // UART statistics
   lcdDrawTextAlignedLeft(MENU_DEBUG_ROW1, "Tlm RX Err");
   lcdDrawNumber(MENU_DEBUG_COL1_OFS, MENU_DEBUG_ROW1, telemetryErrors, RIGHT);
+  lcdDrawTextAlignedLeft(MENU_DEBUG_ROW2, "Tlm RX Ovf");
+  lcdDrawNumber(MENU_DEBUG_COL1_OFS, MENU_DEBUG_ROW2, telemetryFifo.getOverflows(), RIGHT);
+
+#if defined(LUA)
+  // reset with the statistics of the first debug page
+  lcdDrawTextAlignedLeft(MENU_DEBUG_ROW3, "Lua GC");
+  lcdDrawNumber(MENU_DEBUG_COL1_OFS, MENU_DEBUG_ROW3, maxLuaGcDuration / 10, PREC2|LEFT);
+  lcdDrawText(lcdLastRightPos, MENU_DEBUG_ROW3, "ms");
+
+  // the longest run of a script, and which one
+  lcdDrawTextAlignedLeft(MENU_DEBUG_ROW4, "Lua max");
+  lcdDrawNumber(MENU_DEBUG_COL1_OFS, MENU_DEBUG_ROW4, luaGetMaxScriptDuration() / 10, PREC2|LEFT);
+  lcdDrawText(lcdLastRightPos, MENU_DEBUG_ROW4, "ms");
+  lcdDrawText(lcdLastRightPos+2, MENU_DEBUG_ROW4, luaGetMaxScriptName());
+#endif
 
 
   lcdDrawText(LCD_W/2, 7*FH+1, STR_MENUTORESET, CENTERED);
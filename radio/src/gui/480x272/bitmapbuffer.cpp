@@ -21,10 +21,63 @@
 #include <math.h>
 #include "opentx.h"
 
+void DirtyRegion::add(coord_t left, coord_t top, coord_t right, coord_t bottom)
+{
+  while (true) {
+    uint8_t index = count;
+    for (uint8_t i=0; i<count; i++) {
+      const Rect & rect = rects[i];
+      if (left >= rect.left && right <= rect.right && top >= rect.top && bottom <= rect.bottom) {
+        // already covered
+        return;
+      }
+      if (left <= rect.right && right >= rect.left && top <= rect.bottom && bottom >= rect.top) {
+        // overlapping or touching
+        index = i;
+        break;
+      }
+    }
+
+    if (index == count) {
+      if (count < DIRTY_RECTS_MAX) {
+        rects[count++] = { left, top, right, bottom };
+        return;
+      }
+      uint32_t bestGrowth = UINT32_MAX;
+      for (uint8_t i=0; i<count; i++) {
+        const Rect & rect = rects[i];
+        uint32_t area = (max(right, rect.right) - min(left, rect.left)) * (max(bottom, rect.bottom) - min(top, rect.top));
+        uint32_t growth = area - (rect.right - rect.left) * (rect.bottom - rect.top);
+        if (growth < bestGrowth) {
+          bestGrowth = growth;
+          index = i;
+        }
+      }
+    }
+
+    // merge the rectangle found and try again, as the result may now touch another one
+    const Rect & rect = rects[index];
+    left = min(left, rect.left);
+    top = min(top, rect.top);
+    right = max(right, rect.right);
+    bottom = max(bottom, rect.bottom);
+    rects[index] = rects[--count];
+  }
+}
+
+uint32_t DirtyRegion::getArea() const
+{
+  uint32_t result = 0;
+  for (uint8_t i=0; i<count; i++) {
+    result += (rects[i].right - rects[i].left) * (rects[i].bottom - rects[i].top);
+  }
+  return result;
+}
+
 void BitmapBuffer::drawAlphaPixel(display_t * p, uint8_t opacity, uint16_t color)
 {
   if (opacity == OPACITY_MAX) {
-    drawPixel(p, color);
+    writePixel(p, color);
   }
   else if (opacity != 0) {
     uint8_t bgWeight = OPACITY_MAX - opacity;
@@ -33,7 +86,7 @@ void BitmapBuffer::drawAlphaPixel(display_t * p, uint8_t opacity, uint16_t color
     uint16_t r = (bgRed * bgWeight + red * opacity) / OPACITY_MAX;
     uint16_t g = (bgGreen * bgWeight + green * opacity) / OPACITY_MAX;
     uint16_t b = (bgBlue * bgWeight + blue * opacity) / OPACITY_MAX;
-    drawPixel(p, RGB_JOIN(r, g, b));
+    writePixel(p, RGB_JOIN(r, g, b));
   }
 }
 
@@ -42,6 +95,8 @@ void BitmapBuffer::drawHorizontalLine(coord_t x, coord_t y, coord_t w, uint8_t p
   if (y >= height) return;
   if (x+w > width) { w = width - x; }
 
+  markDirty(x, y, w, 1);
+
   display_t * p = getPixelPtr(x, y);
   display_t color = lcdColorTable[COLOR_IDX(att)];
   uint8_t opacity = 0x0F - (att >> 24);
@@ -74,6 +129,8 @@ void BitmapBuffer::drawVerticalLine(coord_t x, coord_t y, coord_t h, uint8_t pat
   if (y<0) { h+=y; y=0; if (h<=0) return; }
   if (y+h > height) { h = height - y; }
 
+  markDirty(x, y, 1, h);
+
   display_t color = lcdColorTable[COLOR_IDX(att)];
   uint8_t opacity = 0x0F - (att >> 24);
 
@@ -125,12 +182,14 @@ void BitmapBuffer::invertRect(coord_t x, coord_t y, coord_t w, coord_t h, LcdFla
   display_t color = lcdColorTable[COLOR_IDX(att)];
   RGB_SPLIT(color, red, green, blue);
 
+  markDirty(x, y, w, h);
+
   for (int i=y; i<y+h; i++) {
     display_t * p = getPixelPtr(x, i);
     for (int j=0; j<w; j++) {
       // TODO ASSERT_IN_DISPLAY(p);
       RGB_SPLIT(*p, bgRed, bgGreen, bgBlue);
-      drawPixel(p, RGB_JOIN(0x1F + red - bgRed, 0x3F + green - bgGreen, 0x1F + blue - bgBlue));
+      writePixel(p, RGB_JOIN(0x1F + red - bgRed, 0x3F + green - bgGreen, 0x1F + blue - bgBlue));
       MOVE_TO_NEXT_RIGHT_PIXEL(p);
     }
   }
@@ -143,15 +202,17 @@ void BitmapBuffer::drawCircle(int x0, int y0, int radius)
   int y = 0;
   int decisionOver2 = 1 - x;
 
+  markDirty(x0-radius, y0-radius, 2*radius+1, 2*radius+1);
+
   while (y <= x) {
-    drawPixel(x+x0, y+y0, WHITE);
-    drawPixel(y+x0, x+y0, WHITE);
-    drawPixel(-x+x0, y+y0, WHITE);
-    drawPixel(-y+x0, x+y0, WHITE);
-    drawPixel(-x+x0, -y+y0, WHITE);
-    drawPixel(-y+x0, -x+y0, WHITE);
-    drawPixel(x+x0, -y+y0, WHITE);
-    drawPixel(y+x0, -x+y0, WHITE);
+    writePixel(x+x0, y+y0, WHITE);
+    writePixel(y+x0, x+y0, WHITE);
+    writePixel(-x+x0, y+y0, WHITE);
+    writePixel(-y+x0, x+y0, WHITE);
+    writePixel(-x+x0, -y+y0, WHITE);
+    writePixel(-y+x0, -x+y0, WHITE);
+    writePixel(x+x0, -y+y0, WHITE);
+    writePixel(y+x0, -x+y0, WHITE);
     y++;
     if (decisionOver2 <= 0) {
       decisionOver2 += 2*y + 1;
@@ -212,21 +273,23 @@ void BitmapBuffer::drawPie(int x0, int y0, int radius, int startAngle, int endAn
   if (!evalSlopes(slopes, startAngle, endAngle))
     return;
 
+  markDirty(x0-radius, y0-radius, 2*radius+1, 2*radius+1);
+
   for (int y=0; y<=radius; y++) {
     for (int x=0; x<=radius; x++) {
       if (x*x+y*y <= radius*radius) {
         int slope = (x==0 ? (y<0 ? -99000 : 99000) : y*100/x);
         if (slope >= slopes[0] && slope < slopes[1]) {
-          drawPixel(x0+x, y0-y, WHITE);
+          writePixel(x0+x, y0-y, WHITE);
         }
         if (-slope >= slopes[0] && -slope < slopes[1]) {
-          drawPixel(x0+x, y0+y, WHITE);
+          writePixel(x0+x, y0+y, WHITE);
         }
         if (slope >= slopes[2] && slope < slopes[3]) {
-          drawPixel(x0-x, y0-y, WHITE);
+          writePixel(x0-x, y0-y, WHITE);
         }
         if (-slope >= slopes[2] && -slope < slopes[3]) {
-          drawPixel(x0-x, y0+y, WHITE);
+          writePixel(x0-x, y0+y, WHITE);
         }
       }
     }
@@ -252,6 +315,8 @@ void BitmapBuffer::drawMask(coord_t x, coord_t y, BitmapBuffer * mask, LcdFlags
 
   display_t color = lcdColorTable[COLOR_IDX(flags)];
 
+  markDirty(x, y, width, height);
+
   for (coord_t row=0; row<height; row++) {
     display_t * p = getPixelPtr(x, y+row);
     display_t * q = mask->getPixelPtr(offset, row);
@@ -278,6 +343,11 @@ void BitmapBuffer::drawBitmapPattern(coord_t x, coord_t y, const uint8_t * bmp,
 
   display_t color = lcdColorTable[COLOR_IDX(flags)];
 
+  if (flags & VERTICAL)
+    markDirty(x, y-width+1, height, width);
+  else
+    markDirty(x, y, width, height);
+
   for (coord_t row=0; row<height; row++) {
     const uint8_t * q = bmp + 4 + row*w + offset;
     for (coord_t col=0; col<width; col++) {
@@ -438,6 +508,8 @@ void BitmapBuffer::drawBitmapPie(int x0, int y0, const uint16_t * img, int start
   int w2 = width/2;
   int h2 = height/2;
 
+  markDirty(x0, y0, width, height);
+
   for (int y=h2-1; y>=0; y--) {
     for (int x=w2-1; x>=0; x--) {
       int slope = (x==0 ? 99000 : y*100/x);
@@ -472,6 +544,8 @@ void BitmapBuffer::drawBitmapPatternPie(coord_t x0, coord_t y0, const uint8_t *
   int w2 = width/2;
   int h2 = height/2;
 
+  markDirty(x0, y0, width, height);
+
   for (int y=h2-1; y>=0; y--) {
     for (int x=w2-1; x>=0; x--) {
       int slope = (x==0 ? (y<0 ? -99000 : 99000) : y*100/x);
@@ -49,6 +49,52 @@ int getTextWidth(const char * s, int len=0, LcdFlags flags=0);
 #define LCD_COLS                     30
 #endif
 
+#define DIRTY_RECTS_MAX                8
+
+// The area of a buffer modified since the last clear(), kept as a few
+// bounding rectangles. Overlapping or touching rectangles are merged, and when
+// the list is full the rectangle which grows the least absorbs the new one.
+class DirtyRegion
+{
+  public:
+    struct Rect {
+      coord_t left, top, right, bottom;  // right and bottom excluded
+    };
+
+    DirtyRegion():
+      count(0)
+    {
+    }
+
+    inline void clear()
+    {
+      count = 0;
+    }
+
+    inline bool isEmpty() const
+    {
+      return count == 0;
+    }
+
+    inline uint8_t getCount() const
+    {
+      return count;
+    }
+
+    inline const Rect & getRect(uint8_t index) const
+    {
+      return rects[index];
+    }
+
+    void add(coord_t left, coord_t top, coord_t right, coord_t bottom);
+
+    uint32_t getArea() const;
+
+  protected:
+    Rect rects[DIRTY_RECTS_MAX];
+    uint8_t count;
+};
+
 enum BitmapFormats
 {
   BMP_RGB565,
@@ -143,6 +189,7 @@ class BitmapBuffer: public BitmapBufferBase<uint16_t>
 {
   private:
     bool dataAllocated;
+    DirtyRegion dirtyRegion;
 #if defined(DEBUG)
     bool leakReported;
 #endif
@@ -188,15 +235,10 @@ class BitmapBuffer: public BitmapBufferBase<uint16_t>
 
     inline void drawPixel(display_t * p, display_t value)
     {
-      if (data && (data <= p || p < data_end)) {
-        *p = value;
+      if (data && data <= p && p < data_end) {
+        markDirty(p);
       }
-#if defined(DEBUG)
-      else if (!leakReported) {
-        leakReported = true;
-        TRACE("BitmapBuffer(%p).drawPixel(): buffer overrun, data: %p, written at: %p", this, data, p);
-      }
-#endif
+      writePixel(p, value);
     }
 
     inline const display_t * getPixelPtr(coord_t x, coord_t y) const
@@ -219,8 +261,48 @@ class BitmapBuffer: public BitmapBufferBase<uint16_t>
 
     inline void drawPixel(coord_t x, coord_t y, display_t value)
     {
-      display_t * p = getPixelPtr(x, y);
-      drawPixel(p, value);
+      markDirty(x, y, 1, 1);
+      writePixel(x, y, value);
+    }
+
+    inline void markDirty(coord_t x, coord_t y, coord_t w, coord_t h)
+    {
+      coord_t right = x + w;
+      coord_t bottom = y + h;
+      if (x < 0) x = 0;
+      if (y < 0) y = 0;
+      if (right > width) right = width;
+      if (bottom > height) bottom = height;
+      if (x < right && y < bottom) {
+        dirtyRegion.add(x, y, right, bottom);
+      }
+    }
+
+    inline void markDirty(const display_t * p)
+    {
+      coord_t y = (p - data) / width;
+      coord_t x = (p - data) - y * width;
+#if defined(LCD_VERTICAL_INVERT)
+      x = width - x - 1;
+      y = height - y - 1;
+#endif
+      markDirty(x, y, 1, 1);
+    }
+
+    inline void invalidate()
+    {
+      dirtyRegion.clear();
+      dirtyRegion.add(0, 0, width, height);
+    }
+
+    inline const DirtyRegion & getDirtyRegion() const
+    {
+      return dirtyRegion;
+    }
+
+    inline void clearDirtyRegion()
+    {
+      dirtyRegion.clear();
     }
 
     void drawAlphaPixel(display_t * p, uint8_t opacity, uint16_t color);
@@ -252,6 +334,7 @@ class BitmapBuffer: public BitmapBufferBase<uint16_t>
       if (!data || h==0 || w==0) return;
       if (h<0) { y+=h; h=-h; }
       if (w<0) { x+=w; w=-w; }
+      markDirty(x, y, w, h);
       DMAFillRect(data, width, height, (x>0)?x:0, (y>0)?y:0, w, h, lcdColorTable[COLOR_IDX(flags)]);
     }
 
@@ -325,6 +408,7 @@ class BitmapBuffer: public BitmapBufferBase<uint16_t>
         if (y + h > height) {
           h = height - y;
         }
+        markDirty(x, y, w, h);
         if (bmp->getFormat() == BMP_ARGB4444) {
           DMACopyAlphaBitmap(data, width, height, x, y, bmp->getData(), srcw, srch, srcx, srcy, w, h);
         }
@@ -340,6 +424,7 @@ class BitmapBuffer: public BitmapBufferBase<uint16_t>
           scaledw = width - x;
         if (y + scaledh > height)
           scaledh = height - y;
+        markDirty(x, y, scaledw, scaledh);
 
         for (int i = 0; i < scaledh; i++) {
           display_t * p = getPixelPtr(x, y + i);
@@ -352,7 +437,7 @@ class BitmapBuffer: public BitmapBufferBase<uint16_t>
               drawAlphaPixel(p, a, RGB_JOIN(r<<1, g<<2, b<<1));
             }
             else {
-              drawPixel(p, *q);
+              writePixel(p, *q);
             }
             MOVE_TO_NEXT_RIGHT_PIXEL(p);
           }
@@ -373,6 +458,25 @@ class BitmapBuffer: public BitmapBufferBase<uint16_t>
     }
 
   protected:
+    // the callers mark the area they draw
+    inline void writePixel(display_t * p, display_t value)
+    {
+      if (data && (data <= p || p < data_end)) {
+        *p = value;
+      }
+#if defined(DEBUG)
+      else if (!leakReported) {
+        leakReported = true;
+        TRACE("BitmapBuffer(%p).drawPixel(): buffer overrun, data: %p, written at: %p", this, data, p);
+      }
+#endif
+    }
+
+    inline void writePixel(coord_t x, coord_t y, display_t value)
+    {
+      writePixel(getPixelPtr(x, y), value);
+    }
+
 #if !defined(BOOT)
     static BitmapBuffer * load_bmp(const char * filename);
     static BitmapBuffer * load_stb(const char * filename);
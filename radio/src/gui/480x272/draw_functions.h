@@ -75,6 +75,8 @@ void drawShutdownAnimation(uint32_t duration, uint32_t totalDuration, const char
 void drawTopBar();
 void drawMainPots();
 void drawTrims(uint8_t flightMode, bool sliderdisplayed = true);
+uint32_t getTopbarDepsHash();
+uint32_t getMainViewDecorationsHash(bool pots, bool trims);
 
 void drawReceiverName(coord_t x, coord_t y, uint8_t moduleIdx, uint8_t receiverIdx, LcdFlags flags);
 
@@ -70,3 +70,56 @@ void loadCustomScreens()
     topbar->load();
   }
 }
+
+void Layout::refresh()
+{
+  decorationsHash = getDecorationsHash();
+  topbarHash = hasTopbar() ? getTopbarDepsHash() : 0;
+
+  if (widgets) {
+    for (int i=0; i<MAX_LAYOUT_ZONES; i++) {
+      if (widgets[i]) {
+        widgets[i]->updateDrawnHash();
+      }
+    }
+  }
+
+  WidgetsContainer<MAX_LAYOUT_ZONES, MAX_LAYOUT_OPTIONS>::refresh();
+}
+
+bool Layout::refreshChanged()
+{
+  if (getDecorationsHash() != decorationsHash) {
+    refresh();
+    return true;
+  }
+
+  bool result = false;
+
+  if (hasTopbar()) {
+    uint32_t hash = getTopbarDepsHash();
+    if (hash == 0 || hash != topbarHash) {
+      topbarHash = hash;
+      theme->drawBackground(0, 0, LCD_W, MENU_HEADER_HEIGHT);
+      drawTopBar();
+      result = true;
+    }
+  }
+
+  if (widgets) {
+    for (int i=0; i<MAX_LAYOUT_ZONES; i++) {
+      if (widgets[i] && widgets[i]->updateDrawnHash()) {
+        drawZoneBackground(getZone(i));
+        widgets[i]->refresh();
+        result = true;
+      }
+    }
+  }
+
+  return result;
+}
+
+void Layout::drawZoneBackground(const Zone & zone) const
+{
+  theme->drawBackground(zone.x, zone.y, zone.w, zone.h);
+}
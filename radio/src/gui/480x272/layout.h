@@ -36,7 +36,9 @@ class Layout: public WidgetsContainer<MAX_LAYOUT_ZONES, MAX_LAYOUT_OPTIONS>
   public:
     Layout(const LayoutFactory * factory, PersistentData * persistentData):
       WidgetsContainer<MAX_LAYOUT_ZONES, MAX_LAYOUT_OPTIONS>(persistentData),
-      factory(factory)
+      factory(factory),
+      decorationsHash(0),
+      topbarHash(0)
     {
     }
 
@@ -49,8 +51,32 @@ class Layout: public WidgetsContainer<MAX_LAYOUT_ZONES, MAX_LAYOUT_OPTIONS>
     {
     }
 
+    void refresh() override;
+
+    // Redraws only the topbar and the widgets which changed since the last
+    // refresh, over the frame currently displayed. Returns false if nothing
+    // had to be drawn
+    bool refreshChanged();
+
   protected:
     const LayoutFactory * factory;
+    uint32_t decorationsHash;
+    uint32_t topbarHash;
+
+    // all layouts have the topbar option first
+    virtual bool hasTopbar() const
+    {
+      return persistentData->options[0].boolValue;
+    }
+
+    // hash of what the layout draws besides the topbar and widgets (flight
+    // mode, sliders, trims), any change triggers a full refresh
+    virtual uint32_t getDecorationsHash() const
+    {
+      return 0;
+    }
+
+    virtual void drawZoneBackground(const Zone & zone) const;
 };
 
 void registerLayout(const LayoutFactory * factory);
@@ -66,6 +66,13 @@ class Layout1x1: public Layout
     }
 
     virtual void refresh();
+
+  protected:
+    virtual uint32_t getDecorationsHash() const
+    {
+      bool decorations = persistentData->options[1].boolValue;
+      return getMainViewDecorationsHash(decorations, decorations);
+    }
 };
 
 void Layout1x1::refresh()
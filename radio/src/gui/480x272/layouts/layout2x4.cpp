@@ -73,6 +73,25 @@ class Layout2x4: public Layout
     }
 
     virtual void refresh();
+
+  protected:
+    virtual uint32_t getDecorationsHash() const
+    {
+      return getMainViewDecorationsHash(persistentData->options[2].boolValue, persistentData->options[3].boolValue);
+    }
+
+    virtual void drawZoneBackground(const Zone & zone) const
+    {
+      // zones are inside the panels
+      uint8_t panel = (zone.x >= 250) ? 6 : 4;
+      if (persistentData->options[panel].boolValue) {
+        lcdSetColor(persistentData->options[panel+1].unsignedValue);
+        lcdDrawSolidFilledRect(zone.x, zone.y, zone.w, zone.h, CUSTOM_COLOR);
+      }
+      else {
+        Layout::drawZoneBackground(zone);
+      }
+    }
 };
 
 void Layout2x4::refresh()
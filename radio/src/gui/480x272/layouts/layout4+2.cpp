@@ -78,6 +78,12 @@ class Layout4P2: public Layout
     }
 
     virtual void refresh();
+
+  protected:
+    virtual uint32_t getDecorationsHash() const
+    {
+      return getMainViewDecorationsHash(HAS_SLIDERS(), HAS_TRIMS());
+    }
 };
 
 void Layout4P2::refresh()
@@ -441,6 +441,7 @@ void lcdDrawPoint(coord_t x, coord_t y, LcdFlags att)
   if (p < DISPLAY_END) {
 #endif
     *p = color;
+    lcd->markDirty(x, y, 1, 1);
   }
 }
 
@@ -318,6 +318,17 @@ class FlexiTheme: public Theme
         lcdDrawSolidFilledRect(0, 0, LCD_W, LCD_H, CUSTOM_COLOR);
       }
     }
+
+    virtual void drawBackground(coord_t x, coord_t y, coord_t w, coord_t h) const
+    {
+      if (backgroundBitmap) {
+        lcd->drawBitmap(x, y, backgroundBitmap, x, y, w, h);
+      }
+      else {
+        lcdSetColor(g_eeGeneral.themeData.options[0].unsignedValue);
+        lcdDrawSolidFilledRect(x, y, w, h, CUSTOM_COLOR);
+      }
+    }
     void drawTopbarBackground(uint8_t icon) const
     {
       if (topleftBitmap) {
@@ -149,3 +149,57 @@ void drawTopBar()
 #endif
 
 }
+
+// Everything drawTopBar() displays, 0 when unknown
+uint32_t getTopbarDepsHash()
+{
+  struct gtm t;
+  gettime(&t);
+
+  struct {
+    int8_t day;
+    int8_t month;
+    int32_t txTime;
+    uint8_t usb;
+    uint8_t rssiBars;
+    uint8_t antenna;
+    uint8_t volume;
+    uint8_t quiet;
+    uint8_t txBattBars;
+    uint8_t charging;
+  } deps;
+
+  memclear(&deps, sizeof(deps));
+  deps.day = t.tm_mday;
+  deps.month = t.tm_mon;
+  deps.txTime = getValue(MIXSRC_TX_TIME);
+  deps.usb = usbPlugged();
+  const uint8_t rssiBarsValue[] = {30, 40, 50, 60, 80};
+  for (unsigned int i = 0; i < DIM(rssiBarsValue); i++) {
+    if (TELEMETRY_RSSI() >= rssiBarsValue[i]) {
+      deps.rssiBars++;
+    }
+  }
+#if defined(INTERNAL_MODULE_PXX1) && defined(EXTERNAL_ANTENNA)
+  deps.antenna = isModuleXJT(INTERNAL_MODULE) && isExternalAntennaEnabled();
+#endif
+  deps.volume = requiredSpeakerVolume;
+  deps.quiet = (g_eeGeneral.beepMode == e_mode_quiet);
+  deps.txBattBars = GET_TXBATT_BARS(5);
+#if defined(USB_CHARGER)
+  deps.charging = usbChargerLed();
+#endif
+
+  uint32_t result = hash(&deps, sizeof(deps));
+  for (unsigned int i = 0; i < MAX_TOPBAR_ZONES; i++) {
+    Widget * widget = topbar->getWidget(i);
+    if (widget) {
+      uint32_t widgetHash = widget->getDepsHash();
+      if (widgetHash == 0) {
+        return 0;
+      }
+      result = hash(&widgetHash, sizeof(widgetHash), result);
+    }
+  }
+  return result;
+}
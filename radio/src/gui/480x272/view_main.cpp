@@ -91,6 +91,34 @@ void drawTrims(uint8_t flightMode, bool sliderdisplayed)
   }
 }
 
+uint32_t getMainViewDecorationsHash(bool pots, bool trims)
+{
+  uint32_t result = hash(&mixerCurrentFlightMode, sizeof(mixerCurrentFlightMode));
+
+  if (pots) {
+    const int16_t values[] = {
+      calibratedAnalogs[CALIBRATED_POT1],
+      calibratedAnalogs[CALIBRATED_POT2],
+      calibratedAnalogs[CALIBRATED_POT3],
+      calibratedAnalogs[CALIBRATED_SLIDER_REAR_LEFT],
+      calibratedAnalogs[CALIBRATED_SLIDER_REAR_RIGHT],
+      int16_t(potsPos[1] & 0x0f)
+    };
+    result = hash(values, sizeof(values), result);
+  }
+
+  if (trims) {
+    int32_t values[NUM_STICKS+1];
+    for (uint8_t i=0; i<NUM_STICKS; i++) {
+      values[i] = getTrimValue(mixerCurrentFlightMode, i);
+    }
+    values[NUM_STICKS] = (trimsDisplayTimer > 0 ? trimsDisplayMask : 0);
+    result = hash(values, sizeof(values), result);
+  }
+
+  return result;
+}
+
 void onMainViewMenu(const char *result)
 {
   if (result == STR_MODEL_SELECT) {
@@ -146,6 +174,40 @@ int getMainViewsCount()
   return MAX_CUSTOM_SCREENS;
 }
 
+#define MAIN_VIEW_FULL_REFRESH_PERIOD  100 // 1s
+
+// The whole screen is redrawn after an event, when another screen was
+// displayed in between, and periodically in case something not covered by
+// the widgets hashes changed. Otherwise the frame displayed is copied back
+// into the LCD buffer (only the parts modified since) and only the widgets
+// which changed are redrawn over it. Returns false if nothing changed.
+static bool refreshMainView(Layout * layout, event_t event)
+{
+  static Layout * lastLayout = nullptr;
+  static uint32_t lastRefreshCount = 0;
+  static tmr10ms_t lastFullRefresh = 0;
+
+  tmr10ms_t now = get_tmr10ms();
+
+  if (event || layout != lastLayout || lcdRefreshCount != lastRefreshCount ||
+      (mainRequestFlags & (1u << REQUEST_SCREENSHOT)) ||
+      (tmr10ms_t)(now - lastFullRefresh) >= MAIN_VIEW_FULL_REFRESH_PERIOD) {
+    layout->refresh();
+    lastLayout = layout;
+    lastFullRefresh = now;
+  }
+  else {
+    lcdSyncBackBuffer();
+    if (!layout->refreshChanged()) {
+      return false;
+    }
+  }
+
+  // the frame will be displayed by the next lcdRefresh()
+  lastRefreshCount = lcdRefreshCount + 1;
+  return true;
+}
+
 bool menuMainView(event_t event)
 {
   switch (event) {
@@ -214,10 +276,11 @@ bool menuMainView(event_t event)
     g_model.view = 0;
   }
 
+  bool refreshNeeded = false;
   for (uint8_t i=0; i<MAX_CUSTOM_SCREENS; i++) {
     if (customScreens[i]) {
       if (i == g_model.view)
-        customScreens[i]->refresh();
+        refreshNeeded = refreshMainView(customScreens[i], event);
       else
         customScreens[i]->background();
     }
@@ -231,7 +294,7 @@ bool menuMainView(event_t event)
   }
 #endif
 
-  return true;
+  return refreshNeeded;
 }
 
 #if 0
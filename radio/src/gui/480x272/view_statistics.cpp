@@ -102,9 +102,11 @@ bool menuStatsDebug(event_t event)
 
     case EVT_KEY_FIRST(KEY_ENTER):
       maxMixerDuration  = 0;
+      resetMixerSchedulerStats();
 #if defined(LUA)
       maxLuaInterval = 0;
       maxLuaDuration = 0;
+      luaResetUsage();
 #endif
       break;
   }
@@ -130,6 +132,14 @@ bool menuStatsDebug(event_t event)
   lcdDrawNumber(lcdNextPos+5, y, 10*maxLuaInterval, LEFT, 0, NULL, "ms");
   y += FH;
 
+  lcdDrawText(MENUS_MARGIN_LEFT, y, "Lua usage");
+  lcdDrawText(MENU_STATS_COLUMN1, y+1, "[GC]", HEADER_COLOR|SMLSIZE);
+  lcdDrawNumber(lcdNextPos+5, y, maxLuaGcDuration / 10, PREC2|LEFT, 0, NULL, "ms");
+  lcdDrawText(lcdNextPos+20, y+1, "[Script]", HEADER_COLOR|SMLSIZE);
+  lcdDrawNumber(lcdNextPos+5, y, luaGetMaxScriptDuration() / 10, PREC2|LEFT, 0, NULL, "ms");
+  lcdDrawText(lcdNextPos+5, y, luaGetMaxScriptName());
+  y += FH;
+
   // lcdDrawText(MENUS_MARGIN_LEFT, MENU_CONTENT_TOP+line*FH, "Lua memory");
   lcdDrawText(MENU_STATS_COLUMN1, y+1, "[S]", HEADER_COLOR|SMLSIZE);
   lcdDrawNumber(lcdNextPos+5, y, luaGetMemUsed(lsScripts), LEFT);
@@ -142,6 +152,8 @@ bool menuStatsDebug(event_t event)
 
   lcdDrawText(MENUS_MARGIN_LEFT, y, STR_TMIXMAXMS);
   lcdDrawNumber(MENU_STATS_COLUMN1, y, DURATION_MS_PREC2(maxMixerDuration), PREC2|LEFT, 0, NULL, "ms");
+  lcdDrawText(lcdNextPos+20, y+1, "[Late]", HEADER_COLOR|SMLSIZE);
+  lcdDrawNumber(lcdNextPos+5, y, getMixerSchedulerMaxLateness(), LEFT, 0, NULL, "ms");
   y += FH;
 
   lcdDrawText(MENUS_MARGIN_LEFT, y, STR_FREE_STACK);
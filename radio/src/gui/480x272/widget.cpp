@@ -51,3 +51,33 @@ Widget * loadWidget(const char * name, const Zone & zone, Widget::PersistentData
   }
   return NULL;
 }
+
+uint32_t getSourceDepsHash(mixsrc_t source, uint32_t seed)
+{
+  getvalue_t value = getValue(source);
+  uint32_t result = hash(&value, sizeof(value), seed);
+
+  if (source >= MIXSRC_FIRST_TELEM) {
+    uint8_t index = (source - MIXSRC_FIRST_TELEM) / 3;
+    TelemetryItem & telemetryItem = telemetryItems[index];
+    uint8_t state = (telemetryItem.isAvailable() ? 1 : 0) + (telemetryItem.isOld() ? 2 : 0);
+    result = hash(&state, sizeof(state), result);
+    uint8_t unit = g_model.telemetrySensors[index].unit;
+    if (unit == UNIT_GPS || unit == UNIT_DATETIME || unit == UNIT_TEXT) {
+      // not displayed from the value, the text overlaps the GPS and date fields
+      result = hash(telemetryItem.text, sizeof(telemetryItem.text), result);
+    }
+  }
+  else if ((source >= MIXSRC_FIRST_TIMER || source == MIXSRC_TX_TIME) && value < 0) {
+    // negative timers blink
+    uint8_t phase = BLINK_ON_PHASE ? 1 : 0;
+    result = hash(&phase, sizeof(phase), result);
+  }
+#if defined(INTERNAL_GPS)
+  else if (source == MIXSRC_TX_GPS) {
+    result = hash(&gpsData, sizeof(gpsData), result);
+  }
+#endif
+
+  return result;
+}
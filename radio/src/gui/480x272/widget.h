@@ -39,7 +39,8 @@ class Widget
     Widget(const WidgetFactory * factory, const Zone & zone, PersistentData * persistentData):
       factory(factory),
       zone(zone),
-      persistentData(persistentData)
+      persistentData(persistentData),
+      drawnHash(0)
     {
     }
 
@@ -74,10 +75,28 @@ class Widget
     {
     }
 
+    // Hash of everything the widget displays, so that the main view redraws
+    // only the widgets which changed. 0 when unknown: always redrawn
+    virtual uint32_t getDepsHash() const
+    {
+      return 0;
+    }
+
+    // to be called before drawing the widget, returns false if the widget
+    // would draw the same as last time
+    bool updateDrawnHash()
+    {
+      uint32_t hash = getDepsHash();
+      bool changed = (hash == 0 || hash != drawnHash);
+      drawnHash = hash;
+      return changed;
+    }
+
   protected:
     const WidgetFactory * factory;
     Zone zone;
     PersistentData * persistentData;
+    uint32_t drawnHash;
 };
 
 void registerWidget(const WidgetFactory * factory);
@@ -148,6 +167,8 @@ inline const ZoneOption * Widget::getOptions() const
 
 Widget * loadWidget(const char * name, const Zone & zone, Widget::PersistentData * persistentData);
 
+uint32_t getSourceDepsHash(mixsrc_t source, uint32_t seed);
+
 std::list<const WidgetFactory *> & getRegisteredWidgets();
 
 #endif // _WIDGET_H_
@@ -30,6 +30,12 @@ class GaugeWidget: public Widget
 
     void refresh() override;
 
+    uint32_t getDepsHash() const override
+    {
+      int32_t value = getValue(persistentData->options[0].unsignedValue);
+      return hash(&value, sizeof(value), hash(persistentData, sizeof(Widget::PersistentData)));
+    }
+
     static const ZoneOption options[];
 };
 
@@ -63,11 +63,17 @@ class ModelBitmapWidget: public Widget
       }
     }
 
-    void refresh() override
+    uint32_t getDepsHash() const override
     {
       uint32_t new_hash = hash(g_model.header.bitmap, sizeof(g_model.header.bitmap));
       new_hash ^= hash(g_model.header.name, sizeof(g_model.header.name));
       new_hash ^= hash(g_eeGeneral.themeName, sizeof(g_eeGeneral.themeName));
+      return new_hash;
+    }
+
+    void refresh() override
+    {
+      uint32_t new_hash = getDepsHash();
       if (new_hash != deps_hash) {
         deps_hash = new_hash;
         refreshBuffer();
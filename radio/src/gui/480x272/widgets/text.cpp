@@ -32,6 +32,11 @@ class TextWidget: public Widget
 
     void refresh() override;
 
+    uint32_t getDepsHash() const override
+    {
+      return hash(persistentData, sizeof(Widget::PersistentData));
+    }
+
     static const ZoneOption options[];
 };
 
@@ -30,6 +30,15 @@ class TimerWidget: public Widget
 
     void refresh() override;
 
+    uint32_t getDepsHash() const override
+    {
+      uint32_t index = persistentData->options[0].unsignedValue;
+      const TimerState & timerState = timersStates[index];
+      // the timer settings give the start, the name, ...
+      uint32_t result = hash(&g_model.timers[index], sizeof(TimerData), hash(persistentData, sizeof(Widget::PersistentData)));
+      return hash(&timerState.val, sizeof(timerState.val), result);
+    }
+
     static const ZoneOption options[];
 };
 
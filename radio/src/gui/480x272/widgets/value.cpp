@@ -30,6 +30,12 @@ class ValueWidget: public Widget
 
     void refresh() override;
 
+    uint32_t getDepsHash() const override
+    {
+      uint32_t result = hash(persistentData, sizeof(Widget::PersistentData));
+      return getSourceDepsHash(persistentData->options[0].unsignedValue, result);
+    }
+
     static const ZoneOption options[];
 };
 
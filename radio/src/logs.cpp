@@ -27,6 +27,105 @@ uint8_t logDelay;
 
 void writeHeader();
 
+enum LogsFieldType {
+  LOGS_FIELD_VALUE,     // 1 value with prec 0..2
+  LOGS_FIELD_TIME,      // 1 value, 10ms timer
+  LOGS_FIELD_RTC,       // 2 values, unix time and 1/100s, written as "Date,Time" columns
+  LOGS_FIELD_GPS,       // 2 values, latitude and longitude
+  LOGS_FIELD_DATETIME,  // 2 values, year and month << 22 | day << 17 | hour << 12 | min << 6 | sec
+  LOGS_FIELD_SWITCHES,  // 2 values, logical switches 32..63 and 0..31
+};
+
+#if defined(LOGS_BINARY)
+/*
+ * Binary log format (varints are unsigned LEB128):
+ *   file   := "OTLG" version:u8 block*
+ *   block  := schema | record
+ *   schema := 'S' { type:u8 prec:u8 label:char* '\0' }* 0xFF
+ *   record := 'R' changed:u8[(values+7)/8] { delta:varint }*
+ * A schema block is written each time the file is opened and resets all
+ * values to 0. A record only stores the zigzag encoded deltas of the values
+ * which changed since the previous record, in the order of the changed bits.
+ */
+#define LOGS_BINARY_VERSION      1
+#define LOGS_BLOCK_SCHEMA        'S'
+#define LOGS_BLOCK_RECORD        'R'
+#define LOGS_SCHEMA_END          0xFF
+#define LOGS_SECTOR_SIZE         512
+#define LOGS_BUFFER_SIZE         (4 * LOGS_SECTOR_SIZE)
+#define LOGS_MAX_VALUES          (2 + 2 * MAX_TELEMETRY_SENSORS + NUM_STICKS + NUM_POTS + NUM_SLIDERS + NUM_SWITCHES + 2 + 1)
+
+// records are buffered and written in whole sectors
+static uint8_t logsBuffer[LOGS_BUFFER_SIZE];
+static uint16_t logsBufferCount;
+static int32_t logsValues[LOGS_MAX_VALUES];
+static int32_t logsRecord[LOGS_MAX_VALUES];
+
+static bool logsFlush(bool all)
+{
+  UINT count = logsBufferCount;
+  if (!all) {
+    // end the write on a sector boundary, so that FatFs never has to read back a partial sector
+    FSIZE_t position = f_tell(&g_oLogFile);
+    FSIZE_t end = (position + count) & ~(FSIZE_t)(LOGS_SECTOR_SIZE - 1);
+    if (end <= position)
+      return true;
+    count = end - position;
+  }
+
+  if (count > 0) {
+    UINT written;
+    if (f_write(&g_oLogFile, logsBuffer, count, &written) != FR_OK || written != count) {
+      logsBufferCount = 0;
+      return false;
+    }
+    logsBufferCount -= count;
+    memmove(logsBuffer, logsBuffer + count, logsBufferCount);
+  }
+
+  return true;
+}
+
+static void logsAppendByte(uint8_t value)
+{
+  if (logsBufferCount >= LOGS_BUFFER_SIZE && (!logsFlush(false) || logsBufferCount >= LOGS_BUFFER_SIZE)) {
+    logsFlush(true);
+  }
+  logsBuffer[logsBufferCount++] = value;
+}
+
+static void logsAppendVarint(uint32_t value)
+{
+  while (value >= 0x80) {
+    logsAppendByte((value & 0x7F) | 0x80);
+    value >>= 7;
+  }
+  logsAppendByte(value);
+}
+
+static void logsAppendRecord(uint16_t count)
+{
+  logsAppendByte(LOGS_BLOCK_RECORD);
+
+  for (uint16_t i=0; i<count; i+=8) {
+    uint8_t changed = 0;
+    for (uint8_t j=0; j<8 && i+j<count; j++) {
+      if (logsRecord[i+j] != logsValues[i+j])
+        changed |= (1 << j);
+    }
+    logsAppendByte(changed);
+  }
+
+  for (uint16_t i=0; i<count; i++) {
+    if (logsRecord[i] != logsValues[i]) {
+      int32_t delta = (int32_t)((uint32_t)logsRecord[i] - (uint32_t)logsValues[i]);
+      logsAppendVarint(((uint32_t)delta << 1) ^ (uint32_t)(delta >> 31));
+      logsValues[i] = logsRecord[i];
+    }
+  }
+}
+#endif
+
 #if defined(PCBTARANIS) || defined(PCBHORUS)
   int getSwitchState(uint8_t swtch) {
     int value = getValue(MIXSRC_FIRST_SWITCH + swtch);
@@ -105,9 +204,21 @@ const char * logsOpen()
     return SDCARD_ERROR(result);
   }
 
+#if defined(LOGS_BINARY)
+  logsBufferCount = 0;
+  if (f_size(&g_oLogFile) == 0) {
+    const char magic[] = "OTLG";
+    for (uint8_t i=0; i<sizeof(magic)-1; i++) {
+      logsAppendByte(magic[i]);
+    }
+    logsAppendByte(LOGS_BINARY_VERSION);
+  }
+  writeHeader();
+#else
   if (f_size(&g_oLogFile) == 0) {
     writeHeader();
   }
+#endif
 
   return nullptr;
 }
@@ -117,6 +228,11 @@ tmr10ms_t lastLogTime = 0;
 void logsClose()
 {
   if (sdMounted()) {
+#if defined(LOGS_BINARY)
+    if (g_oLogFile.obj.fs) {
+      logsFlush(true);
+    }
+#endif
     if (f_close(&g_oLogFile) != FR_OK) {
       // close failed, forget file
       g_oLogFile.obj.fs = 0;
@@ -126,15 +242,36 @@ void logsClose()
 }
 
 
+void writeHeaderField(const char * label, uint8_t type, uint8_t prec=0, bool last=false)
+{
+#if defined(LOGS_BINARY)
+  logsAppendByte(type);
+  logsAppendByte(prec);
+  do {
+    logsAppendByte(*label);
+  } while (*label++);
+  if (last) {
+    logsAppendByte(LOGS_SCHEMA_END);
+  }
+#else
+  f_puts(label, &g_oLogFile);
+  f_putc(last ? '\n' : ',', &g_oLogFile);
+#endif
+}
+
 void writeHeader()
 {
+#if defined(LOGS_BINARY)
+  logsAppendByte(LOGS_BLOCK_SCHEMA);
+  memclear(logsValues, sizeof(logsValues));
+#endif
+
 #if defined(RTCLOCK)
-  f_puts("Date,Time,", &g_oLogFile);
+  writeHeaderField("Date,Time", LOGS_FIELD_RTC);
 #else
-  f_puts("Time,", &g_oLogFile);
+  writeHeaderField("Time", LOGS_FIELD_TIME);
 #endif
 
-
   char label[TELEM_LABEL_LEN+7];
   for (int i=0; i<MAX_TELEMETRY_SENSORS; i++) {
     if (isTelemetryFieldAvailable(i)) {
@@ -149,8 +286,12 @@ void writeHeader()
           strncat(label, STR_VTELEMUNIT+1+3*unit, 3);
           strcat(label, ")");
         }
-        strcat(label, ",");
-        f_puts(label, &g_oLogFile);
+        if (sensor.unit == UNIT_GPS)
+          writeHeaderField(label, LOGS_FIELD_GPS);
+        else if (sensor.unit == UNIT_DATETIME)
+          writeHeaderField(label, LOGS_FIELD_DATETIME);
+        else
+          writeHeaderField(label, LOGS_FIELD_VALUE, sensor.prec);
       }
     }
   }
@@ -158,30 +299,30 @@ void writeHeader()
 #if defined(PCBTARANIS) || defined(PCBHORUS)
   for (uint8_t i=1; i<NUM_STICKS+NUM_POTS+NUM_SLIDERS+1; i++) {
     const char * p = STR_VSRCRAW + i * STR_VSRCRAW[0] + 2;
-    for (uint8_t j=0; j<STR_VSRCRAW[0]-1; ++j) {
-      if (!*p) break;
-      f_putc(*p, &g_oLogFile);
-      ++p;
+    uint8_t j = 0;
+    for (; j<STR_VSRCRAW[0]-1 && p[j]; ++j) {
+      label[j] = p[j];
     }
-    f_putc(',', &g_oLogFile);
+    label[j] = '\0';
+    writeHeaderField(label, LOGS_FIELD_VALUE);
   }
 
   for (uint8_t i=0; i<NUM_SWITCHES; i++) {
     if (SWITCH_EXISTS(i)) {
       char s[LEN_SWITCH_NAME + 2];
-      char * temp;
-      temp = getSwitchName(s, SWSRC_FIRST_SWITCH + i * 3);
-      *temp++ = ',';
-      *temp = '\0';
-      f_puts(s, &g_oLogFile);
+      *getSwitchName(s, SWSRC_FIRST_SWITCH + i * 3) = '\0';
+      writeHeaderField(s, LOGS_FIELD_VALUE);
     }
   }
-  f_puts("LSW,", &g_oLogFile);
+  writeHeaderField("LSW", LOGS_FIELD_SWITCHES);
 #else
-  f_puts("Rud,Ele,Thr,Ail,P1,P2,P3,THR,RUD,ELE,3POS,AIL,GEA,TRN,", &g_oLogFile);
+  static const char * const fields[] = { "Rud", "Ele", "Thr", "Ail", "P1", "P2", "P3", "THR", "RUD", "ELE", "3POS", "AIL", "GEA", "TRN" };
+  for (uint8_t i=0; i<DIM(fields); i++) {
+    writeHeaderField(fields[i], LOGS_FIELD_VALUE);
+  }
 #endif
 
-  f_puts("TxBat(V)\n", &g_oLogFile);
+  writeHeaderField("TxBat(V)", LOGS_FIELD_VALUE, 1, true);
 }
 
 uint32_t getLogicalSwitchesStates(uint8_t first)
@@ -193,6 +334,69 @@ uint32_t getLogicalSwitchesStates(uint8_t first)
   return result;
 }
 
+#if defined(LOGS_BINARY)
+bool logsWriteRecord(tmr10ms_t tmr10ms)
+{
+  uint16_t count = 0;
+
+#if defined(RTCLOCK)
+  logsRecord[count++] = g_rtcTime;
+  logsRecord[count++] = g_ms100;
+#else
+  logsRecord[count++] = tmr10ms;
+#endif
+
+  for (int i=0; i<MAX_TELEMETRY_SENSORS; i++) {
+    if (isTelemetryFieldAvailable(i)) {
+      TelemetrySensor & sensor = g_model.telemetrySensors[i];
+      TelemetryItem & telemetryItem = telemetryItems[i];
+      if (sensor.logs) {
+        if (sensor.unit == UNIT_GPS) {
+          logsRecord[count++] = telemetryItem.gps.latitude;
+          logsRecord[count++] = telemetryItem.gps.longitude;
+        }
+        else if (sensor.unit == UNIT_DATETIME) {
+          logsRecord[count++] = telemetryItem.datetime.year;
+          logsRecord[count++] = (telemetryItem.datetime.month << 22) + (telemetryItem.datetime.day << 17) + (telemetryItem.datetime.hour << 12) +
+                                (telemetryItem.datetime.min << 6) + telemetryItem.datetime.sec;
+        }
+        else {
+          logsRecord[count++] = telemetryItem.value;
+        }
+      }
+    }
+  }
+
+  for (uint8_t i=0; i<NUM_STICKS+NUM_POTS+NUM_SLIDERS; i++) {
+    logsRecord[count++] = calibratedAnalogs[i];
+  }
+
+#if defined(PCBTARANIS) || defined(PCBHORUS)
+  for (uint8_t i=0; i<NUM_SWITCHES; i++) {
+    if (SWITCH_EXISTS(i)) {
+      logsRecord[count++] = getSwitchState(i);
+    }
+  }
+  logsRecord[count++] = getLogicalSwitchesStates(32);
+  logsRecord[count++] = getLogicalSwitchesStates(0);
+#else
+  logsRecord[count++] = GET_2POS_STATE(THR);
+  logsRecord[count++] = GET_2POS_STATE(RUD);
+  logsRecord[count++] = GET_2POS_STATE(ELE);
+  logsRecord[count++] = GET_3POS_STATE(ID);
+  logsRecord[count++] = GET_2POS_STATE(AIL);
+  logsRecord[count++] = GET_2POS_STATE(GEA);
+  logsRecord[count++] = GET_2POS_STATE(TRN);
+#endif
+
+  logsRecord[count++] = g_vbat100mV;
+
+  logsAppendRecord(count);
+
+  return logsFlush(false);
+}
+#endif
+
 void logsWrite()
 {
   static const char * error_displayed = nullptr;
@@ -217,6 +421,9 @@ void logsWrite()
         }
       }
 
+#if defined(LOGS_BINARY)
+      bool failed = !logsWriteRecord(tmr10ms);
+#else
 #if defined(RTCLOCK)
       {
         static struct gtm utm;
@@ -292,9 +499,10 @@ void logsWrite()
 #endif
 
       div_t qr = div(g_vbat100mV, 10);
-      int result = f_printf(&g_oLogFile, "%d.%d\n", abs(qr.quot), abs(qr.rem));
+      bool failed = f_printf(&g_oLogFile, "%d.%d\n", abs(qr.quot), abs(qr.rem)) < 0;
+#endif
 
-      if (result<0 && !error_displayed) {
+      if (failed && !error_displayed) {
         error_displayed = STR_SDCARD_ERROR;
         POPUP_WARNING(STR_SDCARD_ERROR);
         logsClose();
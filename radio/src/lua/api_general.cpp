@@ -300,9 +300,12 @@ void luaGetValueAndPush(lua_State* L, int src)
 */
 bool luaFindFieldByName(const char * name, LuaField & field, unsigned int flags)
 {
-  // TODO better search method (binary lookup)
-  for (unsigned int n=0; n<DIM(luaSingleFields); ++n) {
-    if (!strcmp(name, luaSingleFields[n].name)) {
+  // luaSingleFields is sorted by name (see luaexport.py)
+  int first = 0, last = DIM(luaSingleFields) - 1;
+  while (first <= last) {
+    int n = (first + last) / 2;
+    int cmp = strcmp(name, luaSingleFields[n].name);
+    if (cmp == 0) {
       field.id = luaSingleFields[n].id;
       if (flags & FIND_FIELD_DESC) {
         strncpy(field.desc, luaSingleFields[n].desc, sizeof(field.desc)-1);
@@ -313,11 +316,17 @@ bool luaFindFieldByName(const char * name, LuaField & field, unsigned int flags)
       }
       return true;
     }
+    else if (cmp < 0) {
+      last = n - 1;
+    }
+    else {
+      first = n + 1;
+    }
   }
 
-  // search in multiples
+  // search in multiples, their names all end with the index
   unsigned int len = strlen(name);
-  for (unsigned int n=0; n<DIM(luaMultipleFields); ++n) {
+  for (unsigned int n=0; len > 0 && isdigit(name[len-1]) && n<DIM(luaMultipleFields); ++n) {
     const char * fieldName = luaMultipleFields[n].name;
     unsigned int fieldLen = strlen(fieldName);
     if (!strncmp(name, fieldName, fieldLen)) {
@@ -350,29 +359,19 @@ bool luaFindFieldByName(const char * name, LuaField & field, unsigned int flags)
 
   // search in telemetry
   field.desc[0] = '\0';
-  for (int i=0; i<MAX_TELEMETRY_SENSORS; i++) {
-    if (isTelemetryFieldAvailable(i)) {
-      char sensorName[TELEM_LABEL_LEN+1];
-      int len = zchar2str(sensorName, g_model.telemetrySensors[i].label, TELEM_LABEL_LEN);
-      if (!strncmp(sensorName, name, len)) {
-        if (name[len] == '\0') {
-          field.id = MIXSRC_FIRST_TELEM + 3*i;
-          field.desc[0] = '\0';
-          return true;
-        }
-        else if (name[len] == '-' && name[len+1] == '\0') {
-          field.id = MIXSRC_FIRST_TELEM + 3*i + 1;
-          field.desc[0] = '\0';
-          return true;
-        }
-        else if (name[len] == '+' && name[len+1] == '\0') {
-          field.id = MIXSRC_FIRST_TELEM + 3*i + 2;
-          field.desc[0] = '\0';
-          return true;
-        }
-      }
+  int index = findTelemetryIndex(name, len);
+  if (len > 1 && (name[len-1] == '-' || name[len-1] == '+')) {
+    // the lowest sensor wins, as when the labels were compared one after the other
+    int minmax = findTelemetryIndex(name, len-1);
+    if (minmax >= 0 && (index < 0 || minmax < index)) {
+      field.id = MIXSRC_FIRST_TELEM + 3*minmax + (name[len-1] == '-' ? 1 : 2);
+      return true;
     }
   }
+  if (index >= 0) {
+    field.id = MIXSRC_FIRST_TELEM + 3*index;
+    return true;
+  }
 
   return false;  // not found
 }
@@ -1443,16 +1442,19 @@ then the loaded script (or "chunk") is returned as a function. Otherwise, return
   as part of the file name and the .lua/.luac will be appended to that.
 
 @param mode (string) (optional) Controls whether to force loading the text (.lua) or pre-compiled binary (.luac)
-  version of the script. By default OTx will load the newest version and compile a new binary if necessary (overwriting any
-  existing .luac version of the same script, and stripping some debug info like line numbers).
+  version of the script. By default OTx will load the compiled version of the script from the SCRIPTS/CACHE folder, and compile
+  the script there if this exact version of its source has not been compiled yet (stripping some debug info like line numbers).
+  Compiled scripts are named after the hash of their source, so a script is compiled again whenever its content changes,
+  whatever the dates of the files.
   You can use `mode` to control the loading behavior more specifically. Possible values are:
    * `b` only binary.
    * `t` only text.
    * `T` (default on simulator) prefer text but load binary if that is the only version available.
-   * `bt` (default on radio) either binary or text, whichever is newer (binary preferred when timestamps are equal).
-   * Add `x` to avoid automatic compilation of source file to .luac version.
+   * `bt` (default on radio) the compiled version of the text file from the cache, or the text file if it has not been
+       compiled yet. A .luac file is only loaded when there is no text version.
+   * Add `x` to avoid automatic compilation of source file to the cache.
        Eg: "tx", "bx", or "btx".
-   * Add `c` to force compilation of source file to .luac version (even if existing version is newer than source file).
+   * Add `c` to force compilation of source file to the cache (even if the cache already has this version of the source).
        Eg: "tc" or "btc" (forces "t", overrides "x").
    * Add `d` to keep extra debug info in the compiled binary.
        Eg: "td", "btd", or "tcd" (no effect with just "b" or with "x").
@@ -1511,16 +1513,25 @@ static int luaLoadScript(lua_State * L)
 /*luadoc
 @function getUsage()
 
-Get percent of already used Lua instructions in current script execution cycle.
+Get percent of already used Lua instructions in current script execution cycle,
+and the CPU time and memory used by the script.
 
 @retval usage (number) a value from 0 to 100 (percent)
 
-@status current Introduced in 2.2.1
+@retval multiple (available since 2.3.11) returns 3 values:
+ * (number) usage, a value from 0 to 100 (percent)
+ * (number) longest execution cycle of the script, in microseconds
+ * (number) bytes allocated by the previous execution cycle of the script
+
+@status current Introduced in 2.2.1, expanded in 2.3.11
 */
 static int luaGetUsage(lua_State * L)
 {
   lua_pushinteger(L, instructionsPercent);
-  return 1;
+  LuaScriptUsage * usage = luaGetRunningUsage();
+  lua_pushinteger(L, usage ? usage->duration : 0);
+  lua_pushinteger(L, usage ? usage->allocated : 0);
+  return 3;
 }
 
 /*luadoc
@@ -1622,16 +1633,12 @@ static int luaSerialWrite(lua_State * L)
   #endif
   #if defined(AUX_SERIAL)
   if (auxSerialMode == UART_MODE_LUA) {
-    size_t wr_len = len;
-    const char* p = str;
-    while(wr_len--) auxSerialPutc(*p++);
+    auxSerialPutBuffer((const uint8_t *)str, len);
   }
   #endif
 #if defined(AUX2_SERIAL)
   if (aux2SerialMode == UART_MODE_LUA) {
-    size_t wr_len = len;
-    const char* p = str;
-    while(wr_len--) aux2SerialPutc(*p++);
+    aux2SerialPutBuffer((const uint8_t *)str, len);
   }
 #endif
 #else
@@ -848,6 +848,8 @@ static int luaModelInsertMix(lua_State *L)
         mix->speedDown = luaL_checkinteger(L, -1);
       }
     }
+    // the source has been changed after insertMix()
+    storageDirty(EE_MODEL);
   }
 
   return 0;
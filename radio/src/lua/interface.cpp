@@ -36,14 +36,22 @@ extern "C" {
 #define MANUAL_SCRIPTS_MAX_INSTRUCTIONS    (20000/100)
 #define LUA_WARNING_INFO_LEN               64
 
+// GC time budget of each luaTask() call, in us, larger when no key has been pressed for a while
+#define LUA_GC_BUDGET                      500
+#define LUA_GC_IDLE_BUDGET                 2000
+#define LUA_GC_IDLE_DELAY                  2    // seconds
+#define LUA_GC_STEP_SIZE                   1    // KB, small steps to stay close to the budget
+
 lua_State *lsScripts = nullptr;
 uint8_t luaState = 0;
 uint8_t luaScriptsCount = 0;
 ScriptInternalData scriptInternalData[MAX_SCRIPTS];
 ScriptInputsOutputs scriptInputsOutputs[MAX_SCRIPTS];
 ScriptInternalData standaloneScript;
+static char standaloneScriptName[LUA_USAGE_NAME_LEN];
 uint16_t maxLuaInterval = 0;
 uint16_t maxLuaDuration = 0;
+uint32_t maxLuaGcDuration = 0;
 bool luaLcdAllowed;
 uint8_t instructionsPercent = 0;
 char lua_warning_info[LUA_WARNING_INFO_LEN+1];
@@ -80,11 +88,110 @@ void *tracer_alloc(void * ud, void * ptr, size_t osize, size_t nsize)
     // TRACE("Lua alloc %u (type %s)", nsize, osize < LUA_TOTALTAGS ? lua_typename(0, osize) : "unk");
     tracer->alloc += nsize;
   }
+#if defined(USE_BIN_ALLOCATOR)
+  return bin_l_alloc(ud, ptr, osize, nsize);
+#else
   return l_alloc(ud, ptr, osize, nsize);
+#endif
 }
 
 #endif // #if defined(LUA_ALLOCATOR_TRACER)
 
+// bytes allocated by both Lua states since startup (wraps), the scripts usage is computed from it
+static uint32_t luaAllocatedBytes = 0;
+static LuaScriptUsage * luaRunningUsage = nullptr;
+static const char * luaRunningName;
+static uint8_t luaRunningNameLen;
+static uint16_t luaRunningStart;
+static uint32_t luaRunningStartMs;
+static uint32_t luaRunningAllocated;
+// longest run of any script or widget since the statistics were reset, its name, and the number of resets
+static uint32_t luaMaxScriptDuration = 0;
+static char luaMaxScriptName[LUA_USAGE_NAME_LEN + 1];
+static uint8_t luaUsageGeneration = 0;
+
+void * luaAlloc(void * ud, void * ptr, size_t osize, size_t nsize)
+{
+  size_t size = (ptr ? osize : 0);
+  if (nsize > size) {
+    luaAllocatedBytes += nsize - size;
+  }
+#if defined(LUA_ALLOCATOR_TRACER)
+  return tracer_alloc(ud, ptr, osize, nsize);
+#elif defined(USE_BIN_ALLOCATOR)
+  return bin_l_alloc(ud, ptr, osize, nsize);
+#else
+  return l_alloc(ud, ptr, osize, nsize);
+#endif
+}
+
+// time elapsed in us, the 2MHz timer wraps after 32ms so longer runs are measured with the RTOS clock
+static uint32_t luaGetDuration(uint16_t start, uint32_t startMs)
+{
+  uint32_t ms = RTOS_GET_MS() - startMs;
+  if (ms >= 16) {
+    return ms * 1000;
+  }
+  return (uint16_t)(getTmr2MHz() - start) / 2;
+}
+
+void luaStartUsage(LuaScriptUsage & usage, const char * name, uint8_t len)
+{
+  luaRunningUsage = &usage;
+  luaRunningName = name;
+  luaRunningNameLen = len;
+  luaRunningAllocated = luaAllocatedBytes;
+  luaRunningStartMs = RTOS_GET_MS();
+  luaRunningStart = getTmr2MHz();
+}
+
+void luaStopUsage()
+{
+  if (luaRunningUsage) {
+    uint32_t duration = luaGetDuration(luaRunningStart, luaRunningStartMs);
+    if (luaRunningUsage->generation != luaUsageGeneration) {
+      // the statistics were reset since the last run
+      luaRunningUsage->generation = luaUsageGeneration;
+      luaRunningUsage->duration = 0;
+    }
+    if (duration > luaRunningUsage->duration) {
+      luaRunningUsage->duration = duration;
+    }
+    if (duration > luaMaxScriptDuration) {
+      luaMaxScriptDuration = duration;
+      uint8_t len = min<uint8_t>(luaRunningNameLen, LUA_USAGE_NAME_LEN);
+      strncpy(luaMaxScriptName, luaRunningName, len);
+      luaMaxScriptName[len] = '\0';
+    }
+    luaRunningUsage->allocated = luaAllocatedBytes - luaRunningAllocated;
+    luaRunningUsage = nullptr;
+  }
+}
+
+LuaScriptUsage * luaGetRunningUsage()
+{
+  return luaRunningUsage;
+}
+
+uint32_t luaGetMaxScriptDuration()
+{
+  return luaMaxScriptDuration;
+}
+
+const char * luaGetMaxScriptName()
+{
+  return luaMaxScriptName;
+}
+
+void luaResetUsage()
+{
+  maxLuaGcDuration = 0;
+  luaMaxScriptDuration = 0;
+  luaMaxScriptName[0] = '\0';
+  // the longest run of each script and widget is reset on its next run
+  luaUsageGeneration++;
+}
+
 /* custom panic handler */
 int custom_lua_atpanic(lua_State * L)
 {
@@ -270,6 +377,56 @@ void luaRegisterLibraries(lua_State * L)
 
 #define GC_REPORT_TRESHOLD    (2*1024)
 
+#if defined(DEBUG)
+static void luaReportGcUse(lua_State * L)
+{
+  if (L == lsScripts) {
+    static uint32_t lastgcSctipts = 0;
+    uint32_t gc = luaGetMemUsed(L);
+    if (gc > (lastgcSctipts + GC_REPORT_TRESHOLD) || (gc + GC_REPORT_TRESHOLD) < lastgcSctipts) {
+      lastgcSctipts = gc;
+      TRACE("GC Use Scripts: %u bytes", gc);
+    }
+  }
+#if defined(COLORLCD)
+  if (L == lsWidgets) {
+    static uint32_t lastgcWidgets = 0;
+    uint32_t gc = luaGetMemUsed(L);
+    if (gc > (lastgcWidgets + GC_REPORT_TRESHOLD) || (gc + GC_REPORT_TRESHOLD) < lastgcWidgets) {
+      lastgcWidgets = gc;
+      TRACE("GC Use Widgets: %u bytes + Extra %u", gc, luaExtraMemoryUsage);
+    }
+  }
+#endif
+}
+#else
+#define luaReportGcUse(L)
+#endif
+
+// incremental GC steps until the end of the cycle or until the budget (in us) is used, returns the time used
+static uint32_t luaDoGcSteps(lua_State * L, uint32_t budget)
+{
+  uint32_t t0Ms = RTOS_GET_MS();
+  uint16_t t0 = getTmr2MHz();
+  uint32_t duration = 0;
+  if (L) {
+    PROTECT_LUA() {
+      do {
+        bool cycleEnd = lua_gc(L, LUA_GCSTEP, LUA_GC_STEP_SIZE);
+        duration = luaGetDuration(t0, t0Ms);
+        if (cycleEnd) break;
+      } while (duration < budget);
+      luaReportGcUse(L);
+    }
+    else {
+      // we disable Lua for the rest of the session
+      if (L == lsScripts) luaDisable();
+    }
+    UNPROTECT_LUA();
+  }
+  return duration;
+}
+
 void luaDoGc(lua_State * L, bool full)
 {
   if (L) {
@@ -280,26 +437,7 @@ void luaDoGc(lua_State * L, bool full)
       else {
         lua_gc(L, LUA_GCSTEP, 10);
       }
-#if defined(DEBUG)
-      if (L == lsScripts) {
-        static uint32_t lastgcSctipts = 0;
-        uint32_t gc = luaGetMemUsed(L);
-        if (gc > (lastgcSctipts + GC_REPORT_TRESHOLD) || (gc + GC_REPORT_TRESHOLD) < lastgcSctipts) {
-          lastgcSctipts = gc;
-          TRACE("GC Use Scripts: %u bytes", gc);
-        }
-      }
-#if defined(COLORLCD)
-      if (L == lsWidgets) {
-        static uint32_t lastgcWidgets = 0;
-        uint32_t gc = luaGetMemUsed(L);
-        if (gc > (lastgcWidgets + GC_REPORT_TRESHOLD) || (gc + GC_REPORT_TRESHOLD) < lastgcWidgets) {
-          lastgcWidgets = gc;
-          TRACE("GC Use Widgets: %u bytes + Extra %u", gc, luaExtraMemoryUsage);
-        }
-      }
-#endif
-#endif
+      luaReportGcUse(L);
     }
     else {
       // we disable Lua for the rest of the session
@@ -369,6 +507,154 @@ static void luaDumpState(lua_State * L, const char * filename, const FILINFO * f
   } else
     TRACE_ERROR("luaDumpState(%s): Error: Could not open output file.", filename);
 }
+
+/*
+  Compiled scripts cache: the bytecode of a script is saved in SCRIPTS_CACHE_PATH, named after the
+  hash of its source, so that a script is only compiled again when its content changes, whatever the
+  dates of the files (radios without RTC backup often have wrong ones, and FAT dates have a 2s
+  resolution): the source is hashed on each load. A small index keeps the hash of the last sources
+  seen, so that the compiled versions of a modified source can be removed.
+*/
+#define LUA_CACHE_INDEX_FILE      SCRIPTS_CACHE_PATH "/index.bin"
+#define LUA_CACHE_INDEX_MAGIC     0x4C434959
+#define LUA_CACHE_INDEX_ENTRIES   64    // power of 2
+#define LUA_CACHE_FILENAME_LEN    (sizeof(SCRIPTS_CACHE_PATH) + 10 + sizeof(SCRIPT_BIN_EXT))
+// the bytecode can only be loaded by the same Lua version with the same types sizes
+#define LUA_CACHE_ABI             ((LUA_VERSION_NUM << 16) + (sizeof(size_t) << 12) + (sizeof(Instruction) << 8) + (sizeof(lua_Number) << 4) + sizeof(int))
+
+struct LuaCacheIndexHeader {
+  uint32_t magic;
+  uint32_t abi;
+};
+
+struct LuaCacheIndexEntry {
+  uint32_t path;    // hash of the script path
+  uint32_t hash;    // hash of the script content
+};
+
+static bool luaCacheOpenIndex(FIL * file, BYTE mode)
+{
+  LuaCacheIndexHeader header;
+  UINT count;
+  if (f_open(file, LUA_CACHE_INDEX_FILE, mode) != FR_OK) {
+    return false;
+  }
+  if (f_read(file, &header, sizeof(header), &count) == FR_OK && count == sizeof(header) &&
+      header.magic == LUA_CACHE_INDEX_MAGIC && header.abi == LUA_CACHE_ABI &&
+      f_size(file) == sizeof(header) + LUA_CACHE_INDEX_ENTRIES * sizeof(LuaCacheIndexEntry)) {
+    return true;
+  }
+  f_close(file);
+  return false;
+}
+
+static bool luaCacheFindEntry(uint32_t path, LuaCacheIndexEntry & entry)
+{
+  FIL file;
+  UINT count;
+  bool result = false;
+  if (luaCacheOpenIndex(&file, FA_READ)) {
+    if (f_lseek(&file, sizeof(LuaCacheIndexHeader) + (path & (LUA_CACHE_INDEX_ENTRIES - 1)) * sizeof(entry)) == FR_OK &&
+        f_read(&file, &entry, sizeof(entry), &count) == FR_OK && count == sizeof(entry)) {
+      result = (entry.path == path);
+    }
+    f_close(&file);
+  }
+  return result;
+}
+
+// whether the compiled versions of a content are used by another script
+static bool luaCacheHashUsed(uint32_t hash, uint32_t path)
+{
+  FIL file;
+  UINT count;
+  LuaCacheIndexEntry entry;
+  bool result = false;
+  if (luaCacheOpenIndex(&file, FA_READ)) {
+    while (!result && f_read(&file, &entry, sizeof(entry), &count) == FR_OK && count == sizeof(entry)) {
+      result = (entry.hash == hash && entry.path != path);
+    }
+    f_close(&file);
+  }
+  return result;
+}
+
+static void luaCacheSaveEntry(const LuaCacheIndexEntry & entry)
+{
+  FIL file;
+  UINT count;
+  if (!luaCacheOpenIndex(&file, FA_READ | FA_WRITE)) {
+    // no index yet, or an index written by another firmware
+    if (sdCheckAndCreateDirectory(SCRIPTS_CACHE_PATH) || f_open(&file, LUA_CACHE_INDEX_FILE, FA_WRITE | FA_CREATE_ALWAYS) != FR_OK) {
+      return;
+    }
+    LuaCacheIndexHeader header = { LUA_CACHE_INDEX_MAGIC, LUA_CACHE_ABI };
+    LuaCacheIndexEntry empty;
+    memclear(&empty, sizeof(empty));
+    f_write(&file, &header, sizeof(header), &count);
+    for (int i=0; i<LUA_CACHE_INDEX_ENTRIES; i++) {
+      f_write(&file, &empty, sizeof(empty), &count);
+    }
+  }
+  if (f_lseek(&file, sizeof(LuaCacheIndexHeader) + (entry.path & (LUA_CACHE_INDEX_ENTRIES - 1)) * sizeof(entry)) == FR_OK) {
+    f_write(&file, &entry, sizeof(entry), &count);
+  }
+  f_close(&file);
+}
+
+static void luaCacheGetHashFilename(char * cacheFile, uint32_t hash, int stripDebug)
+{
+  sprintf(cacheFile, SCRIPTS_CACHE_PATH "/%08X%s" SCRIPT_BIN_EXT, (unsigned int)hash, stripDebug ? "" : "d");
+}
+
+/*
+  @fn luaCacheGetFilename(char * cacheFile, const char * filename, uint16_t fnamelen, int stripDebug)
+
+  Give the name of the compiled version of a script in the cache.
+
+  @param cacheFile Receives the cache file name, LUA_CACHE_FILENAME_LEN long.
+  @param filename Full path and name of the script source, with its extension.
+  @param fnamelen Length of the script path and name without the extension.
+  @param stripDebug Whether the debug info is removed from the bytecode.
+
+  @retval false if the script source could not be read.
+*/
+static bool luaCacheGetFilename(char * cacheFile, const char * filename, uint16_t fnamelen, int stripDebug)
+{
+  FIL file;
+  uint8_t buffer[128];
+  UINT count;
+  uint32_t abi = LUA_CACHE_ABI;
+  LuaCacheIndexEntry entry;
+  uint32_t path = hash(filename, fnamelen);
+  uint32_t contentHash = hash(&abi, sizeof(abi));
+
+  if (f_open(&file, filename, FA_READ) != FR_OK) {
+    return false;
+  }
+  while (f_read(&file, buffer, sizeof(buffer), &count) == FR_OK && count > 0) {
+    contentHash = hash(buffer, count, contentHash);
+  }
+  f_close(&file);
+
+  bool found = luaCacheFindEntry(path, entry);
+  if (!found || entry.hash != contentHash) {
+    uint32_t previousHash = (found ? entry.hash : 0);
+    entry.path = path;
+    entry.hash = contentHash;
+    luaCacheSaveEntry(entry);
+    if (found && !luaCacheHashUsed(previousHash, path)) {
+      // the script was modified, its previous compiled versions won't be used anymore
+      luaCacheGetHashFilename(cacheFile, previousHash, 1);
+      f_unlink(cacheFile);
+      luaCacheGetHashFilename(cacheFile, previousHash, 0);
+      f_unlink(cacheFile);
+    }
+  }
+
+  luaCacheGetHashFilename(cacheFile, contentHash, stripDebug);
+  return true;
+}
 #endif  // LUA_COMPILER
 
 /**
@@ -386,10 +672,11 @@ static void luaDumpState(lua_State * L, const char * filename, const FILINFO * f
     "b" only binary.
     "t" only text.
     "T" (default on simulator) prefer text but load binary if that is the only version available.
-    "bt" (default on radio) either binary or text, whichever is newer (binary preferred when timestamps are equal).
-    Add "x" to avoid automatic compilation of source file to .luac version.
+    "bt" (default on radio) the compiled version of the text file from the cache in SCRIPTS/CACHE, or the text file
+      when it has not been compiled yet. A .luac file is only loaded when there is no text version.
+    Add "x" to avoid automatic compilation of source file to the cache.
       Eg: "tx", "bx", or "btx".
-    Add "c" to force compilation of source file to .luac version (even if existing version is newer than source file).
+    Add "c" to force compilation of source file to the cache (even if the cache already has this version of the source).
       Eg: "tc" or "btc" (forces "t", overrides "x").
     Add "d" to keep extra debug info in the compiled binary.
       Eg: "td", "btd", or "tcd" (no effect with just "b" or with "x").
@@ -421,11 +708,13 @@ int luaLoadScriptFileToState(lua_State * L, const char * filename, const char *
   uint16_t fnamelen;
   uint8_t extlen;
   char filenameFull[LEN_FILE_PATH_MAX + _MAX_LFN + 1] = "\0";
+  char cacheFile[LUA_CACHE_FILENAME_LEN];
   FILINFO fnoLuaS, fnoLuaC;
   FRESULT frLuaS, frLuaC;
 
   bool scriptNeedsCompile = false;
-  uint8_t loadFileType = 0;  // 1=text, 2=binary
+  int stripDebug = (strchr(lmode, 'd') ? 0 : 1);
+  uint8_t loadFileType = 0;  // 1=text, 2=binary, 3=binary from the cache
 
   memset(&fnoLuaS, 0, sizeof(FILINFO));
   memset(&fnoLuaC, 0, sizeof(FILINFO));
@@ -440,61 +729,49 @@ int luaLoadScriptFileToState(lua_State * L, const char * filename, const char *
   }
   strncat(filenameFull, filename, fnamelen);
 
-  // check if binary version exists
-  strcpy(filenameFull + fnamelen, SCRIPT_BIN_EXT);
-  frLuaC = f_stat(filenameFull, &fnoLuaC);
-
   // check if text version exists
   strcpy(filenameFull + fnamelen, SCRIPT_EXT);
   frLuaS = f_stat(filenameFull, &fnoLuaS);
 
-  // decide which version to load, text or binary
-  if (frLuaC != FR_OK && frLuaS == FR_OK) {
-    // only text version exists
+  // decide which version to load
+  if (frLuaS == FR_OK && strchr(lmode, 'b') && strchr(lmode, 't') && !strchr(lmode, 'c')) {
+    // binary or text: the compiled version of this exact source, if it is in the cache
+    if (luaCacheGetFilename(cacheFile, filenameFull, fnamelen, stripDebug)) {
+      loadFileType = 3;
+    }
+  }
+  else if (frLuaS == FR_OK && strpbrk(lmode, "tTc")) {
     loadFileType = 1;
-    scriptNeedsCompile = true;
   }
-  else if (frLuaC == FR_OK && frLuaS != FR_OK) {
-    // only binary version exists
-    loadFileType = 2;
-  }
-  else if (frLuaS == FR_OK) {
-    // both versions exist, compare them
-    if (strchr(lmode, 'c') || (uint32_t)((fnoLuaC.fdate << 16) + fnoLuaC.ftime) < (uint32_t)((fnoLuaS.fdate << 16) + fnoLuaS.ftime)) {
-      // text version is newer than binary or forced by "c" mode flag, rebuild it
-      scriptNeedsCompile = true;
-    }
-    if (scriptNeedsCompile || !strchr(lmode, 'b')) {
-      // text version needs compilation or forced by mode
-      loadFileType = 1;
-    } else {
-      // use binary file
+  else {
+    // check if binary version exists
+    strcpy(filenameFull + fnamelen, SCRIPT_BIN_EXT);
+    frLuaC = f_stat(filenameFull, &fnoLuaC);
+    if (frLuaC == FR_OK && strpbrk(lmode, "bT")) {
       loadFileType = 2;
     }
   }
-  // else both versions are missing
 
-  // skip compilation based on mode flags? ("c" overrides "x")
-  if (scriptNeedsCompile && strchr(lmode, 'x') && !strchr(lmode, 'c')) {
-    scriptNeedsCompile = false;
+  if (!loadFileType) {
+    TRACE_ERROR("luaLoadScriptFileToState(%s, %s): Error loading script: file not found.\n", filename, lmode);
+    return SCRIPT_NOFILE;
   }
 
-  if (loadFileType == 2) {
-    // change file extension to binary version
-    strcpy(filenameFull + fnamelen, SCRIPT_BIN_EXT);
+  if (loadFileType == 3) {
+    TRACE("luaLoadScriptFileToState(%s, %s): loading %s", filename, lmode, cacheFile);
+    lstatus = luaL_loadfilex(L, cacheFile, nullptr);
+    if (lstatus == LUA_OK) {
+      return SCRIPT_OK;
+    }
+    // not compiled yet (or not readable), load the text version
+    lua_pop(L, 1);
+    loadFileType = 1;
+    scriptNeedsCompile = !strchr(lmode, 'x');
   }
-
-//  TRACE_DEBUG("luaLoadScriptFileToState(%s, %s):\n", filename, lmode);
-//  TRACE_DEBUG("\tldfile='%s'; ldtype=%u; compile=%u;\n", filenameFull, loadFileType, scriptNeedsCompile);
-//  TRACE_DEBUG("\t%-5s: %s; mtime: %04X%04X = %u/%02u/%02u %02u:%02u:%02u;\n", SCRIPT_EXT, (frLuaS == FR_OK ? "ok" : "nf"), fnoLuaS.fdate, fnoLuaS.ftime,
-//      (fnoLuaS.fdate >> 9) + 1980, (fnoLuaS.fdate >> 5) & 15, fnoLuaS.fdate & 31, fnoLuaS.ftime >> 11, (fnoLuaS.ftime >> 5) & 63, (fnoLuaS.ftime & 31) * 2);
-//  TRACE_DEBUG("\t%-5s: %s; mtime: %04X%04X = %u/%02u/%02u %02u:%02u:%02u;\n", SCRIPT_BIN_EXT, (frLuaC == FR_OK ? "ok" : "nf"), fnoLuaC.fdate, fnoLuaC.ftime,
-//      (fnoLuaC.fdate >> 9) + 1980, (fnoLuaC.fdate >> 5) & 15, fnoLuaC.fdate & 31, fnoLuaC.ftime >> 11, (fnoLuaC.ftime >> 5) & 63, (fnoLuaC.ftime & 31) * 2);
-
-  // final check that file exists and is allowed by mode flags
-  if (!loadFileType || (loadFileType == 1 && !strpbrk(lmode, "tTc")) || (loadFileType == 2 && !strpbrk(lmode, "bT"))) {
-    TRACE_ERROR("luaLoadScriptFileToState(%s, %s): Error loading script: file not found.\n", filename, lmode);
-    return SCRIPT_NOFILE;
+  else if (loadFileType == 1 && (!strchr(lmode, 'x') || strchr(lmode, 'c'))) {
+    // compile the text version, unless the cache already has it
+    scriptNeedsCompile = luaCacheGetFilename(cacheFile, filenameFull, fnamelen, stripDebug) &&
+                         (strchr(lmode, 'c') || f_stat(cacheFile, &fnoLuaC) != FR_OK);
   }
 
 #else  // !defined(LUA_COMPILER)
@@ -518,9 +795,8 @@ int luaLoadScriptFileToState(lua_State * L, const char * filename, const char *
     lstatus = luaL_loadfilex(L, filenameFull, nullptr);
   }
   if (lstatus == LUA_OK) {
-    if (scriptNeedsCompile && loadFileType == 1) {
-      strcpy(filenameFull + fnamelen, SCRIPT_BIN_EXT);
-      luaDumpState(L, filenameFull, &fnoLuaS, (strchr(lmode, 'd') ? 0 : 1));
+    if (scriptNeedsCompile && loadFileType == 1 && !sdCheckAndCreateDirectory(SCRIPTS_CACHE_PATH)) {
+      luaDumpState(L, cacheFile, nullptr, stripDebug);
     }
     ret = SCRIPT_OK;
   }
@@ -811,6 +1087,7 @@ void luaExec(const char * filename)
 
   if (luaState != INTERPRETER_PANIC) {
     standaloneScript.state = SCRIPT_NOFILE;
+    strncpy(standaloneScriptName, getBasename(filename), sizeof(standaloneScriptName));
     int result = luaLoad(lsScripts, filename, standaloneScript);
     // TODO the same with run ...
     if (result == SCRIPT_OK) {
@@ -831,7 +1108,10 @@ void luaDoOneRunStandalone(event_t evt)
     luaSetInstructionsLimit(lsScripts, MANUAL_SCRIPTS_MAX_INSTRUCTIONS);
     lua_rawgeti(lsScripts, LUA_REGISTRYINDEX, standaloneScript.run);
     lua_pushunsigned(lsScripts, evt);
-    if (lua_pcall(lsScripts, 1, 1, 0) == 0) {
+    luaStartUsage(standaloneScript.usage, standaloneScriptName, sizeof(standaloneScriptName));
+    int result = lua_pcall(lsScripts, 1, 1, 0);
+    luaStopUsage();
+    if (result == 0) {
       if (!lua_isnumber(lsScripts, -1)) {
         if (instructionsPercent > 100) {
           TRACE("Script killed");
@@ -911,9 +1191,8 @@ bool luaDoOneRunPermanentScript(event_t evt, int i, uint32_t scriptType)
 
   luaSetInstructionsLimit(lsScripts, PERMANENT_SCRIPTS_MAX_INSTRUCTIONS);
   int inputsCount = 0;
-#if defined(SIMU) || defined(DEBUG)
-  const char *filename;
-#endif
+  const char * filename;
+  uint8_t filenameLen;
   ScriptInputsOutputs * sio = nullptr;
 #if SCRIPT_MIX_FIRST > 0
   if ((scriptType & RUN_MIX_SCRIPT) && (sid.reference >= SCRIPT_MIX_FIRST && sid.reference <= SCRIPT_MIX_LAST)) {
@@ -923,9 +1202,8 @@ bool luaDoOneRunPermanentScript(event_t evt, int i, uint32_t scriptType)
     ScriptData & sd = g_model.scriptsData[sid.reference-SCRIPT_MIX_FIRST];
     sio = &scriptInputsOutputs[sid.reference-SCRIPT_MIX_FIRST];
     inputsCount = sio->inputsCount;
-#if defined(SIMU) || defined(DEBUG)
     filename = sd.file;
-#endif
+    filenameLen = sizeof(sd.file);
     lua_rawgeti(lsScripts, LUA_REGISTRYINDEX, sid.run);
     for (int j=0; j<sio->inputsCount; j++) {
       if (sio->inputs[j].type == INPUT_TYPE_SOURCE)
@@ -936,9 +1214,8 @@ bool luaDoOneRunPermanentScript(event_t evt, int i, uint32_t scriptType)
   }
   else if ((scriptType & RUN_FUNC_SCRIPT) && (sid.reference >= SCRIPT_FUNC_FIRST && sid.reference <= SCRIPT_GFUNC_LAST)) {
     CustomFunctionData & fn = (sid.reference < SCRIPT_GFUNC_FIRST ? g_model.customFn[sid.reference-SCRIPT_FUNC_FIRST] : g_eeGeneral.customFn[sid.reference-SCRIPT_GFUNC_FIRST]);
-#if defined(SIMU) || defined(DEBUG)
     filename = fn.play.name;
-#endif
+    filenameLen = sizeof(fn.play.name);
     if (getSwitch(fn.swtch))
       lua_rawgeti(lsScripts, LUA_REGISTRYINDEX, sid.run);
     else if (sid.background)
@@ -948,10 +1225,9 @@ bool luaDoOneRunPermanentScript(event_t evt, int i, uint32_t scriptType)
   }
   else {
 #if defined(PCBTARANIS)
-#if defined(SIMU) || defined(DEBUG)
     TelemetryScriptData & script = g_model.screens[sid.reference-SCRIPT_TELEMETRY_FIRST].script;
     filename = script.file;
-#endif
+    filenameLen = sizeof(script.file);
     if ((scriptType & RUN_TELEM_FG_SCRIPT) && (menuHandlers[0]==menuViewTelemetry && sid.reference==SCRIPT_TELEMETRY_FIRST+s_frsky_view)) {
       lua_rawgeti(lsScripts, LUA_REGISTRYINDEX, sid.run);
       lua_pushunsigned(lsScripts, evt);
@@ -968,7 +1244,10 @@ bool luaDoOneRunPermanentScript(event_t evt, int i, uint32_t scriptType)
 #endif
   }
 
-  if (lua_pcall(lsScripts, inputsCount, sio ? sio->outputsCount : 0, 0) == 0) {
+  luaStartUsage(sid.usage, filename, filenameLen);
+  int result = lua_pcall(lsScripts, inputsCount, sio ? sio->outputsCount : 0, 0);
+  luaStopUsage();
+  if (result == 0) {
     if (sio) {
       for (int j=sio->outputsCount-1; j>=0; j--) {
         if (!lua_isnumber(lsScripts, -1)) {
@@ -1042,13 +1321,18 @@ bool luaTask(event_t evt, uint8_t scriptType, bool allowLcdUsage)
         break;
       }
       UNPROTECT_LUA();
-      //todo gc step between scripts
     }
   }
-  luaDoGc(lsScripts, false);
+
+  // the garbage collector works harder when the user doesn't interact with the radio
+  uint32_t budget = (inactivity.counter >= LUA_GC_IDLE_DELAY ? LUA_GC_IDLE_BUDGET : LUA_GC_BUDGET);
+  uint32_t duration = luaDoGcSteps(lsScripts, budget);
 #if defined(COLORLCD)
-  luaDoGc(lsWidgets, false);
+  duration += luaDoGcSteps(lsWidgets, duration < budget ? budget - duration : 0);
 #endif
+  if (duration > maxLuaGcDuration) {
+    maxLuaGcDuration = duration;
+  }
   return scriptWasRun;
 }
 
@@ -1085,14 +1369,12 @@ void luaInit()
   luaClose(&lsScripts);
 
   if (luaState != INTERPRETER_PANIC) {
-#if defined(USE_BIN_ALLOCATOR)
-    lsScripts = lua_newstate(bin_l_alloc, nullptr);   //we use our own allocator!
-#elif defined(LUA_ALLOCATOR_TRACER)
+#if defined(LUA_ALLOCATOR_TRACER)
     memset(&lsScriptsTrace, 0 , sizeof(lsScriptsTrace));
     lsScriptsTrace.script = "lua_newstate(scripts)";
-    lsScripts = lua_newstate(tracer_alloc, &lsScriptsTrace);   //we use tracer allocator
+    lsScripts = lua_newstate(luaAlloc, &lsScriptsTrace);   //we use tracer allocator (on top of our own allocator if enabled)
 #else
-    lsScripts = lua_newstate(l_alloc, nullptr);   //we use Lua default allocator
+    lsScripts = lua_newstate(luaAlloc, nullptr);   //we use our own allocator if enabled, Lua default allocator otherwise
 #endif
     if (lsScripts) {
       // install our panic handler
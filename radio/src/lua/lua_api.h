@@ -37,7 +37,7 @@ extern "C" {
   #if !defined(LUA_COMPILER) || defined(SIMU) || defined(DEBUG)
     #define LUA_SCRIPT_LOAD_MODE    "T"   // prefer loading .lua source file for full debug info
   #else
-    #define LUA_SCRIPT_LOAD_MODE    "bt"  // binary or text, whichever is newer
+    #define LUA_SCRIPT_LOAD_MODE    "bt"  // compiled version from the cache, or text
   #endif
 #endif
 
@@ -109,12 +109,21 @@ enum ScriptReference {
   SCRIPT_TELEMETRY_FIRST,
   SCRIPT_TELEMETRY_LAST=SCRIPT_TELEMETRY_FIRST+MAX_SCRIPTS, // telem0 and telem1 .. telem7
 };
+// length of the script name kept with the longest run
+#define LUA_USAGE_NAME_LEN     10
+// CPU time and memory used by a script, for the statistics and getUsage()
+struct LuaScriptUsage {
+  uint32_t duration;    // longest run, in us
+  uint32_t allocated;   // bytes allocated by the last run
+  uint8_t generation;   // number of statistics resets when duration was updated
+};
 struct ScriptInternalData {
   uint8_t reference;
   uint8_t state;
   int run;
   int background;
   uint8_t instructions;
+  LuaScriptUsage usage;
 };
 struct ScriptInputsOutputs {
   uint8_t inputsCount;
@@ -135,6 +144,14 @@ bool luaTask(event_t evt, uint8_t scriptType, bool allowLcdUsage);
 void checkLuaMemoryUsage();
 void luaExec(const char * filename);
 void luaDoGc(lua_State * L, bool full);
+void * luaAlloc(void * ud, void * ptr, size_t osize, size_t nsize);
+// name is the file or widget name, it doesn't need to be null terminated
+void luaStartUsage(LuaScriptUsage & usage, const char * name, uint8_t len);
+void luaStopUsage();
+LuaScriptUsage * luaGetRunningUsage();
+uint32_t luaGetMaxScriptDuration();
+const char * luaGetMaxScriptName();
+void luaResetUsage();
 void luaError(lua_State * L, uint8_t error, bool acknowledge=true);
 uint32_t luaGetMemUsed(lua_State * L);
 void luaGetValueAndPush(lua_State * L, int src);
@@ -158,6 +175,7 @@ extern struct our_longjmp * global_lj;
 
 extern uint16_t maxLuaInterval;
 extern uint16_t maxLuaDuration;
+extern uint32_t maxLuaGcDuration;
 extern uint8_t instructionsPercent;
 
 #if defined(KEYS_GPIO_REG_PAGE)
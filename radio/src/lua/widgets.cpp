@@ -253,7 +253,8 @@ class LuaWidget: public Widget
     LuaWidget(const WidgetFactory * factory, const Zone & zone, Widget::PersistentData * persistentData, int widgetData):
       Widget(factory, zone, persistentData),
       widgetData(widgetData),
-      errorMessage(nullptr)
+      errorMessage(nullptr),
+      usage()
     {
     }
 
@@ -274,6 +275,7 @@ class LuaWidget: public Widget
   protected:
     int widgetData;
     char * errorMessage;
+    LuaScriptUsage usage;
 
     void setErrorMessage(const char * funcName);
 };
@@ -352,7 +354,10 @@ void LuaWidget::update()
     l_pushtableint(option->name, persistentData->options[i].signedValue);
   }
 
-  if (lua_pcall(lsWidgets, 2, 0, 0) != 0) {
+  luaStartUsage(usage, factory->getName(), strlen(factory->getName()));
+  int result = lua_pcall(lsWidgets, 2, 0, 0);
+  luaStopUsage();
+  if (result != 0) {
     setErrorMessage("update()");
   }
 }
@@ -387,7 +392,10 @@ void LuaWidget::refresh()
   LuaWidgetFactory * factory = (LuaWidgetFactory *)this->factory;
   lua_rawgeti(lsWidgets, LUA_REGISTRYINDEX, factory->refreshFunction);
   lua_rawgeti(lsWidgets, LUA_REGISTRYINDEX, widgetData);
-  if (lua_pcall(lsWidgets, 1, 0, 0) != 0) {
+  luaStartUsage(usage, factory->getName(), strlen(factory->getName()));
+  int result = lua_pcall(lsWidgets, 1, 0, 0);
+  luaStopUsage();
+  if (result != 0) {
     setErrorMessage("refresh()");
   }
 }
@@ -401,7 +409,10 @@ void LuaWidget::background()
   if (factory->backgroundFunction) {
     lua_rawgeti(lsWidgets, LUA_REGISTRYINDEX, factory->backgroundFunction);
     lua_rawgeti(lsWidgets, LUA_REGISTRYINDEX, widgetData);
-    if (lua_pcall(lsWidgets, 1, 0, 0) != 0) {
+    luaStartUsage(usage, factory->getName(), strlen(factory->getName()));
+    int result = lua_pcall(lsWidgets, 1, 0, 0);
+    luaStopUsage();
+    if (result != 0) {
       setErrorMessage("background()");
     }
   }
@@ -524,14 +535,12 @@ void luaInitThemesAndWidgets()
 {
   TRACE("luaInitThemesAndWidgets");
 
-#if defined(USE_BIN_ALLOCATOR)
-  lsWidgets = lua_newstate(bin_l_alloc, NULL);   //we use our own allocator!
-#elif defined(LUA_ALLOCATOR_TRACER)
+#if defined(LUA_ALLOCATOR_TRACER)
   memset(&lsWidgetsTrace, 0 , sizeof(lsWidgetsTrace));
   lsWidgetsTrace.script = "lua_newstate(widgets)";
-  lsWidgets = lua_newstate(tracer_alloc, &lsWidgetsTrace);   //we use tracer allocator
+  lsWidgets = lua_newstate(luaAlloc, &lsWidgetsTrace);   //we use tracer allocator (on top of our own allocator if enabled)
 #else
-  lsWidgets = lua_newstate(l_alloc, NULL);   //we use Lua default allocator
+  lsWidgets = lua_newstate(luaAlloc, NULL);   //we use our own allocator if enabled, Lua default allocator otherwise
 #endif
   if (lsWidgets) {
     // install our panic handler
@@ -62,6 +62,10 @@ void handleUsbConnection()
     else {
       if (getSelectedUsbMode() == USB_MASS_STORAGE_MODE) {
         opentxClose(false);
+#if defined(DISK_CACHE)
+        // the host accesses the card directly
+        diskCache.clear();
+#endif
         usbPluggedIn();
       }
       usbStart();
@@ -475,6 +479,9 @@ void perMain()
 
   checkSpeakerVolume();
 
+  // tangents of the curves edited during the previous loop
+  updateCurvesCache();
+
   if (!usbPlugged()) {
     checkEeprom();
     logsWrite();
@@ -513,6 +520,12 @@ void perMain()
   }
 #endif
 
+#if defined(DISK_CACHE)
+  if (sdMounted()) {
+    diskCache.wakeup(0);
+  }
+#endif
+
 #if !defined(EEPROM)
   // In case the SD card is removed during the session
   if (!usbPlugged() && !SD_CARD_PRESENT() && !globalData.unexpectedShutdown) {
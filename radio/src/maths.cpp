@@ -48,10 +48,10 @@ uint16_t isqrt32(uint32_t n)
 
 
 // djb2 hash algorithm
-uint32_t hash(const void * ptr, uint32_t size)
+uint32_t hash(const void * ptr, uint32_t size, uint32_t seed)
 {
   const uint8_t * data = (const uint8_t *)ptr;
-  uint32_t hash = 5381;
+  uint32_t hash = seed;
   for (uint32_t i=0; i<size; i++) {
     hash = ((hash << 5) + hash) + data[i]; /* hash * 33 + c */
   }
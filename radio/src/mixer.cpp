@@ -560,8 +560,245 @@ int getSourceTrimValue(int source, int stickValue=0)
   }
 }
 
+// The mixer plan holds the used mix lines in evaluation order, with their source decoded once.
+// Channels are ordered so that a channel used as a mix source is computed before the channels
+// reading it, which removes the need for extra mixer passes. The plan is rebuilt on the next
+// mixer run after the model has been edited (storageDirty) or loaded.
+enum MixPlanSource {
+  MIXPLAN_SOURCE_OTHER,
+  MIXPLAN_SOURCE_CHANNEL,
+  MIXPLAN_SOURCE_TRAINER,
+  MIXPLAN_SOURCE_LUA,
+};
+
+PACK(struct MixPlanLine {
+  uint16_t srcRaw:10;
+  uint16_t srcType:2;
+  uint16_t spare:4;
+  uint8_t  destCh;
+  uint8_t  index;       // index in g_model.mixData
+  uint8_t  srcParam;    // source channel or Lua script index
+});
+
+struct MixPlan {
+  uint8_t edits;        // incremented on each invalidation, from the UI task
+  uint8_t built;        // value of edits the plan was built for
+  uint8_t count;
+  uint8_t sorted;       // 0 when channels reference each other in a loop
+  MixPlanLine lines[MAX_MIXERS];
+};
+
+MixPlan mixPlan = { 1, 0 };
+
+void invalidateMixerPlan()
+{
+  mixPlan.edits++;
+}
+
+static void decodeMixPlanLine(MixPlanLine & line, uint8_t index)
+{
+  const MixData * md = mixAddress(index);
+  line.srcRaw = md->srcRaw;
+  line.destCh = md->destCh;
+  line.index = index;
+  line.srcType = MIXPLAN_SOURCE_OTHER;
+  line.srcParam = 0;
+
+  if (md->srcRaw >= MIXSRC_CH1 && md->srcRaw <= MIXSRC_LAST_CH) {
+    line.srcType = MIXPLAN_SOURCE_CHANNEL;
+    line.srcParam = md->srcRaw - MIXSRC_CH1;
+  }
+  else if (md->srcRaw >= MIXSRC_FIRST_TRAINER && md->srcRaw <= MIXSRC_LAST_TRAINER) {
+    line.srcType = MIXPLAN_SOURCE_TRAINER;
+  }
+#if defined(LUA_MODEL_SCRIPTS)
+  else if (md->srcRaw >= MIXSRC_FIRST_LUA && md->srcRaw <= MIXSRC_LAST_LUA) {
+    line.srcType = MIXPLAN_SOURCE_LUA;
+    line.srcParam = (md->srcRaw - MIXSRC_FIRST_LUA) / MAX_SCRIPT_OUTPUTS;
+  }
+#endif
+}
+
+// true when all the channels read by the lines of channel ch are already in the plan
+static bool isMixPlanChannelReady(uint8_t count, uint8_t ch, bitfield_channels_t used, bitfield_channels_t done)
+{
+  for (uint8_t i=0; i<count; i++) {
+    const MixData * md = mixAddress(i);
+    if (md->destCh == ch && md->srcRaw >= MIXSRC_CH1 && md->srcRaw <= MIXSRC_LAST_CH) {
+      uint8_t src = md->srcRaw - MIXSRC_CH1;
+      if (src != ch && (used & ~done & ((bitfield_channels_t)1 << src)))
+        return false;
+    }
+  }
+  return true;
+}
+
+static void buildMixerPlan()
+{
+  uint8_t count = 0;
+  bitfield_channels_t used = 0;
+
+  while (count < MAX_MIXERS && mixAddress(count)->srcRaw) {
+    used |= (bitfield_channels_t)1 << mixAddress(count)->destCh;
+    count++;
+  }
+
+  uint8_t n = 0;
+  bitfield_channels_t done = 0;
+  bool progress;
+  do {
+    progress = false;
+    for (uint8_t ch=0; ch<MAX_OUTPUT_CHANNELS; ch++) {
+      bitfield_channels_t mask = (bitfield_channels_t)1 << ch;
+      if ((used & mask) && !(done & mask) && isMixPlanChannelReady(count, ch, used, done)) {
+        for (uint8_t i=0; i<count; i++) {
+          if (mixAddress(i)->destCh == ch)
+            decodeMixPlanLine(mixPlan.lines[n++], i);
+        }
+        done |= mask;
+        progress = true;
+      }
+    }
+  } while (progress);
+
+  mixPlan.sorted = (done == used);
+  if (!mixPlan.sorted) {
+    // channels loop: keep the mix lines order, evalFlightModeMixes will need several passes
+    for (uint8_t i=0; i<count; i++) {
+      decodeMixPlanLine(mixPlan.lines[i], i);
+    }
+  }
+  mixPlan.count = count;
+}
+
+static void checkMixerPlan()
+{
+  // an edit made while the plan is built gets it built again on the next run
+  uint8_t edits = mixPlan.edits;
+  if (mixPlan.built != edits) {
+    buildMixerPlan();
+    mixPlan.built = edits;
+  }
+}
+
+// A mix line gives the same result in all the fading flight modes unless something
+// it reads depends on the flight mode: flight modes mask, logical switches, trims, GVars
+static bool isFlightModesMaskDependent(uint16_t lineFlightModes, uint16_t flightModes)
+{
+  lineFlightModes &= flightModes;
+  return lineFlightModes != 0 && lineFlightModes != flightModes;
+}
+
+static bool isFlightModeDependentSwitch(swsrc_t swtch)
+{
+  swtch = abs(swtch);
+  return (swtch >= SWSRC_FIRST_LOGICAL_SWITCH && swtch <= SWSRC_LAST_LOGICAL_SWITCH) ||
+         (swtch >= SWSRC_FIRST_FLIGHT_MODE && swtch <= SWSRC_LAST_FLIGHT_MODE);
+}
+
+static bool isFlightModeDependentSource(mixsrc_t source, uint32_t inputs, uint32_t trims, bool gvars)
+{
+  if (source >= MIXSRC_FIRST_INPUT && source <= MIXSRC_LAST_INPUT)
+    return inputs & ((uint32_t)1 << (source - MIXSRC_FIRST_INPUT));
+  if (source >= MIXSRC_FIRST_TRIM && source <= MIXSRC_LAST_TRIM)
+    return trims & ((uint32_t)1 << (source - MIXSRC_FIRST_TRIM));
+  if (source >= MIXSRC_FIRST_GVAR && source <= MIXSRC_LAST_GVAR)
+    return gvars;
+#if defined(HELI)
+  if (source >= MIXSRC_FIRST_HELI && source <= MIXSRC_CYC3)
+    return true;
+#endif
+  return source >= MIXSRC_FIRST_LOGICAL_SWITCH && source <= MIXSRC_LAST_LOGICAL_SWITCH;
+}
+
+static bool isGVarCurveRef(const CurveRef & curve)
+{
+  return (curve.type == CURVE_REF_DIFF || curve.type == CURVE_REF_EXPO) && GV_IS_GV_VALUE(curve.value, -100, 100);
+}
+
+// Returns the channels which have to be computed in each fading flight mode (those which
+// may differ between the flight modes, and the channels they read). The other channels
+// are only computed once, in the active flight mode. The mixer plan must be sorted.
+static bitfield_channels_t getFlightModesDependentChannels(uint16_t flightModes)
+{
+  uint8_t first = 0;
+  while (!(flightModes & (1 << first)))
+    first++;
+
+  uint32_t trims = 0;
+  for (uint8_t i=0; i<NUM_TRIMS; i++) {
+    int value = getTrimValue(first, i);
+    for (uint8_t p=first+1; p<MAX_FLIGHT_MODES; p++) {
+      if ((flightModes & (1 << p)) && getTrimValue(p, i) != value) {
+        trims |= (uint32_t)1 << i;
+        break;
+      }
+    }
+  }
+
+  bool gvars = false;
+#if defined(GVARS)
+  for (uint8_t gv=0; gv<MAX_GVARS && !gvars; gv++) {
+    int16_t value = GVAR_VALUE(gv, getGVarFlightMode(first, gv));
+    for (uint8_t p=first+1; p<MAX_FLIGHT_MODES; p++) {
+      if ((flightModes & (1 << p)) && GVAR_VALUE(gv, getGVarFlightMode(p, gv)) != value) {
+        gvars = true;
+        break;
+      }
+    }
+  }
+#endif
+
+  uint32_t inputs = 0;
+  for (uint8_t i=0; i<MAX_EXPOS; i++) {
+    ExpoData * ed = expoAddress(i);
+    if (!EXPO_VALID(ed))
+      break;
+    int8_t trim = -1;
+    if (ed->carryTrim < TRIM_ON)
+      trim = -ed->carryTrim - 1;
+    else if (ed->carryTrim == TRIM_ON && ed->srcRaw >= MIXSRC_Rud && ed->srcRaw <= MIXSRC_Ail)
+      trim = ed->srcRaw - MIXSRC_Rud;
+    if (isFlightModesMaskDependent(ed->flightModes, flightModes) ||
+        isFlightModeDependentSwitch(ed->swtch) ||
+        isFlightModeDependentSource(ed->srcRaw, inputs, trims, gvars) ||
+        (trim >= 0 && (trims & ((uint32_t)1 << trim))) ||
+        (gvars && (GV_IS_GV_VALUE(ed->weight, MIN_EXPO_WEIGHT, 100) || GV_IS_GV_VALUE(ed->offset, -100, 100) || isGVarCurveRef(ed->curve)))) {
+      inputs |= (uint32_t)1 << ed->chn;
+    }
+  }
+
+  bitfield_channels_t channels = 0;
+  for (uint8_t n=0; n<mixPlan.count; n++) {
+    const MixPlanLine & line = mixPlan.lines[n];
+    const MixData * md = mixAddress(line.index);
+    bool dependent;
+    if (line.srcType == MIXPLAN_SOURCE_CHANNEL)
+      dependent = (line.srcParam != md->destCh && (channels & ((bitfield_channels_t)1 << line.srcParam)));
+    else
+      dependent = isFlightModeDependentSource(md->srcRaw, inputs, trims, gvars);
+    if (dependent ||
+        isFlightModesMaskDependent(md->flightModes, flightModes) ||
+        isFlightModeDependentSwitch(md->swtch) ||
+        md->delayUp || md->delayDown ||
+        (md->carryTrim == 0 && md->srcRaw >= MIXSRC_Rud && md->srcRaw <= MIXSRC_Ail && (trims & ((uint32_t)1 << (md->srcRaw - MIXSRC_Rud)))) ||
+        (gvars && (GV_IS_GV_VALUE(MD_WEIGHT(md), GV_RANGELARGE_NEG, GV_RANGELARGE) || GV_IS_GV_VALUE(MD_OFFSET(md), GV_RANGELARGE_NEG, GV_RANGELARGE) || isGVarCurveRef(md->curve)))) {
+      channels |= (bitfield_channels_t)1 << md->destCh;
+    }
+  }
+
+  // the channels read by the dependent channels are needed as well
+  for (uint8_t n=mixPlan.count; n>0; n--) {
+    const MixPlanLine & line = mixPlan.lines[n-1];
+    if (line.srcType == MIXPLAN_SOURCE_CHANNEL && (channels & ((bitfield_channels_t)1 << line.destCh)))
+      channels |= (bitfield_channels_t)1 << line.srcParam;
+  }
+
+  return channels;
+}
+
 uint8_t mixerCurrentFlightMode;
-void evalFlightModeMixes(uint8_t mode, uint8_t tick10ms)
+void evalFlightModeMixes(uint8_t mode, uint8_t tick10ms, bitfield_channels_t channels)
 {
   evalInputs(mode);
 
@@ -639,12 +876,17 @@ void evalFlightModeMixes(uint8_t mode, uint8_t tick10ms)
 
   uint8_t pass = 0;
 
-  bitfield_channels_t dirtyChannels = (bitfield_channels_t)-1; // all dirty when mixer starts
+  bitfield_channels_t dirtyChannels = channels; // all dirty when mixer starts
+
+  checkMixerPlan();
 
   do {
     bitfield_channels_t passDirtyChannels = 0;
 
-    for (uint8_t i=0; i<MAX_MIXERS; i++) {
+    for (uint8_t n=0; n<mixPlan.count; n++) {
+      const MixPlanLine & line = mixPlan.lines[n];
+      uint8_t i = line.index;
+
 #if defined(BOLD_FONT)
       if (mode == e_perout_mode_normal && pass == 0)
         swOn[i].activeMix = 0;
@@ -652,11 +894,6 @@ void evalFlightModeMixes(uint8_t mode, uint8_t tick10ms)
 
       MixData * md = mixAddress(i);
 
-      if (md->srcRaw == 0)
-        break;
-
-      mixsrc_t stickIndex = md->srcRaw - MIXSRC_Rud;
-
       if (!(dirtyChannels & ((bitfield_channels_t)1 << md->destCh)))
         continue;
 
@@ -670,17 +907,14 @@ void evalFlightModeMixes(uint8_t mode, uint8_t tick10ms)
 
 #define MIXER_LINE_DISABLE()   (mixCondition = true, mixEnabled = 0)
 
-      if (mixEnabled && md->srcRaw >= MIXSRC_FIRST_TRAINER && md->srcRaw <= MIXSRC_LAST_TRAINER && !IS_TRAINER_INPUT_VALID()) {
+      if (mixEnabled && line.srcType == MIXPLAN_SOURCE_TRAINER && !IS_TRAINER_INPUT_VALID()) {
         MIXER_LINE_DISABLE();
       }
 
 #if defined(LUA_MODEL_SCRIPTS)
       // disable mixer if Lua script is used as source and script was killed
-      if (mixEnabled && md->srcRaw >= MIXSRC_FIRST_LUA && md->srcRaw <= MIXSRC_LAST_LUA) {
-        div_t qr = div(md->srcRaw-MIXSRC_FIRST_LUA, MAX_SCRIPT_OUTPUTS);
-        if (scriptInternalData[qr.quot].state != SCRIPT_OK) {
-          MIXER_LINE_DISABLE();
-        }
+      if (mixEnabled && line.srcType == MIXPLAN_SOURCE_LUA && scriptInternalData[line.srcParam].state != SCRIPT_OK) {
+        MIXER_LINE_DISABLE();
       }
 #endif
 
@@ -693,14 +927,19 @@ void evalFlightModeMixes(uint8_t mode, uint8_t tick10ms)
           continue;
       }
       else {
-        mixsrc_t srcRaw = MIXSRC_Rud + stickIndex;
-        v = getValue(srcRaw);
-        srcRaw -= MIXSRC_CH1;
-        if (srcRaw <= MIXSRC_LAST_CH-MIXSRC_CH1 && md->destCh != srcRaw) {
-          if (dirtyChannels & ((bitfield_channels_t)1 << srcRaw) & (passDirtyChannels|~(((bitfield_channels_t) 1 << md->destCh)-1)))
-            passDirtyChannels |= (bitfield_channels_t) 1 << md->destCh;
-          if (srcRaw < md->destCh || pass > 0)
+        v = getValue(md->srcRaw);
+        uint8_t srcRaw = line.srcParam;
+        if (line.srcType == MIXPLAN_SOURCE_CHANNEL && md->destCh != srcRaw) {
+          if (mixPlan.sorted) {
+            // the source channel has already been computed
             v = chans[srcRaw] >> 8;
+          }
+          else {
+            if (dirtyChannels & ((bitfield_channels_t)1 << srcRaw) & (passDirtyChannels|~(((bitfield_channels_t) 1 << md->destCh)-1)))
+              passDirtyChannels |= (bitfield_channels_t) 1 << md->destCh;
+            if (srcRaw < md->destCh || pass > 0)
+              v = chans[srcRaw] >> 8;
+          }
         }
         if (!mixCondition) {
           mixEnabled = v;
@@ -954,17 +1193,34 @@ void evalMixes(uint8_t tick10ms)
   }
 
   int32_t weight = 0;
+  bitfield_channels_t fadeChannels = (bitfield_channels_t)-1;
   if (flightModesFade) {
     memclear(sum_chans512, sizeof(sum_chans512));
+    // when the active flight mode is part of the fade, the channels which are the same
+    // in all the fading flight modes are only computed once, in the active flight mode
+    checkMixerPlan();
+    bool shared = mixPlan.sorted && (flightModesFade & (0x01 << fm));
+    if (shared) {
+      fadeChannels = getFlightModesDependentChannels(flightModesFade);
+    }
     for (uint8_t p=0; p<MAX_FLIGHT_MODES; p++) {
-      if (flightModesFade & (0x01 << p)) {
-        mixerCurrentFlightMode = p;
-        evalFlightModeMixes(p==fm ? e_perout_mode_normal : e_perout_mode_inactive_flight_mode, p==fm ? tick10ms : 0);
-        for (uint8_t i=0; i<MAX_OUTPUT_CHANNELS; i++)
-          sum_chans512[i] += limit<int32_t>(-0x6fff, chans[i] >> 4, 0x6fff) * fp_act[p];
+      if ((flightModesFade & (0x01 << p)) && !(shared && p == fm)) {
+        if (fadeChannels) {
+          mixerCurrentFlightMode = p;
+          evalFlightModeMixes(p==fm ? e_perout_mode_normal : e_perout_mode_inactive_flight_mode, p==fm ? tick10ms : 0, fadeChannels);
+          for (uint8_t i=0; i<MAX_OUTPUT_CHANNELS; i++)
+            sum_chans512[i] += limit<int32_t>(-0x6fff, chans[i] >> 4, 0x6fff) * fp_act[p];
+        }
         weight += fp_act[p];
       }
     }
+    if (shared) {
+      mixerCurrentFlightMode = fm;
+      evalFlightModeMixes(e_perout_mode_normal, tick10ms);
+      for (uint8_t i=0; i<MAX_OUTPUT_CHANNELS; i++)
+        sum_chans512[i] += limit<int32_t>(-0x6fff, chans[i] >> 4, 0x6fff) * fp_act[fm];
+      weight += fp_act[fm];
+    }
     assert(weight);
     mixerCurrentFlightMode = fm;
   }
@@ -993,7 +1249,7 @@ void evalMixes(uint8_t tick10ms)
     // at the end chans[i] = chans[i]/256 =>  -1024..1024
     // interpolate value with min/max so we get smooth motion from center to stop
     // this limits based on v original values and min=-1024, max=1024  RESX=1024
-    int32_t q = (flightModesFade ? (sum_chans512[i] / weight) << 4 : chans[i]);
+    int32_t q = ((flightModesFade && (fadeChannels & ((bitfield_channels_t)1 << i))) ? (sum_chans512[i] / weight) << 4 : chans[i]);
 
     ex_chans[i] = q / 256;
 
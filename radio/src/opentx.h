@@ -480,8 +480,24 @@ extern uint8_t flightModeTransitionLast;
 
 extern uint32_t nextMixerTime[NUM_MODULES];
 
-void evalFlightModeMixes(uint8_t mode, uint8_t tick10ms);
+// Mixer scheduling statistics, per module. Histogram bins are 0, 1, 2-3, 4-7, 8-15, 16+ RTOS ticks
+#define MIXER_SCHEDULER_HISTOGRAM_SIZE 6
+struct MixerSchedulerStats {
+  uint16_t lateness[MIXER_SCHEDULER_HISTOGRAM_SIZE]; // mixer run time - module deadline
+  uint16_t jitter[MIXER_SCHEDULER_HISTOGRAM_SIZE];   // |interval between 2 runs - module period|
+  uint16_t maxLateness;                              // ms
+  uint16_t period;                                   // ms
+  uint32_t lastRun;                                  // ms
+};
+
+extern MixerSchedulerStats mixerSchedulerStats[NUM_MODULES];
+extern uint16_t mixerDurationAverage; // step = 0.5us
+void resetMixerSchedulerStats();
+uint16_t getMixerSchedulerMaxLateness();
+
+void evalFlightModeMixes(uint8_t mode, uint8_t tick10ms, bitfield_channels_t channels=(bitfield_channels_t)-1);
 void evalMixes(uint8_t tick10ms);
+void invalidateMixerPlan();
 void doMixerCalculations();
 void scheduleNextMixerCalculation(uint8_t module, uint32_t period_ms);
 
@@ -641,7 +657,8 @@ void checkModelIdUnique(uint8_t index, uint8_t module);
 uint8_t findNextUnusedModelId(uint8_t index, uint8_t module);
 #endif
 
-uint32_t hash(const void * ptr, uint32_t size);
+// calls may be chained: hash(b, sizeb, hash(a, sizea)) is the hash of a followed by b
+uint32_t hash(const void * ptr, uint32_t size, uint32_t seed=5381);
 inline int divRoundClosest(const int n, const int d)
 {
   if (d == 0)
@@ -781,6 +798,8 @@ point_t getPoint(uint8_t i);
 typedef CurveData CurveInfo;
 void loadCurves();
 #define LOAD_MODEL_CURVES() loadCurves()
+void invalidateCurvesCache();
+void updateCurvesCache();
 int intpol(int x, uint8_t idx);
 int applyCurve(int x, CurveRef & curve);
 int applyCustomCurve(int x, uint8_t idx);
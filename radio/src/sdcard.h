@@ -49,6 +49,7 @@
 #define SCRIPTS_FUNCS_PATH  SCRIPTS_PATH "/FUNCTIONS"
 #define SCRIPTS_TELEM_PATH  SCRIPTS_PATH "/TELEMETRY"
 #define SCRIPTS_TOOLS_PATH  SCRIPTS_PATH "/TOOLS"
+#define SCRIPTS_CACHE_PATH  SCRIPTS_PATH "/CACHE"
 
 #define LEN_FILE_PATH_MAX   (sizeof(SCRIPTS_TELEM_PATH)+1)  // longest + "/"
 
@@ -59,7 +60,11 @@ const char RADIO_SETTINGS_PATH[] = RADIO_PATH "/radio.bin";
 #endif
 
 #define MODELS_EXT          ".bin"
+#if defined(LOGS_BINARY)
+#define LOGS_EXT            ".otl"
+#else
 #define LOGS_EXT            ".csv"
+#endif
 #define SOUNDS_EXT          ".wav"
 #define BMP_EXT             ".bmp"
 #define PNG_EXT             ".png"
@@ -34,6 +34,13 @@ void storageDirty(uint8_t msk)
   storageDirtyMsk |= msk;
   storageDirtyTime10ms = get_tmr10ms();
 
+  if (msk & EE_MODEL) {
+    // sensors, curves and mixes may have been edited
+    invalidateTelemetrySensorsIndex();
+    invalidateCurvesCache();
+    invalidateMixerPlan();
+  }
+
 #if defined(RTC_BACKUP_RAM)
   rambackupDirtyMsk = storageDirtyMsk;
   rambackupDirtyTime10ms = storageDirtyTime10ms;
@@ -117,6 +124,9 @@ void checkExternalAntenna()
 
 void postModelLoad(bool alarms)
 {
+  invalidateTelemetrySensorsIndex();
+  invalidateMixerPlan();
+
 #if defined(PXX2)
   if (is_memclear(g_model.modelRegistrationID, PXX2_LEN_REGISTRATION_ID)) {
     memcpy(g_model.modelRegistrationID, g_eeGeneral.ownerRegistrationID, PXX2_LEN_REGISTRATION_ID);
@@ -151,6 +151,25 @@ void auxSerialPutc(char c)
 #endif
 }
 
+void auxSerialPutBuffer(const uint8_t * data, uint32_t size)
+{
+#if !defined(SIMU)
+  int n = 0;
+  while (size > 0) {
+    uint32_t count = min<uint32_t>(size, auxSerialTxFifo.freeSpace());
+    if (count == 0) {
+      delay_ms(1);
+      if (++n > 100) return;
+      continue;
+    }
+    auxSerialTxFifo.pushMany(data, count);
+    USART_ITConfig(AUX_SERIAL_USART, USART_IT_TXE, ENABLE);
+    data += count;
+    size -= count;
+  }
+#endif
+}
+
 void auxSerialSbusInit()
 {
   auxSerialInit(UART_MODE_SBUS_TRAINER, 0);
@@ -351,6 +370,25 @@ void aux2SerialPutc(char c)
 #endif
 }
 
+void aux2SerialPutBuffer(const uint8_t * data, uint32_t size)
+{
+#if !defined(SIMU)
+  int n = 0;
+  while (size > 0) {
+    uint32_t count = min<uint32_t>(size, aux2SerialTxFifo.freeSpace());
+    if (count == 0) {
+      delay_ms(1);
+      if (++n > 100) return;
+      continue;
+    }
+    aux2SerialTxFifo.pushMany(data, count);
+    USART_ITConfig(AUX2_SERIAL_USART, USART_IT_TXE, ENABLE);
+    data += count;
+    size -= count;
+  }
+#endif
+}
+
 void aux2SerialSbusInit()
 {
   aux2SerialInit(UART_MODE_SBUS_TRAINER, 0);
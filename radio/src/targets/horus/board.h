@@ -527,6 +527,8 @@ void ledBlue();
 #define LCD_DEPTH                      16
 void lcdInit();
 void lcdRefresh();
+void lcdSyncBackBuffer();
+extern uint32_t lcdRefreshCount;
 void lcdCopy(void * dest, void * src);
 void DMAFillRect(uint16_t * dest, uint16_t destw, uint16_t desth, uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t color);
 void DMACopyBitmap(uint16_t * dest, uint16_t destw, uint16_t desth, uint16_t x, uint16_t y, const uint16_t * src, uint16_t srcw, uint16_t srch, uint16_t srcx, uint16_t srcy, uint16_t w, uint16_t h);
@@ -612,6 +614,8 @@ void telemetryPortSetDirectionOutput();
 void sportSendByte(uint8_t byte);
 void sportSendBuffer(const uint8_t * buffer, uint32_t count);
 bool telemetryGetByte(uint8_t * byte);
+const uint8_t * telemetryGetSpan(uint32_t & count);
+void telemetrySkipSpan(uint32_t count);
 void telemetryClearFifo();
 extern uint32_t telemetryErrors;
 
@@ -644,6 +648,7 @@ void sportUpdatePowerInit();
 extern uint8_t auxSerialMode;
 void auxSerialInit(unsigned int mode, unsigned int protocol);
 void auxSerialPutc(char c);
+void auxSerialPutBuffer(const uint8_t * data, uint32_t size);
 #define auxSerialTelemetryInit(protocol) auxSerialInit(UART_MODE_TELEMETRY, protocol)
 void auxSerialSbusInit();
 void auxSerialStop();
@@ -663,6 +668,7 @@ void auxSerialPowerOff();
 extern uint8_t aux2SerialMode;
 void aux2SerialInit(unsigned int mode, unsigned int protocol);
 void aux2SerialPutc(char c);
+void aux2SerialPutBuffer(const uint8_t * data, uint32_t size);
 #define aux2SerialTelemetryInit(protocol) aux2SerialInit(UART_MODE_TELEMETRY, protocol)
 void aux2SerialSbusInit();
 void aux2SerialStop();
@@ -294,6 +294,9 @@ DRESULT disk_ioctl (
       break;
 
     case CTRL_SYNC:
+#if defined(DISK_CACHE)
+      diskCache.flush(drv);
+#endif
       while (SD_GetStatus() == SD_TRANSFER_BUSY); /* Complete pending write process (needed at _FS_READONLY == 0) */
       res = RES_OK;
       break;
@@ -383,6 +386,10 @@ void sdDone()
     f_close(&g_bluetoothFile);
 #endif
 
+#if defined(DISK_CACHE)
+    diskCache.flush(0);
+#endif
+
     f_mount(nullptr, "", 0); // unmount SD
   }
 }
@@ -342,6 +342,13 @@ BitmapBuffer lcdBuffer1(BMP_RGB565, LCD_W, LCD_H, (uint16_t *)LCD_FIRST_FRAME_BU
 BitmapBuffer lcdBuffer2(BMP_RGB565, LCD_W, LCD_H, (uint16_t *)LCD_SECOND_FRAME_BUFFER);
 BitmapBuffer * lcd = &lcdBuffer1;
 
+uint32_t lcdRefreshCount = 0;
+
+// What the buffer we draw into misses compared to the displayed frame, it is
+// only known when the buffer was synced before being drawn
+static DirtyRegion lcdPendingDamage;
+static bool lcdBackBufferSynced = false;
+
 /**
   * @brief  Sets the LCD Layer.
   * @param  Layerx: specifies the Layer foreground or background.
@@ -394,6 +401,8 @@ void lcdInit(void)
   LCD_SetLayer(LCD_SECOND_LAYER);
   lcd->clear();
   LCD_SetTransparency(255);
+
+  lcdPendingDamage.add(0, 0, LCD_W, LCD_H);
 }
 
 void DMAFillRect(uint16_t * dest, uint16_t destw, uint16_t desth, uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t color)
@@ -597,15 +606,46 @@ void lcdStoreBackupBuffer()
 int lcdRestoreBackupBuffer()
 {
   DMAcopy(LCD_BACKUP_FRAME_BUFFER, lcd->getData(), DISPLAY_BUFFER_SIZE * sizeof(display_t));
+  lcd->invalidate();
   return 1;
 }
 
 void lcdRefresh()
 {
+  if (lcdBackBufferSynced) {
+    lcdPendingDamage = lcd->getDirtyRegion();
+  }
+  else {
+    lcdPendingDamage.clear();
+    lcdPendingDamage.add(0, 0, LCD_W, LCD_H);
+  }
+
   LCD_SetTransparency(255);
   if (CurrentLayer == LCD_FIRST_LAYER)
     LCD_SetLayer(LCD_SECOND_LAYER);
   else
     LCD_SetLayer(LCD_FIRST_LAYER);
   LCD_SetTransparency(0);
+
+  lcd->clearDirtyRegion();
+  lcdBackBufferSynced = false;
+  lcdRefreshCount++;
+}
+
+// Copies the areas modified by the last frames from the displayed buffer, so
+// that only what changed has to be drawn before the next lcdRefresh()
+void lcdSyncBackBuffer()
+{
+  if (lcdBackBufferSynced)
+    return;
+
+  const BitmapBuffer * front = (lcd == &lcdBuffer1 ? &lcdBuffer2 : &lcdBuffer1);
+  for (uint8_t i = 0; i < lcdPendingDamage.getCount(); i++) {
+    const DirtyRegion::Rect & rect = lcdPendingDamage.getRect(i);
+    DMACopyBitmap(lcd->getData(), LCD_W, LCD_H, rect.left, rect.top, front->getData(), LCD_W, LCD_H, rect.left, rect.top, rect.right - rect.left, rect.bottom - rect.top);
+  }
+
+  lcdPendingDamage.clear();
+  lcd->clearDirtyRegion();
+  lcdBackBufferSynced = true;
 }
@@ -417,6 +417,30 @@ bool telemetryGetByte(uint8_t * byte)
 #endif
 }
 
+const uint8_t * telemetryGetSpan(uint32_t & count)
+{
+#if defined(PCBX12S)
+  if (telemetryFifoMode & TELEMETRY_SERIAL_WITHOUT_DMA)
+    return telemetryNoDMAFifo.span(count);
+  else
+    return telemetryDMAFifo.span(count);
+#else
+  return telemetryNoDMAFifo.span(count);
+#endif
+}
+
+void telemetrySkipSpan(uint32_t count)
+{
+#if defined(PCBX12S)
+  if (telemetryFifoMode & TELEMETRY_SERIAL_WITHOUT_DMA)
+    telemetryNoDMAFifo.skip(count);
+  else
+    telemetryDMAFifo.skip(count);
+#else
+  telemetryNoDMAFifo.skip(count);
+#endif
+}
+
 void telemetryClearFifo()
 {
 #if defined(PCBX12S)
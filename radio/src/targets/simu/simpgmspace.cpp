@@ -74,8 +74,25 @@ void toplcdOff()
 {
 }
 
+// when enabled, the simulated time only moves with simuAdvanceVirtualTimer() (headless runner)
+static bool simuVirtualTimer = false;
+static uint64_t simuVirtualMicros = 0;
+
+void simuSetVirtualTimer(bool enabled)
+{
+  simuVirtualTimer = enabled;
+}
+
+void simuAdvanceVirtualTimer(uint32_t micros)
+{
+  simuVirtualMicros += micros;
+}
+
 uint64_t simuTimerMicros(void)
 {
+  if (simuVirtualTimer)
+    return simuVirtualMicros;
+
 #if SIMPGMSPC_USE_QT
   static QElapsedTimer ticker;
   if (!ticker.isValid())
@@ -410,6 +427,10 @@ void lcdOff()
 }
 #endif
 
+#if defined(COLORLCD)
+uint32_t lcdRefreshCount = 0;
+#endif
+
 void lcdRefresh()
 {
   static bool lightEnabled = (bool)isBacklightEnabled();
@@ -419,7 +440,20 @@ void lcdRefresh()
     lightEnabled = (bool)isBacklightEnabled();
     simuLcdRefresh = true;
   }
+
+#if defined(COLORLCD)
+  lcd->clearDirtyRegion();
+  lcdRefreshCount++;
+#endif
+}
+
+#if defined(COLORLCD)
+void lcdSyncBackBuffer()
+{
+  // there is only one buffer, it always contains the last frame
+  lcd->clearDirtyRegion();
 }
+#endif
 
 void telemetryPortInit(uint8_t baudrate)
 {
@@ -779,6 +813,10 @@ void auxSerialPutc(char c)
 {
 }
 
+void auxSerialPutBuffer(const uint8_t * data, uint32_t size)
+{
+}
+
 void auxSerialSbusInit()
 {
 }
@@ -799,6 +837,10 @@ void aux2SerialPutc(char c)
 {
 }
 
+void aux2SerialPutBuffer(const uint8_t * data, uint32_t size)
+{
+}
+
 void aux2SerialSbusInit()
 {
 }
@@ -245,6 +245,8 @@ extern char * main_thread_error;
 inline void getADC() { }
 
 uint64_t simuTimerMicros(void);
+void simuSetVirtualTimer(bool enabled);
+void simuAdvanceVirtualTimer(uint32_t micros);
 
 void simuInit();
 void StartSimu(bool tests=true, const char * sdPath = 0, const char * settingsPath = 0);
@@ -65,8 +65,6 @@ void eepromSimuWriteBlock(uint8_t * buffer, size_t address, size_t size)
 volatile uint8_t eepromTransferComplete = 1;
 void * eeprom_thread_function(void *)
 {
-  eeprom_thread_running = true;
-
   while (!sem_wait(eeprom_write_sem)) {
     if (!eeprom_thread_running)
       return nullptr;
@@ -157,6 +155,8 @@ void StartEepromThread(const char * filename)
   sem_init(eeprom_write_sem, 0, 0);
 #endif
 
+  // set before the thread starts, StopEepromThread() may be called before it runs
+  eeprom_thread_running = true;
   RTOS_CREATE_TASK(eeprom_thread_pid, eeprom_thread_function, "eeprom");
 }
 
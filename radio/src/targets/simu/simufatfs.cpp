@@ -327,7 +327,15 @@ FRESULT f_open (FIL * fil, const TCHAR *name, BYTE flag)
     fil->obj.objsize = tmp.st_size;
     fil->fptr = 0;
   }
-  fil->obj.fs = (FATFS*)fopen(realPath.c_str(), (flag & FA_WRITE) ? ((flag & FA_CREATE_ALWAYS) ? "wb+" : "ab+") : "rb+");
+  const char * mode = "rb+";
+  if (flag & FA_CREATE_ALWAYS) {
+    mode = "wb+";
+  }
+  else if ((flag & FA_WRITE) && (!(flag & FA_READ) || (flag & (FA_OPEN_ALWAYS | FA_OPEN_APPEND)))) {
+    mode = "ab+";
+  }
+  // else read only, or read and write of an existing file
+  fil->obj.fs = (FATFS*)fopen(realPath.c_str(), mode);
   fil->fptr = 0;
   if (fil->obj.fs) {
     TRACE_SIMPGMSPACE("f_open(%s, %x) = %p (FIL %p)", path.c_str(), flag, fil->obj.fs, fil);
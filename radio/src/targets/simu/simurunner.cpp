@@ -0,0 +1,416 @@
+/*
+ * Copyright (C) OpenTX
+ *
+ * Based on code named
+ *   th9x - http://code.google.com/p/th9x
+ *   er9x - http://code.google.com/p/er9x
+ *   gruvin9x - http://code.google.com/p/gruvin9x
+ *
+ * License GPLv2: http://www.gnu.org/licenses/gpl-2.0.html
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <vector>
+#include "opentx.h"
+#include "storage/conversions/conversions.h"
+
+/*
+ * Headless simulator runner: runs a model against a trace of inputs, on virtual
+ * time, as fast as the host allows, and records what the radio outputs.
+ * The firmware tasks are not started, the runner calls per10ms() and the mixer
+ * itself, once per 10ms step, so that two runs of the same model and trace
+ * always give the same output.
+ *
+ *   simu-runner [options] <trace>
+ *
+ * Options:
+ *   --radio=<file>      radio data: eeprom image (EEPROM radios), ignored on SD card radios
+ *   --sd=<dir>          SD card directory (on SD card radios the radio settings and models are read there)
+ *   --model=<model>     model to run: its index in the eeprom (from 0), or its file name on SD card radios
+ *                       (the current model of the radio settings by default)
+ *   --duration=<ms>     run length (by default until one second after the last trace event)
+ *   --out=<file>        output file (stdout by default, the firmware traces are then written to stderr)
+ *
+ * Trace, one event per line (time in ms, '#' starts a comment):
+ *   <time> stick|pot|slider <index> <position>   position in [-1024..1024]
+ *   <time> switch <index> <-1|0|1>
+ *   <time> trim <index> <0|1>                    trim button released / pressed
+ *   <time> sport <physicalId> <dataId> <value>   S.Port telemetry frame (dataId in hex),
+ *                                                send RSSI (F101) frames for the telemetry to be seen as streaming
+ *
+ * Output, one line for each change (all values are written at time 0):
+ *   <time>,ch,<index>,<value>                    channel output [-1024..1024]
+ *   <time>,ls,<index>,<0|1>                      logical switch
+ *   <time>,fm,0,<flight mode>
+ *   <time>,tone,<frequency>,<length>
+ *   <time>,play,0,<file>
+ */
+
+#define RUNNER_STEP_MS      10
+
+enum RunnerEventType {
+  RUNNER_EVENT_STICK,
+  RUNNER_EVENT_POT,
+  RUNNER_EVENT_SLIDER,
+  RUNNER_EVENT_SWITCH,
+  RUNNER_EVENT_TRIM,
+  RUNNER_EVENT_SPORT,
+};
+
+struct RunnerEvent {
+  uint32_t time;
+  uint8_t type;
+  uint8_t index;
+  uint16_t id;
+  int32_t value;
+};
+
+static FILE * output = nullptr;
+static uint32_t runnerTime = 0;
+
+int16_t g_anas[NUM_ANALOGS];
+
+uint16_t anaIn(uint8_t chan)
+{
+  return g_anas[chan];
+}
+
+uint16_t getAnalogValue(uint8_t index)
+{
+  return anaIn(index);
+}
+
+static void recordAudio(uint16_t freq, uint16_t len, const char * filename)
+{
+  if (filename)
+    fprintf(output, "%u,play,0,%s\n", runnerTime, filename);
+  else
+    fprintf(output, "%u,tone,%u,%u\n", runnerTime, freq, len);
+}
+
+static bool parseTraceLine(const char * line, RunnerEvent & event)
+{
+  char type[16];
+  unsigned time, index;
+  int value;
+
+  if (sscanf(line, "%u %15s %u", &time, type, &index) != 3)
+    return false;
+
+  event.time = time;
+  event.index = index;
+  event.id = 0;
+
+  if (!strcmp(type, "sport")) {
+    unsigned id;
+    event.type = RUNNER_EVENT_SPORT;
+    if (sscanf(line, "%*u %*s %*u %x %d", &id, &value) != 2 || index > 0x1F)
+      return false;
+    event.id = id;
+    event.value = value;
+    return true;
+  }
+
+  if (sscanf(line, "%*u %*s %*u %d", &value) != 1)
+    return false;
+  event.value = value;
+
+  if (!strcmp(type, "stick")) {
+    event.type = RUNNER_EVENT_STICK;
+    return index < NUM_STICKS;
+  }
+  else if (!strcmp(type, "pot")) {
+    event.type = RUNNER_EVENT_POT;
+    return index < NUM_POTS;
+  }
+  else if (!strcmp(type, "slider")) {
+    event.type = RUNNER_EVENT_SLIDER;
+    return (int)index < NUM_SLIDERS;
+  }
+  else if (!strcmp(type, "switch")) {
+    event.type = RUNNER_EVENT_SWITCH;
+    return index < NUM_SWITCHES;
+  }
+  else if (!strcmp(type, "trim")) {
+    event.type = RUNNER_EVENT_TRIM;
+    return index < NUM_TRIMS_KEYS;
+  }
+
+  return false;
+}
+
+static bool readTrace(const char * filename, std::vector<RunnerEvent> & events)
+{
+  FILE * f = fopen(filename, "r");
+  if (!f) {
+    fprintf(stderr, "Could not open %s\n", filename);
+    return false;
+  }
+
+  char line[256];
+  unsigned lineNumber = 0;
+  while (fgets(line, sizeof(line), f)) {
+    lineNumber++;
+    char * comment = strchr(line, '#');
+    if (comment)
+      *comment = '\0';
+    if (strspn(line, " \t\r\n") == strlen(line))
+      continue;
+    RunnerEvent event;
+    if (!parseTraceLine(line, event)) {
+      fprintf(stderr, "%s:%u: invalid event\n", filename, lineNumber);
+      fclose(f);
+      return false;
+    }
+    events.push_back(event);
+  }
+
+  fclose(f);
+
+  // events with the same time keep their order
+  std::stable_sort(events.begin(), events.end(), [](const RunnerEvent & a, const RunnerEvent & b) { return a.time < b.time; });
+  return true;
+}
+
+static void applyEvent(const RunnerEvent & event)
+{
+  switch (event.type) {
+    case RUNNER_EVENT_STICK:
+      g_anas[event.index] = limit<int32_t>(-RESX, event.value, RESX);
+      break;
+    case RUNNER_EVENT_POT:
+      g_anas[NUM_STICKS + event.index] = limit<int32_t>(-RESX, event.value, RESX);
+      break;
+    case RUNNER_EVENT_SLIDER:
+      g_anas[NUM_STICKS + NUM_POTS + event.index] = limit<int32_t>(-RESX, event.value, RESX);
+      break;
+    case RUNNER_EVENT_SWITCH:
+      simuSetSwitch(event.index, event.value);
+      break;
+    case RUNNER_EVENT_TRIM:
+      simuSetTrim(event.index, event.value);
+      break;
+    case RUNNER_EVENT_SPORT:
+    {
+      uint8_t packet[FRSKY_SPORT_PACKET_SIZE];
+      packet[0] = event.index;
+      packet[1] = DATA_FRAME;
+      packet[2] = event.id;
+      packet[3] = event.id >> 8;
+      for (uint8_t i = 0; i < 4; i++) {
+        packet[4 + i] = (uint32_t)event.value >> (8 * i);
+      }
+      packet[8] = 0;
+      sportProcessTelemetryPacketWithoutCrc(TELEMETRY_ENDPOINT_SPORT, packet);
+      break;
+    }
+  }
+}
+
+static void recordOutputs(bool all)
+{
+  static int16_t lastChannels[MAX_OUTPUT_CHANNELS];
+  static bool lastLogicalSwitches[MAX_LOGICAL_SWITCHES];
+  static uint8_t lastFlightMode;
+
+  for (uint8_t i = 0; i < MAX_OUTPUT_CHANNELS; i++) {
+    if (all || channelOutputs[i] != lastChannels[i]) {
+      lastChannels[i] = channelOutputs[i];
+      fprintf(output, "%u,ch,%u,%d\n", runnerTime, i, channelOutputs[i]);
+    }
+  }
+
+  for (uint8_t i = 0; i < MAX_LOGICAL_SWITCHES; i++) {
+    bool value = getSwitch(SWSRC_SW1 + i);
+    if (all || value != lastLogicalSwitches[i]) {
+      lastLogicalSwitches[i] = value;
+      fprintf(output, "%u,ls,%u,%u\n", runnerTime, i, value);
+    }
+  }
+
+  uint8_t flightMode = getFlightMode();
+  if (all || flightMode != lastFlightMode) {
+    lastFlightMode = flightMode;
+    fprintf(output, "%u,fm,0,%u\n", runnerTime, flightMode);
+  }
+}
+
+// the input files are only read, nothing is written back
+static bool loadRunnerModel(const char * radioFile, const char * model)
+{
+#if defined(EEPROM)
+  FILE * f = radioFile ? fopen(radioFile, "rb") : nullptr;
+  if (!f) {
+    fprintf(stderr, "Could not open the radio data %s\n", radioFile ? radioFile : "(--radio is needed)");
+    return false;
+  }
+  memset(eeprom, 0xFF, EEPROM_SIZE);
+  fread(eeprom, 1, EEPROM_SIZE, f);
+  fclose(f);
+
+  // older radio data is converted in memory, eeConvert() would wait for a key press and write the eeprom
+  uint8_t version = EEPROM_VER;
+  if (!eepromOpen()) {
+    fprintf(stderr, "Invalid radio data %s\n", radioFile);
+    return false;
+  }
+  if (!eeLoadGeneral(false)) {
+#if defined(EEPROM_CONVERSIONS)
+    version = g_eeGeneral.version;
+    if (version < EEPROM_CONVERSIONS || version >= EEPROM_VER) {
+      fprintf(stderr, "Invalid radio data %s\n", radioFile);
+      return false;
+    }
+    eeLoadGeneralSettingsData();
+    convertRadioData(version);
+#else
+    fprintf(stderr, "Invalid radio data %s\n", radioFile);
+    return false;
+#endif
+  }
+  postRadioSettingsLoad();
+
+  uint8_t index = model ? atoi(model) : g_eeGeneral.currModel;
+  preModelLoad();
+  if (index >= MAX_MODELS || eeLoadModelData(index) < EEPROM_MIN_MODEL_SIZE) {
+    fprintf(stderr, "No model %u in %s\n", index, radioFile);
+    return false;
+  }
+#if defined(EEPROM_CONVERSIONS)
+  if (version < EEPROM_VER) {
+    convertModelData(version);
+  }
+#endif
+  postModelLoad(false);
+#else
+  const char * error = loadRadioSettings();
+  if (error) {
+    fprintf(stderr, "Could not load the radio settings: %s\n", error);
+    return false;
+  }
+
+  // loadModel() would create a default model in place of a missing one
+  char path[256];
+  FILINFO info;
+  if (!model)
+    model = g_eeGeneral.currModelFilename;
+  getModelPath(path, model);
+  if (f_stat(path, &info) != FR_OK || (error = loadModel(model, false))) {
+    fprintf(stderr, "Could not load the model %s%s%s\n", path, error ? ": " : "", error ? error : "");
+    return false;
+  }
+#endif
+
+  return true;
+}
+
+int main(int argc, char ** argv)
+{
+  const char * radioFile = nullptr;
+  const char * sdPath = nullptr;
+  const char * model = nullptr;
+  const char * outputFile = nullptr;
+  const char * traceFile = nullptr;
+  long duration = -1;
+
+  for (int i = 1; i < argc; i++) {
+    if (!strncmp(argv[i], "--radio=", 8)) {
+      radioFile = argv[i] + 8;
+    }
+    else if (!strncmp(argv[i], "--sd=", 5)) {
+      sdPath = argv[i] + 5;
+    }
+    else if (!strncmp(argv[i], "--model=", 8)) {
+      model = argv[i] + 8;
+    }
+    else if (!strncmp(argv[i], "--duration=", 11)) {
+      duration = strtol(argv[i] + 11, nullptr, 10);
+    }
+    else if (!strncmp(argv[i], "--out=", 6)) {
+      outputFile = argv[i] + 6;
+    }
+    else if (argv[i][0] != '-' && !traceFile) {
+      traceFile = argv[i];
+    }
+    else {
+      fprintf(stderr, "Unknown option %s\n", argv[i]);
+      return 1;
+    }
+  }
+
+  if (!traceFile) {
+    fprintf(stderr, "Usage: %s [--radio=<file>] [--sd=<dir>] [--model=<model>] [--duration=<ms>] [--out=<file>] <trace>\n", argv[0]);
+    return 1;
+  }
+
+  std::vector<RunnerEvent> events;
+  if (!readTrace(traceFile, events))
+    return 1;
+  if (duration < 0)
+    duration = (events.empty() ? 0 : events.back().time) + 1000;
+
+  if (!outputFile) {
+    // the firmware traces are written to stdout, keep it for the output only
+    fflush(stdout);
+    output = fdopen(dup(fileno(stdout)), "w");
+    dup2(fileno(stderr), fileno(stdout));
+  }
+
+  simuInit();
+  simuSetVirtualTimer(true);
+  simuFatfsSetPaths(sdPath, sdPath);
+  StartEepromThread(nullptr);
+#if defined(EEPROM_SIZE)
+  eeprom = (uint8_t *)malloc(EEPROM_SIZE);
+#endif
+  for (uint8_t i = 0; i < NUM_SWITCHES; i++) {
+    simuSetSwitch(i, -1);
+  }
+
+  bool loaded = loadRunnerModel(radioFile, model);
+  if (loaded) {
+    if (outputFile)
+      output = fopen(outputFile, "w");
+    if (!output) {
+      fprintf(stderr, "Could not write %s\n", outputFile ? outputFile : "stdout");
+      loaded = false;
+    }
+  }
+  if (!loaded) {
+    StopEepromThread();
+    return 1;
+  }
+
+  // see StartSimu(), some special functions need a non-zero timer
+  g_tmr10ms = 1;
+  simuAudioCallback = recordAudio;
+
+  auto event = events.begin();
+  for (runnerTime = 0; runnerTime <= (uint32_t)duration; runnerTime += RUNNER_STEP_MS) {
+    for (; event != events.end() && event->time <= runnerTime; ++event) {
+      applyEvent(*event);
+    }
+    simuAdvanceVirtualTimer(RUNNER_STEP_MS * 1000);
+    per10ms();
+    doMixerCalculations();
+    telemetryWakeup();
+    recordOutputs(runnerTime == 0);
+  }
+
+  simuAudioCallback = nullptr;
+  fclose(output);
+  StopEepromThread();
+  return 0;
+}
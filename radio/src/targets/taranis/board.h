@@ -740,6 +740,8 @@ void sportSendByteLoop(uint8_t byte);
 void sportStopSendByteLoop();
 void sportSendBuffer(const uint8_t * buffer, uint32_t count);
 bool telemetryGetByte(uint8_t * byte);
+const uint8_t * telemetryGetSpan(uint32_t & count);
+void telemetrySkipSpan(uint32_t count);
 void telemetryClearFifo();
 extern uint32_t telemetryErrors;
 
@@ -831,6 +833,7 @@ void hapticOff();
 extern uint8_t auxSerialMode;
 void auxSerialInit(unsigned int mode, unsigned int protocol);
 void auxSerialPutc(char c);
+void auxSerialPutBuffer(const uint8_t * data, uint32_t size);
 #define auxSerialTelemetryInit(protocol) auxSerialInit(UART_MODE_TELEMETRY, protocol)
 void auxSerialSbusInit();
 void auxSerialStop();
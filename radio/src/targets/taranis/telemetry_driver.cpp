@@ -399,6 +399,33 @@ bool telemetryGetByte(uint8_t * byte)
 #endif
 }
 
+const uint8_t * telemetryGetSpan(uint32_t & count)
+{
+#if defined(AUX_SERIAL)
+  if (telemetryProtocol == PROTOCOL_TELEMETRY_FRSKY_D_SECONDARY) {
+    if (auxSerialMode == UART_MODE_TELEMETRY) {
+      return auxSerialRxFifo.span(count);
+    }
+    else {
+      count = 0;
+      return nullptr;
+    }
+  }
+#endif
+  return telemetryFifo.span(count);
+}
+
+void telemetrySkipSpan(uint32_t count)
+{
+#if defined(AUX_SERIAL)
+  if (telemetryProtocol == PROTOCOL_TELEMETRY_FRSKY_D_SECONDARY) {
+    auxSerialRxFifo.skip(count);
+    return;
+  }
+#endif
+  telemetryFifo.skip(count);
+}
+
 void telemetryClearFifo()
 {
   telemetryFifo.clear();
@@ -101,6 +101,66 @@ void sendSynchronousPulses(uint8_t runMask)
 }
 
 uint32_t nextMixerTime[NUM_MODULES];
+MixerSchedulerStats mixerSchedulerStats[NUM_MODULES];
+uint16_t mixerDurationAverage;
+
+void resetMixerSchedulerStats()
+{
+  for (uint8_t i=0; i<NUM_MODULES; i++) {
+    MixerSchedulerStats & stats = mixerSchedulerStats[i];
+    memclear(stats.lateness, sizeof(stats.lateness));
+    memclear(stats.jitter, sizeof(stats.jitter));
+    stats.maxLateness = 0;
+  }
+}
+
+uint16_t getMixerSchedulerMaxLateness()
+{
+  uint16_t result = 0;
+  for (uint8_t i=0; i<NUM_MODULES; i++) {
+    result = max(result, mixerSchedulerStats[i].maxLateness);
+  }
+  return result;
+}
+
+// value in ms, binned in RTOS ticks as RTOS_GET_MS() doesn't move by less than a tick
+static void addMixerSchedulerSample(uint16_t * histogram, uint32_t value)
+{
+  uint8_t bin = 0;
+  value /= RTOS_MS_PER_TICK;
+  while (value && bin < MIXER_SCHEDULER_HISTOGRAM_SIZE - 1) {
+    value >>= 1;
+    bin++;
+  }
+  if (histogram[bin] < UINT16_MAX)
+    histogram[bin]++;
+}
+
+static void updateMixerSchedulerStats(uint8_t module, uint32_t now)
+{
+  MixerSchedulerStats & stats = mixerSchedulerStats[module];
+
+  uint32_t lateness = now - nextMixerTime[module];
+  addMixerSchedulerSample(stats.lateness, lateness);
+  if (lateness > stats.maxLateness)
+    stats.maxLateness = min<uint32_t>(lateness, UINT16_MAX);
+
+  if (stats.lastRun) {
+    uint32_t interval = now - stats.lastRun;
+    addMixerSchedulerSample(stats.jitter, interval > stats.period ? interval - stats.period : stats.period - interval);
+  }
+  stats.lastRun = now;
+}
+
+uint32_t getMixerTaskWaitTime(uint32_t now)
+{
+  uint32_t wait = MIXER_TASK_MAX_WAIT_MS;
+  for (uint8_t i=0; i<NUM_MODULES; i++) {
+    if ((int32_t)(nextMixerTime[i] - now) < (int32_t)wait)
+      wait = max<int32_t>(nextMixerTime[i] - now, 1);
+  }
+  return wait;
+}
 
 TASK_FUNCTION(mixerTask)
 {
@@ -120,7 +180,7 @@ TASK_FUNCTION(mixerTask)
     bluetooth.wakeup();
 #endif
 
-    RTOS_WAIT_TICKS(1);
+    RTOS_WAIT_MS(getMixerTaskWaitTime(RTOS_GET_MS()));
 
 #if defined(SIMU)
     if (pwrCheck() == e_power_off) {
@@ -152,6 +212,16 @@ TASK_FUNCTION(mixerTask)
     if (!s_pulses_paused) {
       uint16_t t0 = getTmr2MHz();
 
+      for (uint8_t i=0; i<NUM_MODULES; i++) {
+        if (runMask & (1 << i)) {
+          updateMixerSchedulerStats(i, now);
+          if (!isModuleSynchronous(i)) {
+            // the next pulses setup will give the real deadline
+            nextMixerTime[i] = now + mixerSchedulerStats[i].period;
+          }
+        }
+      }
+
       DEBUG_TIMER_START(debugTimerMixer);
       RTOS_LOCK_MUTEX(mixerMutex);
       doMixerCalculations();
@@ -160,6 +230,9 @@ TASK_FUNCTION(mixerTask)
       RTOS_UNLOCK_MUTEX(mixerMutex);
       DEBUG_TIMER_STOP(debugTimerMixer);
 
+      uint16_t duration = getTmr2MHz() - t0;
+      mixerDurationAverage = (mixerDurationAverage * 7 + duration) / 8;
+
 #if defined(STM32) && !defined(SIMU)
       if (getSelectedUsbMode() == USB_JOYSTICK_MODE) {
         usbJoystickUpdate();
@@ -192,16 +265,19 @@ void scheduleNextMixerCalculation(uint8_t module, uint32_t period_ms)
 {
   // Schedule next mixer calculation time,
 
+  mixerSchedulerStats[module].period = period_ms;
+
   if (isModuleSynchronous(module)) {
-    nextMixerTime[module] += period_ms / RTOS_MS_PER_TICK;
-    if (nextMixerTime[module] < RTOS_GET_TIME()) {
+    nextMixerTime[module] += period_ms;
+    if (nextMixerTime[module] < RTOS_GET_MS()) {
       // we are late ... let's add some small delay
-      nextMixerTime[module] = (uint32_t) RTOS_GET_TIME() + (period_ms / RTOS_MS_PER_TICK);
+      nextMixerTime[module] = RTOS_GET_MS() + period_ms;
     }
   }
   else {
-    // for now assume mixer calculation takes 2 ms.
-    nextMixerTime[module] = (uint32_t) RTOS_GET_TIME() + (period_ms / RTOS_MS_PER_TICK);
+    // the pulses are sent asynchronously: the mixer has to be finished before the next frame
+    uint32_t mixerDuration = min<uint32_t>((mixerDurationAverage + 1999) / 2000, period_ms - 1);
+    nextMixerTime[module] = RTOS_GET_MS() + period_ms - mixerDuration;
   }
 
   DEBUG_TIMER_STOP(debugTimerMixerCalcToUsage);
@@ -47,6 +47,19 @@ extern RTOS_DEFINE_STACK(mixerStack, MIXER_STACK_SIZE);
 extern RTOS_TASK_HANDLE audioTaskId;
 extern RTOS_DEFINE_STACK(audioStack, AUDIO_STACK_SIZE);
 
+#if defined(INTMODULE_HEARTBEAT) && defined(INTMODULE_USART)
+  // the internal module heartbeat interrupt may move the deadline at any time
+  #define MIXER_TASK_MAX_WAIT_MS       1
+#elif defined(SBUS_TRAINER) || defined(BLUETOOTH)
+  // the SBUS trainer and bluetooth polls of the mixer task need to run on every tick
+  #define MIXER_TASK_MAX_WAIT_MS       RTOS_MS_PER_TICK
+#else
+  #define MIXER_TASK_MAX_WAIT_MS       5
+#endif
+
+// time (in ms) the mixer task sleeps until the earliest module deadline
+uint32_t getMixerTaskWaitTime(uint32_t now);
+
 extern RTOS_MUTEX_HANDLE mixerMutex;
 extern RTOS_FLAG_HANDLE openTxInitCompleteFlag;
 
@@ -197,20 +197,19 @@ void processCrossfireTelemetryFrame()
   }
 }
 
-void processCrossfireTelemetryData(uint8_t data)
+static void onCrossfireTelemetryFrameReceived()
 {
-#if defined(AUX_SERIAL)
-  if (g_eeGeneral.auxSerialMode == UART_MODE_TELEMETRY_MIRROR) {
-    auxSerialPutc(data);
-  }
-#endif
-
-#if defined(AUX2_SERIAL)
-  if (g_eeGeneral.aux2SerialMode == UART_MODE_TELEMETRY_MIRROR) {
-    aux2SerialPutc(data);
+#if defined(BLUETOOTH)
+  if (g_eeGeneral.bluetoothMode == BLUETOOTH_TELEMETRY && bluetooth.state == BLUETOOTH_STATE_CONNECTED) {
+    bluetooth.write(telemetryRxBuffer, telemetryRxBufferCount);
   }
 #endif
+  processCrossfireTelemetryFrame();
+  telemetryRxBufferCount = 0;
+}
 
+static void processCrossfireTelemetryByte(uint8_t data)
+{
   if (telemetryRxBufferCount == 0 && data != RADIO_ADDRESS) {
     TRACE("[XF] address 0x%02X error", data);
     return;
@@ -233,14 +232,54 @@ void processCrossfireTelemetryData(uint8_t data)
   if (telemetryRxBufferCount > 4) {
     uint8_t length = telemetryRxBuffer[1];
     if (length + 2 == telemetryRxBufferCount) {
-#if defined(BLUETOOTH)
-      if (g_eeGeneral.bluetoothMode == BLUETOOTH_TELEMETRY && bluetooth.state == BLUETOOTH_STATE_CONNECTED) {
-        bluetooth.write(telemetryRxBuffer, telemetryRxBufferCount);
-      }
+      onCrossfireTelemetryFrameReceived();
+    }
+  }
+}
+
+void processCrossfireTelemetryData(const uint8_t * data, uint32_t count)
+{
+#if defined(AUX_SERIAL)
+  if (g_eeGeneral.auxSerialMode == UART_MODE_TELEMETRY_MIRROR) {
+    auxSerialPutBuffer(data, count);
+  }
 #endif
-      processCrossfireTelemetryFrame();
-      telemetryRxBufferCount = 0;
+
+#if defined(AUX2_SERIAL)
+  if (g_eeGeneral.aux2SerialMode == UART_MODE_TELEMETRY_MIRROR) {
+    aux2SerialPutBuffer(data, count);
+  }
+#endif
+
+  while (count > 0) {
+    if (telemetryRxBufferCount == 0) {
+      // skip everything up to the next frame start at once
+      auto start = (const uint8_t *)memchr(data, RADIO_ADDRESS, count);
+      if (!start) {
+        TRACE("[XF] address error, %d bytes skipped", count);
+        return;
+      }
+      count -= start - data;
+      data = start;
     }
+    else if (telemetryRxBufferCount >= 2) {
+      // the frame length is known, take all its available bytes at once
+      uint32_t frameSize = telemetryRxBuffer[1] + 2;
+      if (frameSize > 4 && telemetryRxBufferCount < frameSize) {
+        uint32_t size = min<uint32_t>(frameSize - telemetryRxBufferCount, count);
+        memcpy(&telemetryRxBuffer[telemetryRxBufferCount], data, size);
+        telemetryRxBufferCount += size;
+        data += size;
+        count -= size;
+        if (telemetryRxBufferCount == frameSize) {
+          onCrossfireTelemetryFrameReceived();
+        }
+        continue;
+      }
+    }
+
+    processCrossfireTelemetryByte(*data++);
+    count--;
   }
 }
 
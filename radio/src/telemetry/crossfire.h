@@ -90,7 +90,7 @@ enum CrossfireFrames{
   CRSF_FRAME_MODELID_SENT
 };
 
-void processCrossfireTelemetryData(uint8_t data);
+void processCrossfireTelemetryData(const uint8_t * data, uint32_t count);
 void crossfireSetDefault(int index, uint8_t id, uint8_t subId);
 uint8_t createCrossfireModelIDFrame(uint8_t * frame);
 
@@ -225,20 +225,8 @@ void processGhostTelemetryFrame()
   }
 }
 
-void processGhostTelemetryData(uint8_t data)
+static void processGhostTelemetryByte(uint8_t data)
 {
-#if defined(AUX_SERIAL)
-  if (g_eeGeneral.auxSerialMode == UART_MODE_TELEMETRY_MIRROR) {
-    auxSerialPutc(data);
-  }
-#endif
-
-#if defined(AUX2_SERIAL)
-  if (g_eeGeneral.aux2SerialMode == UART_MODE_TELEMETRY_MIRROR) {
-    aux2SerialPutc(data);
-  }
-#endif
-
   if (telemetryRxBufferCount == 0 && data != GHST_ADDR_RADIO) {
     TRACE("[GH] address 0x%02X error", data);
     return;
@@ -261,6 +249,52 @@ void processGhostTelemetryData(uint8_t data)
   }
 }
 
+void processGhostTelemetryData(const uint8_t * data, uint32_t count)
+{
+#if defined(AUX_SERIAL)
+  if (g_eeGeneral.auxSerialMode == UART_MODE_TELEMETRY_MIRROR) {
+    auxSerialPutBuffer(data, count);
+  }
+#endif
+
+#if defined(AUX2_SERIAL)
+  if (g_eeGeneral.aux2SerialMode == UART_MODE_TELEMETRY_MIRROR) {
+    aux2SerialPutBuffer(data, count);
+  }
+#endif
+
+  while (count > 0) {
+    if (telemetryRxBufferCount == 0) {
+      // skip everything up to the next frame start at once
+      auto start = (const uint8_t *)memchr(data, GHST_ADDR_RADIO, count);
+      if (!start) {
+        TRACE("[GH] address error, %d bytes skipped", count);
+        return;
+      }
+      count -= start - data;
+      data = start;
+    }
+    else if (telemetryRxBufferCount >= 2) {
+      // the frame length is known, take all its available bytes at once
+      uint32_t frameSize = telemetryRxBuffer[1] + 2;
+      if (frameSize > 4 && frameSize <= TELEMETRY_RX_PACKET_SIZE && telemetryRxBufferCount < frameSize) {
+        uint32_t size = min<uint32_t>(frameSize - telemetryRxBufferCount, count);
+        memcpy(&telemetryRxBuffer[telemetryRxBufferCount], data, size);
+        telemetryRxBufferCount += size;
+        data += size;
+        count -= size;
+        if (telemetryRxBufferCount == frameSize) {
+          processGhostTelemetryFrame();
+          telemetryRxBufferCount = 0;
+        }
+        continue;
+      }
+    }
+
+    processGhostTelemetryByte(*data++);
+    count--;
+  }
+}
 
 void ghostSetDefault(int index, uint8_t id, uint8_t subId)
 {
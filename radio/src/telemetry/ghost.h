@@ -96,7 +96,7 @@ enum GhstVtxBand
   GHST_VTX_BAND_COUNT
 };
 
-void processGhostTelemetryData(uint8_t data);
+void processGhostTelemetryData(const uint8_t * data, uint32_t count);
 void ghostSetDefault(int index, uint8_t id, uint8_t subId);
 
 #if SPORT_MAX_BAUDRATE < 400000
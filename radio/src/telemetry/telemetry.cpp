@@ -40,14 +40,14 @@ void processTelemetryData(uint8_t data)
 {
 #if defined(CROSSFIRE)
   if (telemetryProtocol == PROTOCOL_TELEMETRY_CROSSFIRE) {
-    processCrossfireTelemetryData(data);
+    processCrossfireTelemetryData(&data, 1);
     return;
   }
 #endif
 
 #if defined(GHOST)
   if (telemetryProtocol == PROTOCOL_TELEMETRY_GHOST) {
-    processGhostTelemetryData(data);
+    processGhostTelemetryData(&data, 1);
     return;
   }
 #endif
@@ -77,6 +77,27 @@ void processTelemetryData(uint8_t data)
   processFrskyTelemetryData(data);
 }
 
+void processTelemetryData(const uint8_t * data, uint32_t count)
+{
+#if defined(CROSSFIRE)
+  if (telemetryProtocol == PROTOCOL_TELEMETRY_CROSSFIRE) {
+    processCrossfireTelemetryData(data, count);
+    return;
+  }
+#endif
+
+#if defined(GHOST)
+  if (telemetryProtocol == PROTOCOL_TELEMETRY_GHOST) {
+    processGhostTelemetryData(data, count);
+    return;
+  }
+#endif
+
+  for (uint32_t i = 0; i < count; i++) {
+    processTelemetryData(data[i]);
+  }
+}
+
 inline bool isBadAntennaDetected()
 {
   if (!isRasValueValid())
@@ -94,7 +115,6 @@ inline bool isBadAntennaDetected()
 void telemetryWakeup()
 {
   uint8_t requiredTelemetryProtocol = modelTelemetryProtocol();
-  uint8_t data;
 
 #if defined(REVX)
   uint8_t requiredSerialInversion = g_model.moduleData[EXTERNAL_MODULE].invertedSerial;
@@ -125,6 +145,7 @@ void telemetryWakeup()
 #endif
 
 #if defined(INTERNAL_MODULE_MULTI)
+  uint8_t data;
   if (intmoduleFifo.pop(data)) {
     LOG_TELEMETRY_WRITE_START();
     do {
@@ -135,15 +156,23 @@ void telemetryWakeup()
 #endif
 
 #if defined(STM32)
-  if (telemetryGetByte(&data)) {
+  // the received bytes are processed by contiguous spans of the fifo (2 when the data wraps)
+  uint32_t count;
+  const uint8_t * span = telemetryGetSpan(count);
+  if (count > 0) {
     LOG_TELEMETRY_WRITE_START();
     do {
-      processTelemetryData(data);
-      LOG_TELEMETRY_WRITE_BYTE(data);
-    } while (telemetryGetByte(&data));
+      processTelemetryData(span, count);
+      for (uint32_t i = 0; i < count; i++) {
+        LOG_TELEMETRY_WRITE_BYTE(span[i]);
+      }
+      telemetrySkipSpan(count);
+      span = telemetryGetSpan(count);
+    } while (count > 0);
   }
 #elif defined(PCBSKY9X)
   if (telemetryProtocol == PROTOCOL_TELEMETRY_FRSKY_D_SECONDARY) {
+    uint8_t data;
     while (telemetrySecondPortReceive(data)) {
       processTelemetryData(data);
     }
@@ -99,6 +99,9 @@ PACK(struct CellValue
 int setTelemetryValue(TelemetryProtocol protocol, uint16_t id, uint8_t subId, uint8_t instance, int32_t value, uint32_t unit, uint32_t prec);
 int setTelemetryText(TelemetryProtocol protocol, uint16_t id, uint8_t subId, uint8_t instance, const char * text);
 void delTelemetryIndex(uint8_t index);
+void invalidateTelemetrySensorsIndex();
+// returns the first sensor with this label (not zero terminated), or -1
+int findTelemetryIndex(const char * label, int len);
 int availableTelemetryIndex();
 int lastUsedTelemetryIndex();
 
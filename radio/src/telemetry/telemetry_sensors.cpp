@@ -500,24 +500,137 @@ int lastUsedTelemetryIndex()
   return -1;
 }
 
+/*
+ * Custom sensors index: sensors are chained by hash of (id, subId), in
+ * ascending index order. The index is rebuilt on first use after any model
+ * change (storageDirty(EE_MODEL), model load, new sensor). Lookups always
+ * check the sensor itself, so a stale index can only miss a sensor, never
+ * update a wrong one.
+ */
+#define TELEMETRY_SENSORS_HASH_SIZE    32   // power of 2
+#define TELEMETRY_SENSORS_NO_INDEX     0xFF
+
+static uint8_t telemetrySensorsHash[TELEMETRY_SENSORS_HASH_SIZE];
+static uint8_t telemetrySensorsNext[MAX_TELEMETRY_SENSORS];
+static bool telemetrySensorsIndexValid = false;
+
+/*
+ * Sensors labels index, used by the Lua scripts to find a sensor by its name.
+ * Same rules as the custom sensors index: rebuilt on first use after any
+ * model change, and lookups always check the label of the sensor found.
+ */
+static uint8_t telemetryLabelsHash[TELEMETRY_SENSORS_HASH_SIZE];
+static uint8_t telemetryLabelsNext[MAX_TELEMETRY_SENSORS];
+static bool telemetryLabelsIndexValid = false;
+
+static inline uint8_t telemetrySensorHash(uint16_t id, uint8_t subId)
+{
+  return (id ^ (id >> 5) ^ (id >> 10) ^ (subId * 7)) & (TELEMETRY_SENSORS_HASH_SIZE - 1);
+}
+
+static inline uint8_t telemetryLabelHash(const char * label, int len)
+{
+  return hash(label, len) & (TELEMETRY_SENSORS_HASH_SIZE - 1);
+}
+
+void invalidateTelemetrySensorsIndex()
+{
+  telemetrySensorsIndexValid = false;
+  telemetryLabelsIndexValid = false;
+}
+
+static void buildTelemetrySensorsIndex()
+{
+  telemetrySensorsIndexValid = true;
+  memset(telemetrySensorsHash, TELEMETRY_SENSORS_NO_INDEX, sizeof(telemetrySensorsHash));
+  for (int index = MAX_TELEMETRY_SENSORS - 1; index >= 0; index--) {
+    TelemetrySensor & telemetrySensor = g_model.telemetrySensors[index];
+    if (telemetrySensor.type == TELEM_TYPE_CUSTOM) {
+      uint8_t hash = telemetrySensorHash(telemetrySensor.id, telemetrySensor.subId);
+      telemetrySensorsNext[index] = telemetrySensorsHash[hash];
+      telemetrySensorsHash[hash] = index;
+    }
+  }
+}
+
+static void buildTelemetryLabelsIndex()
+{
+  telemetryLabelsIndexValid = true;
+  memset(telemetryLabelsHash, TELEMETRY_SENSORS_NO_INDEX, sizeof(telemetryLabelsHash));
+  for (int index = MAX_TELEMETRY_SENSORS - 1; index >= 0; index--) {
+    char label[TELEM_LABEL_LEN + 1];
+    int len = zchar2str(label, g_model.telemetrySensors[index].label, TELEM_LABEL_LEN);
+    if (len > 0) {
+      uint8_t hash = telemetryLabelHash(label, len);
+      telemetryLabelsNext[index] = telemetryLabelsHash[hash];
+      telemetryLabelsHash[hash] = index;
+    }
+  }
+}
+
+int findTelemetryIndex(const char * label, int len)
+{
+  if (len <= 0 || len > TELEM_LABEL_LEN) {
+    return -1;
+  }
+
+  if (!telemetryLabelsIndexValid) {
+    buildTelemetryLabelsIndex();
+  }
+
+  uint8_t index = telemetryLabelsHash[telemetryLabelHash(label, len)];
+  for (uint8_t count = 0; index < MAX_TELEMETRY_SENSORS && count < MAX_TELEMETRY_SENSORS; count++) {
+    char sensorLabel[TELEM_LABEL_LEN + 1];
+    if (zchar2str(sensorLabel, g_model.telemetrySensors[index].label, TELEM_LABEL_LEN) == len && !memcmp(sensorLabel, label, len)) {
+      return index;
+    }
+    index = telemetryLabelsNext[index];
+  }
+
+  return -1;
+}
+
 template <class T>
-int setTelemetryValue(TelemetryProtocol protocol, uint16_t id, uint8_t subId, uint8_t instance, T value, uint32_t unit = 0, uint32_t prec = 0)
+static bool setTelemetryIndexedValues(TelemetryProtocol protocol, uint16_t id, uint8_t subId, uint8_t instance, T value, uint32_t unit, uint32_t prec)
 {
   bool sensorFound = false;
 
-  for (int index = 0; index < MAX_TELEMETRY_SENSORS; index++) {
+  if (!telemetrySensorsIndexValid) {
+    buildTelemetrySensorsIndex();
+  }
+
+  // the chain length is bounded in case the index is rebuilt by another task meanwhile
+  uint8_t index = telemetrySensorsHash[telemetrySensorHash(id, subId)];
+  for (uint8_t count = 0; index < MAX_TELEMETRY_SENSORS && count < MAX_TELEMETRY_SENSORS; count++) {
     TelemetrySensor & telemetrySensor = g_model.telemetrySensors[index];
     if (telemetrySensor.type == TELEM_TYPE_CUSTOM && telemetrySensor.id == id && telemetrySensor.subId == subId && (telemetrySensor.isSameInstance(protocol, instance) || g_model.ignoreSensorIds)) {
       telemetryItems[index].setValue(telemetrySensor, value, unit, prec);
       sensorFound = true;
       // we continue search here, because sensors can share the same id and instance
     }
+    index = telemetrySensorsNext[index];
+  }
+
+  return sensorFound;
+}
+
+template <class T>
+int setTelemetryValue(TelemetryProtocol protocol, uint16_t id, uint8_t subId, uint8_t instance, T value, uint32_t unit = 0, uint32_t prec = 0)
+{
+  bool sensorFound = setTelemetryIndexedValues(protocol, id, subId, instance, value, unit, prec);
+
+  if (!sensorFound && allowNewSensors) {
+    // never create a duplicate sensor because of a stale index
+    buildTelemetrySensorsIndex();
+    sensorFound = setTelemetryIndexedValues(protocol, id, subId, instance, value, unit, prec);
   }
 
   if (sensorFound || !allowNewSensors) {
     return -1;
   }
 
+  invalidateTelemetrySensorsIndex();
+
   int index = availableTelemetryIndex();
   if (index >= 0) {
     switch (protocol) {
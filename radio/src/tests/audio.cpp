@@ -0,0 +1,223 @@
+/*
+ * Copyright (C) OpenTX
+ *
+ * Based on code named
+ *   th9x - http://code.google.com/p/th9x
+ *   er9x - http://code.google.com/p/er9x
+ *   gruvin9x - http://code.google.com/p/gruvin9x
+ *
+ * License GPLv2: http://www.gnu.org/licenses/gpl-2.0.html
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#include "gtests.h"
+
+#if defined(SDCARD)
+
+#define TEST_WAV_FILE     "/test.wav"
+#define TEST_WAV_SIZE     (9*AUDIO_BUFFER_SIZE)   // 4.5 buffers of 16 bits samples
+
+class AudioPromptsTest : public OpenTxTest
+{
+  protected:
+    void SetUp() override
+    {
+      OpenTxTest::SetUp();
+      extern std::string simuSdDirectory;
+      strcpy(tmpl, "/tmp/opentx-audio-XXXXXX");
+      ASSERT_NE(nullptr, mkdtemp(tmpl));
+      sdDirectory = simuSdDirectory;
+      simuSdDirectory = tmpl;
+      writeTestWav();
+      audioPromptsCache.invalidate();
+      audioPromptsCache.checkInvalidated();
+      memclear(&context, sizeof(context));
+    }
+
+    void TearDown() override
+    {
+      extern std::string simuSdDirectory;
+      simuSdDirectory = sdDirectory;
+      std::string command = std::string("rm -rf ") + tmpl;
+      EXPECT_EQ(0, system(command.c_str()));
+    }
+
+    static void writeTestWav()
+    {
+      const uint8_t header[] = {
+        'R', 'I', 'F', 'F', 0, 0, 0, 0, 'W', 'A', 'V', 'E',
+        'f', 'm', 't', ' ', 16, 0, 0, 0,
+        1, 0, 1, 0,                                         // PCM S16LE, mono
+        AUDIO_SAMPLE_RATE & 0xFF, AUDIO_SAMPLE_RATE >> 8, 0, 0,
+        0, 0, 0, 0, 2, 0, 16, 0,
+        'd', 'a', 't', 'a', TEST_WAV_SIZE & 0xFF, TEST_WAV_SIZE >> 8, 0, 0,
+      };
+      static uint8_t samples[TEST_WAV_SIZE];
+      FIL file;
+      UINT written;
+      ASSERT_EQ(FR_OK, f_open(&file, TEST_WAV_FILE, FA_WRITE | FA_CREATE_ALWAYS));
+      f_write(&file, header, sizeof(header), &written);
+      f_write(&file, samples, sizeof(samples), &written);
+      f_close(&file);
+    }
+
+    // returns the number of samples mixed
+    int play(int buffers)
+    {
+      AudioBuffer buffer;
+      int total = 0;
+      for (int i=0; i<buffers; i++) {
+        int result = context.mixBuffer(&buffer, 0, 0);
+        total += result;
+        if (result < AUDIO_BUFFER_SIZE)
+          break;
+      }
+      return total;
+    }
+
+    char tmpl[32];
+    std::string sdDirectory;
+    WavContext context;
+};
+
+TEST_F(AudioPromptsTest, cacheFlushedWhilePlaying)
+{
+#if defined(AUDIO_PROMPT_DATA_MAXSIZE)
+  // the first play loads the samples, the second one is played from the cache data
+  context.setFragment(TEST_WAV_FILE, 0, 0);
+  EXPECT_EQ(TEST_WAV_SIZE / 2, play(10));
+  ASSERT_TRUE(audioPromptsCache.isLoaded(audioPromptsCache.find(TEST_WAV_FILE)));
+#endif
+
+  context.setFragment(TEST_WAV_FILE, 0, 0);
+  EXPECT_EQ(AUDIO_BUFFER_SIZE, play(1));
+
+  audioPromptsCache.invalidate();
+  EXPECT_TRUE(audioPromptsCache.checkInvalidated());
+  context.releasePrompt();
+
+#if defined(AUDIO_PROMPT_DATA_MAXSIZE)
+  // the samples are gone with the cache entry
+  EXPECT_EQ(0, play(10));
+#else
+  // the end of the file is still played
+  EXPECT_EQ(TEST_WAV_SIZE / 2 - AUDIO_BUFFER_SIZE, play(10));
+#endif
+}
+
+TEST_F(AudioPromptsTest, pausedPromptKept)
+{
+#if defined(AUDIO_PROMPT_DATA_MAXSIZE)
+  // played from the cache data
+  context.setFragment(TEST_WAV_FILE, 0, 0);
+  EXPECT_EQ(TEST_WAV_SIZE / 2, play(10));
+#endif
+
+  // paused after the first buffer
+  context.setFragment(TEST_WAV_FILE, 0, 0);
+  EXPECT_EQ(AUDIO_BUFFER_SIZE, play(1));
+
+  // other prompts are played long after the pause
+  AudioPromptInfo info;
+  memclear(&info, sizeof(info));
+  info.size = 2;
+  for (int i=0; i<2*AUDIO_PROMPTS_CACHE_SIZE; i++) {
+    g_tmr10ms += 2 * AUDIO_PROMPT_IN_USE_DELAY;
+    sprintf(info.filename, "/other%d.wav", i);
+    audioPromptsCache.add(info);
+  }
+  EXPECT_NE(nullptr, audioPromptsCache.find(TEST_WAV_FILE));
+
+  // resumed where it was paused
+  EXPECT_EQ(TEST_WAV_SIZE / 2 - AUDIO_BUFFER_SIZE, play(10));
+
+  // the entry can be replaced once played
+  for (int i=0; i<AUDIO_PROMPTS_CACHE_SIZE; i++) {
+    g_tmr10ms += 2 * AUDIO_PROMPT_IN_USE_DELAY;
+    sprintf(info.filename, "/other%d.wav", i);
+    audioPromptsCache.add(info);
+  }
+  EXPECT_EQ(nullptr, audioPromptsCache.find(TEST_WAV_FILE));
+}
+
+#if defined(AUDIO_PROMPT_DATA_MAXSIZE)
+TEST_F(AudioPromptsTest, interruptedLoad)
+{
+  context.setFragment(TEST_WAV_FILE, 0, 0);
+  EXPECT_EQ(AUDIO_BUFFER_SIZE, play(1));
+  context.clear();
+  EXPECT_FALSE(audioPromptsCache.isLoaded(audioPromptsCache.find(TEST_WAV_FILE)));
+
+  // the load is resumed by the next play
+  context.setFragment(TEST_WAV_FILE, 0, 0);
+  EXPECT_EQ(TEST_WAV_SIZE / 2, play(10));
+  EXPECT_TRUE(audioPromptsCache.isLoaded(audioPromptsCache.find(TEST_WAV_FILE)));
+}
+#endif
+
+#endif // #if defined(SDCARD)
+
+// pseudo random samples, with the extreme values which saturate the mix
+static int16_t testSample(uint32_t i)
+{
+  if (i % 17 == 0)
+    return INT16_MAX;
+  if (i % 19 == 0)
+    return INT16_MIN;
+  return (int16_t)(i * 2654435761u >> 16);
+}
+
+static audio_data_t testData(uint32_t i)
+{
+  if (i % 13 == 0)
+    return AUDIO_DATA_MAX;
+  if (i % 23 == 0)
+    return AUDIO_DATA_MIN;
+  return limit<int32_t>(AUDIO_DATA_MIN, AUDIO_DATA_SILENCE + testSample(i * 7 + 1) / 2, AUDIO_DATA_MAX);
+}
+
+TEST(AudioMixing, fillSamples)
+{
+  audio_data_t result[16], expected[16];
+  for (uint32_t offset=0; offset<4; offset++) {
+    for (uint32_t count=0; offset+count<=DIM(result); count++) {
+      for (uint32_t i=0; i<DIM(result); i++) {
+        result[i] = expected[i] = testData(i);
+      }
+      for (uint32_t i=0; i<count; i++) {
+        expected[offset+i] = AUDIO_DATA_SILENCE;
+      }
+      fillSamples(&result[offset], count, AUDIO_DATA_SILENCE);
+      EXPECT_EQ(0, memcmp(expected, result, sizeof(result))) << "offset " << offset << " count " << count;
+    }
+  }
+}
+
+TEST(AudioMixing, mixSamplesBitIdentical)
+{
+  const uint32_t count = 64;
+  audio_data_t result[4 * count], expected[4 * count];
+  for (uint8_t ratio=1; ratio<=4; ratio++) {
+    for (unsigned int fade=0; fade<4; fade++) {
+      for (uint32_t i=0; i<DIM(result); i++) {
+        result[i] = expected[i] = testData(i + ratio);
+      }
+      audio_data_t * samples = expected;
+      for (uint32_t i=0; i<count; i++) {
+        for (uint8_t j=0; j<ratio; j++) {
+          mixSample(samples++, testSample(i), fade);
+        }
+      }
+      EXPECT_EQ(&result[count * ratio], mixSamples(result, count, ratio, fade, [](uint32_t i) -> int32_t { return testSample(i); }));
+      EXPECT_EQ(0, memcmp(expected, result, sizeof(result))) << "ratio " << (int)ratio << " fade " << fade;
+    }
+  }
+}
@@ -0,0 +1,151 @@
+/*
+ * Copyright (C) OpenTX
+ *
+ * Based on code named
+ *   th9x - http://code.google.com/p/th9x
+ *   er9x - http://code.google.com/p/er9x
+ *   gruvin9x - http://code.google.com/p/gruvin9x
+ *
+ * License GPLv2: http://www.gnu.org/licenses/gpl-2.0.html
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include "benchmarks.h"
+
+/*
+ * Host-side benchmarks of the firmware hot paths, run on the same simulated
+ * radio as gtests-radio. They don't replace measurements on the real hardware,
+ * but they are good enough to compare two builds of the same radio:
+ *
+ *   bench-radio --benchmark_out=before.json
+ *   ... change ...
+ *   bench-radio --benchmark_out=after.json
+ *
+ * Options:
+ *   --benchmark_out=<file>          write the results to <file>, as CSV if it ends with .csv, JSON otherwise
+ *   --benchmark_iterations=<count>  override the number of iterations of every benchmark
+ *   all gtest options (--gtest_filter=... to select benchmarks)
+ */
+
+struct BenchmarkResult {
+  std::string function;
+  std::string model;
+  uint32_t iterations;
+  uint64_t elapsedNs;
+};
+
+static std::vector<BenchmarkResult> benchmarkResults;
+static uint32_t benchmarkIterations = 0;
+
+int32_t lastAct = 0;
+uint16_t anaInValues[NUM_STICKS+NUM_POTS+NUM_SLIDERS] = { 0 };
+uint16_t anaIn(uint8_t chan)
+{
+  if (chan < NUM_STICKS+NUM_POTS+NUM_SLIDERS)
+    return anaInValues[chan];
+  else
+    return 0;
+}
+
+uint16_t getAnalogValue(uint8_t index)
+{
+  return anaIn(index);
+}
+
+uint32_t getBenchmarkIterations(uint32_t defaultIterations)
+{
+  return benchmarkIterations ? benchmarkIterations : defaultIterations;
+}
+
+void reportBenchmark(const char * function, BenchmarkModel model, uint32_t iterations, uint64_t elapsedNs)
+{
+  const char * modelName = getBenchmarkModelName(model);
+  double nsPerCall = double(elapsedNs) / iterations;
+
+  benchmarkResults.push_back({function, modelName, iterations, elapsedNs});
+
+  std::string key = std::string(function) + "." + modelName;
+  ::testing::Test::RecordProperty(key, std::to_string((uint64_t)nsPerCall));
+
+  printf("%-28s %-12s %10u iterations %12.1f ns/call\n", function, modelName, iterations, nsPerCall);
+  fflush(stdout);
+}
+
+static bool writeBenchmarkResults(const char * filename)
+{
+  FILE * f = fopen(filename, "w");
+  if (!f)
+    return false;
+
+  size_t len = strlen(filename);
+  bool csv = (len > 4 && !strcmp(filename + len - 4, ".csv"));
+
+  if (csv) {
+    fprintf(f, "flavour,function,model,iterations,total_ns,ns_per_call\n");
+    for (auto & result: benchmarkResults) {
+      fprintf(f, "%s,%s,%s,%u,%llu,%.1f\n", FLAVOUR, result.function.c_str(), result.model.c_str(), result.iterations,
+              (unsigned long long)result.elapsedNs, double(result.elapsedNs) / result.iterations);
+    }
+  }
+  else {
+    fprintf(f, "{\n  \"flavour\": \"%s\",\n  \"benchmarks\": [", FLAVOUR);
+    for (unsigned i = 0; i < benchmarkResults.size(); i++) {
+      auto & result = benchmarkResults[i];
+      fprintf(f, "%s\n    {\"function\": \"%s\", \"model\": \"%s\", \"iterations\": %u, \"total_ns\": %llu, \"ns_per_call\": %.1f}",
+              i > 0 ? "," : "", result.function.c_str(), result.model.c_str(), result.iterations,
+              (unsigned long long)result.elapsedNs, double(result.elapsedNs) / result.iterations);
+    }
+    fprintf(f, "\n  ]\n}\n");
+  }
+
+  fclose(f);
+  return true;
+}
+
+int main(int argc, char **argv)
+{
+  simuInit();
+  StartEepromThread(nullptr);
+#if defined(EEPROM_SIZE)
+  eeprom = (uint8_t *)malloc(EEPROM_SIZE);
+#endif
+  menuLevel = 0;
+  menuHandlers[0] = menuMainView;
+  ::testing::InitGoogleTest(&argc, argv);
+
+  const char * output = nullptr;
+  for (int i = 1; i < argc; i++) {
+    if (!strncmp(argv[i], "--benchmark_out=", 16)) {
+      output = argv[i] + 16;
+    }
+    else if (!strncmp(argv[i], "--benchmark_iterations=", 23)) {
+      benchmarkIterations = strtoul(argv[i] + 23, nullptr, 10);
+    }
+    else {
+      fprintf(stderr, "Unknown option %s\n", argv[i]);
+      return 1;
+    }
+  }
+
+  int result = RUN_ALL_TESTS();
+
+  if (output && !writeBenchmarkResults(output)) {
+    fprintf(stderr, "Could not write %s\n", output);
+    return 1;
+  }
+
+  return result;
+}
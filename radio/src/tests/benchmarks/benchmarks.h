@@ -0,0 +1,67 @@
+/*
+ * Copyright (C) OpenTX
+ *
+ * Based on code named
+ *   th9x - http://code.google.com/p/th9x
+ *   er9x - http://code.google.com/p/er9x
+ *   gruvin9x - http://code.google.com/p/gruvin9x
+ *
+ * License GPLv2: http://www.gnu.org/licenses/gpl-2.0.html
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#ifndef _BENCHMARKS_H_
+#define _BENCHMARKS_H_
+
+#include <chrono>
+#include "../gtests.h"
+
+// Models the benchmarks are run against
+enum BenchmarkModel {
+  BENCHMARK_MODEL_DEFAULT,      // modelDefault(), what a new model looks like
+  BENCHMARK_MODEL_FIXTURE,      // the converted model from the tests fixtures of this radio
+  BENCHMARK_MODEL_WORST_CASE,   // every mix, logical switch and sensor slot used
+};
+
+const char * getBenchmarkModelName(BenchmarkModel model);
+
+// Resets the radio and loads the given model. Returns false when the model is not available on this radio
+bool loadBenchmarkModel(BenchmarkModel model);
+
+// Builds the synthetic worst-case model on top of the current one
+void setupWorstCaseMixes();
+void setupWorstCaseLogicalSwitches();
+void setupWorstCaseCurves();
+void setupWorstCaseSensors();
+
+// Simulates the sticks / pots moving around between two iterations
+void moveBenchmarkInputs(uint32_t iteration);
+
+uint32_t getBenchmarkIterations(uint32_t defaultIterations);
+
+void reportBenchmark(const char * function, BenchmarkModel model, uint32_t iterations, uint64_t elapsedNs);
+
+/*
+ * Times the block given as last argument (which may use the `iteration` variable)
+ * over the default number of iterations, then reports the result
+ */
+#define BENCHMARK_LOOP(function, model, defaultIterations, ...) \
+  do { \
+    uint32_t _iterations = getBenchmarkIterations(defaultIterations); \
+    auto _start = std::chrono::steady_clock::now(); \
+    for (uint32_t iteration = 0; iteration < _iterations; iteration++) { \
+      __VA_ARGS__ \
+    } \
+    auto _elapsed = std::chrono::steady_clock::now() - _start; \
+    reportBenchmark(function, model, _iterations, std::chrono::duration_cast<std::chrono::nanoseconds>(_elapsed).count()); \
+  } while (0)
+
+#endif // _BENCHMARKS_H_
@@ -0,0 +1,74 @@
+/*
+ * Copyright (C) OpenTX
+ *
+ * Based on code named
+ *   th9x - http://code.google.com/p/th9x
+ *   er9x - http://code.google.com/p/er9x
+ *   gruvin9x - http://code.google.com/p/gruvin9x
+ *
+ * License GPLv2: http://www.gnu.org/licenses/gpl-2.0.html
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+
+#include "benchmarks.h"
+
+static const BenchmarkModel benchmarkModels[] = {
+  BENCHMARK_MODEL_DEFAULT,
+  BENCHMARK_MODEL_FIXTURE,
+  BENCHMARK_MODEL_WORST_CASE,
+};
+
+TEST(Benchmark, evalMixes)
+{
+  for (auto model: benchmarkModels) {
+    if (!loadBenchmarkModel(model))
+      continue;
+    BENCHMARK_LOOP("evalMixes", model, 20000, {
+      moveBenchmarkInputs(iteration);
+      g_tmr10ms++;
+      evalMixes(1);
+    });
+  }
+}
+
+TEST(Benchmark, evalLogicalSwitches)
+{
+  for (auto model: benchmarkModels) {
+    if (!loadBenchmarkModel(model))
+      continue;
+    BENCHMARK_LOOP("evalLogicalSwitches", model, 100000, {
+      moveBenchmarkInputs(iteration);
+      g_tmr10ms++;
+      evalLogicalSwitches();
+    });
+  }
+}
+
+TEST(Benchmark, applyCurve)
+{
+  // applyCurve() only depends on the curves, the sticks don't need to move
+  static const uint8_t curveTypes[] = { CURVE_REF_DIFF, CURVE_REF_EXPO, CURVE_REF_CUSTOM };
+  static const char * const functions[] = { "applyCurve.diff", "applyCurve.expo", "applyCurve.custom" };
+  volatile int sink = 0;
+
+  loadBenchmarkModel(BENCHMARK_MODEL_WORST_CASE);
+  for (unsigned type = 0; type < DIM(curveTypes); type++) {
+    CurveRef curve;
+    curve.type = curveTypes[type];
+    curve.value = (curveTypes[type] == CURVE_REF_CUSTOM ? 1 : 30);
+    BENCHMARK_LOOP(functions[type], BENCHMARK_MODEL_WORST_CASE, 1000000, {
+      if (curveTypes[type] == CURVE_REF_CUSTOM)
+        curve.value = 1 + (iteration & (MAX_CURVES - 1));
+      sink = sink + applyCurve(int(iteration % (2 * RESX + 1)) - RESX, curve);
+    });
+  }
+}
@@ -0,0 +1,262 @@
+/*
+ * Copyright (C) OpenTX
+ *
+ * Based on code named
+ *   th9x - http://code.google.com/p/th9x
+ *   er9x - http://code.google.com/p/er9x
+ *   gruvin9x - http://code.google.com/p/gruvin9x
+ *
+ * License GPLv2: http://www.gnu.org/licenses/gpl-2.0.html
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#include "benchmarks.h"
+#include "storage/conversions/conversions.h"
+#include "location.h"
+
+#if defined(PCBX9DP)
+  #define BENCHMARK_FIXTURE_EEPROM        TESTS_PATH "/eeprom_23_x9d+.bin"
+  #define BENCHMARK_FIXTURE_VERSION       219
+#elif defined(PCBX7)
+  #define BENCHMARK_FIXTURE_EEPROM        TESTS_PATH "/eeprom_22_x7.bin"
+  #define BENCHMARK_FIXTURE_VERSION       218
+#elif defined(PCBXLITE) && !defined(PCBXLITES)
+  #define BENCHMARK_FIXTURE_EEPROM        TESTS_PATH "/eeprom_22_xlite.bin"
+  #define BENCHMARK_FIXTURE_VERSION       218
+#elif defined(PCBX10) && !defined(RADIO_FAMILY_T16)
+  #define BENCHMARK_FIXTURE_DIRECTORY     TESTS_BUILD_PATH "/model_22_x10/"
+#elif defined(PCBX12S)
+  #define BENCHMARK_FIXTURE_DIRECTORY     TESTS_BUILD_PATH "/model_22_x12s/"
+#endif
+
+const char * getBenchmarkModelName(BenchmarkModel model)
+{
+  switch (model) {
+    case BENCHMARK_MODEL_FIXTURE:
+      return "fixture";
+    case BENCHMARK_MODEL_WORST_CASE:
+      return "worst_case";
+    default:
+      return "default";
+  }
+}
+
+static bool loadFixtureModel()
+{
+#if defined(BENCHMARK_FIXTURE_EEPROM)
+  FILE * f = fopen(BENCHMARK_FIXTURE_EEPROM, "rb");
+  if (!f)
+    return false;
+  bool result = (fread(eeprom, 1, EEPROM_SIZE, f) == EEPROM_SIZE);
+  fclose(f);
+  if (!result)
+    return false;
+
+  eepromOpen();
+  eeLoadGeneralSettingsData();
+#if BENCHMARK_FIXTURE_VERSION == 218
+  convertRadioData_218_to_219(g_eeGeneral);
+  eeConvertModel(0, 218);
+#endif
+  eeLoadModel(0);
+  return true;
+#elif defined(BENCHMARK_FIXTURE_DIRECTORY)
+  simuFatfsSetPaths(BENCHMARK_FIXTURE_DIRECTORY, BENCHMARK_FIXTURE_DIRECTORY);
+  loadRadioSettings("/RADIO/radio.bin");
+  loadModel("model1.bin");
+  return true;
+#else
+  return false;
+#endif
+}
+
+bool loadBenchmarkModel(BenchmarkModel model)
+{
+  SYSTEM_RESET();
+  MODEL_RESET();
+  MIXER_RESET();
+  modelDefault(0);
+  RADIO_RESET();
+  TELEMETRY_RESET();
+
+  switch (model) {
+    case BENCHMARK_MODEL_FIXTURE:
+      if (!loadFixtureModel())
+        return false;
+      RADIO_RESET();
+      break;
+
+    case BENCHMARK_MODEL_WORST_CASE:
+      setupWorstCaseCurves();
+      setupWorstCaseSensors();
+      setupWorstCaseLogicalSwitches();
+      setupWorstCaseMixes();
+      break;
+
+    default:
+      break;
+  }
+
+  storageDirty(EE_MODEL);
+  loadCurves();
+  updateCurvesCache();
+  logicalSwitchesReset();
+  evalMixes(1);
+  return true;
+}
+
+void setupWorstCaseCurves()
+{
+  // alternate 17 points smooth curves and 9 points custom curves until the points buffer is full
+  int8_t * points = g_model.points;
+  for (int i = 0; i < MAX_CURVES; i++) {
+    CurveData & curve = g_model.curves[i];
+    int count;
+    if (i & 1) {
+      curve.type = CURVE_TYPE_CUSTOM;
+      curve.points = 9 - 5;
+    }
+    else {
+      curve.type = CURVE_TYPE_STANDARD;
+      curve.points = 17 - 5;
+    }
+    curve.smooth = (i % 4 == 0);
+    count = curve.points + 5;
+
+    int size = (curve.type == CURVE_TYPE_CUSTOM ? 2 * count - 2 : count);
+    if (points + size > g_model.points + MAX_CURVE_POINTS - 5 * (MAX_CURVES - i - 1)) {
+      curve.type = CURVE_TYPE_STANDARD;
+      curve.smooth = 0;
+      curve.points = 0;
+      size = count = 5;
+    }
+
+    for (int j = 0; j < count; j++) {
+      points[j] = -100 + (200 * j * j) / ((count - 1) * (count - 1)) - i;
+    }
+    if (curve.type == CURVE_TYPE_CUSTOM) {
+      resetCustomCurveX(points, count);
+    }
+    points += size;
+  }
+}
+
+void setupWorstCaseSensors()
+{
+  allowNewSensors = true;
+  for (int i = 0; i < MAX_TELEMETRY_SENSORS; i++) {
+    setTelemetryValue(PROTOCOL_TELEMETRY_FRSKY_SPORT, DIY_FIRST_ID + i, 0, i % 4, 100 * i, UNIT_RAW, 0);
+  }
+  allowNewSensors = false;
+}
+
+void setupWorstCaseLogicalSwitches()
+{
+  static const uint8_t functions[] = {
+    LS_FUNC_VPOS, LS_FUNC_APOS, LS_FUNC_RANGE, LS_FUNC_VALMOSTEQUAL,
+    LS_FUNC_GREATER, LS_FUNC_DIFFEGREATER, LS_FUNC_ADIFFEGREATER, LS_FUNC_TIMER,
+    LS_FUNC_STICKY, LS_FUNC_EDGE, LS_FUNC_AND, LS_FUNC_XOR,
+  };
+
+  for (int i = 0; i < MAX_LOGICAL_SWITCHES; i++) {
+    LogicalSwitchData & ls = g_model.logicalSw[i];
+    ls.func = functions[i % DIM(functions)];
+    switch (lswFamily(ls.func)) {
+      case LS_FAMILY_OFS:
+      case LS_FAMILY_RANGE:
+      case LS_FAMILY_DIFF:
+        // a third of them compare telemetry values
+        ls.v1 = (i % 3 == 0 ? MIXSRC_FIRST_TELEM + 3 * (i % MAX_TELEMETRY_SENSORS) : MIXSRC_FIRST_STICK + (i % NUM_STICKS));
+        ls.v2 = (i % 3 == 0 ? 10 * i : -50 + i);
+        ls.v3 = 5;
+        break;
+      case LS_FAMILY_COMP:
+        ls.v1 = MIXSRC_FIRST_STICK + (i % NUM_STICKS);
+        ls.v2 = MIXSRC_FIRST_POT + (i % NUM_POTS);
+        break;
+      case LS_FAMILY_TIMER:
+        ls.v1 = 1;
+        ls.v2 = 2;
+        break;
+      case LS_FAMILY_STICKY:
+        ls.v1 = SWSRC_FIRST_SWITCH + i % 3;
+        ls.v2 = (i > 0 ? SWSRC_FIRST_LOGICAL_SWITCH + i - 1 : SWSRC_NONE);
+        break;
+      case LS_FAMILY_EDGE:
+        ls.v1 = (i > 0 ? SWSRC_FIRST_LOGICAL_SWITCH + i - 1 : SWSRC_SA0);
+        ls.v2 = 0;
+        ls.v3 = 10;
+        break;
+      default:
+        // chain with the previous switches
+        ls.v1 = (i > 0 ? SWSRC_FIRST_LOGICAL_SWITCH + i - 1 : SWSRC_SA0);
+        ls.v2 = (i > 1 ? SWSRC_FIRST_LOGICAL_SWITCH + i - 2 : SWSRC_SA2);
+        break;
+    }
+    ls.andsw = (i % 5 == 0 ? SWSRC_FIRST_SWITCH + i % 3 : SWSRC_NONE);
+    ls.delay = (i % 7 == 0 ? 2 : 0);
+    ls.duration = (i % 11 == 0 ? 5 : 0);
+  }
+}
+
+void setupWorstCaseMixes()
+{
+  // 2 input lines per input, the second one only active on a logical switch
+  for (int i = 0; i < MAX_EXPOS; i++) {
+    ExpoData * expo = expoAddress(i);
+    expo->chn = i / 2;
+    expo->srcRaw = MIXSRC_FIRST_STICK + (i / 2) % NUM_STICKS;
+    expo->mode = 3;
+    expo->weight = 100 - i;
+    expo->offset = i % 10;
+    expo->carryTrim = 0;
+    expo->swtch = (i & 1) ? SWSRC_FIRST_LOGICAL_SWITCH + i : SWSRC_NONE;
+    expo->curve.type = (i & 1) ? CURVE_REF_CUSTOM : CURVE_REF_EXPO;
+    expo->curve.value = (i & 1) ? 1 + (i % MAX_CURVES) : 30;
+  }
+
+  // 2 mix lines per channel, each one with a curve, and slow / delays on a half of them
+  for (int i = 0; i < MAX_MIXERS; i++) {
+    MixData * mix = mixAddress(i);
+    mix->destCh = i / 2;
+    if (i & 1) {
+      mix->srcRaw = MIXSRC_FIRST_TELEM + 3 * (i % MAX_TELEMETRY_SENSORS);
+      mix->mltpx = (i % 4 == 1 ? MLTPX_MUL : MLTPX_ADD);
+      mix->swtch = SWSRC_FIRST_LOGICAL_SWITCH + i;
+      mix->flightModes = (i % 3 == 0 ? 0x02 : 0);
+    }
+    else {
+      mix->srcRaw = MIXSRC_FIRST_INPUT + i / 2;
+      mix->carryTrim = 0;
+    }
+    mix->weight = 100 - i;
+    mix->offset = i;
+    mix->curve.type = (i % 3 == 0 ? CURVE_REF_CUSTOM : CURVE_REF_DIFF);
+    mix->curve.value = (i % 3 == 0 ? 1 + (i % MAX_CURVES) : 20);
+    if (i % 4 == 2) {
+      mix->speedUp = 10;
+      mix->speedDown = 10;
+      mix->delayUp = 5;
+      mix->delayDown = 5;
+    }
+  }
+}
+
+void moveBenchmarkInputs(uint32_t iteration)
+{
+  for (int i = 0; i < NUM_STICKS+NUM_POTS+NUM_SLIDERS; i++) {
+    // triangle waves with different periods
+    uint32_t period = 64 + 16 * i;
+    uint32_t phase = (iteration + 7 * i) % period;
+    uint32_t value = (phase < period / 2 ? phase : period - phase) * 4096 / period;
+    anaInValues[i] = (value > 2047 ? 2047 : value);
+  }
+}
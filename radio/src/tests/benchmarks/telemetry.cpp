@@ -0,0 +1,37 @@
+/*
+ * Copyright (C) OpenTX
+ *
+ * Based on code named
+ *   th9x - http://code.google.com/p/th9x
+ *   er9x - http://code.google.com/p/er9x
+ *   gruvin9x - http://code.google.com/p/gruvin9x
+ *
+ * License GPLv2: http://www.gnu.org/licenses/gpl-2.0.html
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+
+#include "benchmarks.h"
+
+TEST(Benchmark, setTelemetryValue)
+{
+  // every sensor of the worst-case model updated in turn, as on a busy S.PORT bus
+  loadBenchmarkModel(BENCHMARK_MODEL_WORST_CASE);
+  BENCHMARK_LOOP("setTelemetryValue", BENCHMARK_MODEL_WORST_CASE, 1000000, {
+    uint32_t sensor = iteration % MAX_TELEMETRY_SENSORS;
+    setTelemetryValue(PROTOCOL_TELEMETRY_FRSKY_SPORT, DIY_FIRST_ID + sensor, 0, sensor % 4, iteration, UNIT_RAW, 0);
+  });
+
+  // frames from a device without any sensor declared
+  BENCHMARK_LOOP("setTelemetryValue.unknown", BENCHMARK_MODEL_WORST_CASE, 1000000, {
+    setTelemetryValue(PROTOCOL_TELEMETRY_FRSKY_SPORT, DIY_LAST_ID, 0, 0, iteration, UNIT_RAW, 0);
+  });
+}
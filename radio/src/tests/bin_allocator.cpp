@@ -0,0 +1,59 @@
+/*
+ * Copyright (C) OpenTX
+ *
+ * Based on code named
+ *   th9x - http://code.google.com/p/th9x 
+ *   er9x - http://code.google.com/p/er9x
+ *   gruvin9x - http://code.google.com/p/gruvin9x
+ *
+ * License GPLv2: http://www.gnu.org/licenses/gpl-2.0.html
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#include "gtests.h"
+#include "bin_allocator.h"
+
+TEST(BinAllocator, mallocFree)
+{
+  static BinAllocator<32, 4> allocator;
+  allocator.clear();
+
+  void * slots[4];
+  for (int i = 0; i < 4; i++) {
+    slots[i] = allocator.malloc(i * 8);
+    ASSERT_NE(slots[i], nullptr);
+    EXPECT_EQ(0u, (uintptr_t)slots[i] & 3);
+    EXPECT_TRUE(allocator.is_member(slots[i]));
+  }
+  EXPECT_EQ(4u, allocator.size());
+  EXPECT_EQ(nullptr, allocator.malloc(1));
+  EXPECT_EQ(1u, allocator.failures());
+
+  EXPECT_EQ(nullptr, allocator.malloc(33));
+  EXPECT_EQ(1u, allocator.failures());
+
+  // the last freed slot is reused first
+  EXPECT_TRUE(allocator.free(slots[2]));
+  EXPECT_TRUE(allocator.free(slots[0]));
+  EXPECT_EQ(2u, allocator.size());
+  EXPECT_EQ(slots[0], allocator.malloc(16));
+  EXPECT_EQ(slots[2], allocator.malloc(16));
+
+  int outside;
+  EXPECT_FALSE(allocator.is_member(&outside));
+  EXPECT_FALSE(allocator.free(&outside));
+
+  for (int i = 0; i < 4; i++) {
+    EXPECT_TRUE(allocator.free(slots[i]));
+  }
+  EXPECT_EQ(0u, allocator.size());
+  EXPECT_EQ(4u, allocator.highWaterMark());
+}
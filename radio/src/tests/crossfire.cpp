@@ -43,5 +43,37 @@ TEST(Crossfire, crc8)
   uint8_t crc = crc8(&frame[2], frame[1]-1);
   ASSERT_EQ(frame[frame[1]+1], crc);
 }
+
+TEST(Crossfire, framesSplitAcrossSpans)
+{
+  MODEL_RESET();
+  TELEMETRY_RESET();
+  telemetryStreaming = TELEMETRY_TIMEOUT10ms;
+  allowNewSensors = true;
+  telemetryRxBufferCount = 0;
+
+  // garbage, then 2 vario frames (-1.5m/s, then 2.5m/s)
+  uint8_t data[] = { 0x12, 0x34, 0x00,
+                     RADIO_ADDRESS, 0x04, CF_VARIO_ID, 0xFF, 0x6A, 0x00,
+                     RADIO_ADDRESS, 0x04, CF_VARIO_ID, 0x00, 0xFA, 0x00 };
+  data[8] = crc8(&data[5], 3);
+  data[14] = crc8(&data[11], 3);
+
+  // the first frame ends in the second span, the second frame is complete in the third one
+  processCrossfireTelemetryData(data, 5);
+  EXPECT_EQ(0, telemetryItems[0].value);
+  processCrossfireTelemetryData(data + 5, 4);
+  EXPECT_EQ(-15, telemetryItems[0].value);
+  processCrossfireTelemetryData(data + 9, 6);
+  EXPECT_EQ(25, telemetryItems[0].value);
+  EXPECT_EQ(0, telemetryRxBufferCount);
+
+  // a bad CRC is dropped
+  data[14] ^= 0xFF;
+  processCrossfireTelemetryData(data + 9, 6);
+  EXPECT_EQ(25, telemetryItems[0].value);
+
+  allowNewSensors = false;
+}
 #endif
 
@@ -0,0 +1,143 @@
+/*
+ * Copyright (C) OpenTX
+ *
+ * Based on code named
+ *   th9x - http://code.google.com/p/th9x
+ *   er9x - http://code.google.com/p/er9x
+ *   gruvin9x - http://code.google.com/p/gruvin9x
+ *
+ * License GPLv2: http://www.gnu.org/licenses/gpl-2.0.html
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#include "gtests.h"
+
+#if defined(DISK_CACHE)
+
+#define RAM_DISK_SECTORS    (4 * DISK_CACHE_BLOCKS_NUM * DISK_CACHE_BLOCK_SECTORS)
+
+static uint8_t ramDisk[RAM_DISK_SECTORS * BLOCK_SIZE];
+
+DRESULT simuDiskRead(BYTE drv, BYTE * buff, DWORD sector, UINT count)
+{
+  memcpy(buff, &ramDisk[sector * BLOCK_SIZE], count * BLOCK_SIZE);
+  return RES_OK;
+}
+
+DRESULT simuDiskWrite(BYTE drv, const BYTE * buff, DWORD sector, UINT count)
+{
+  memcpy(&ramDisk[sector * BLOCK_SIZE], buff, count * BLOCK_SIZE);
+  return RES_OK;
+}
+
+uint32_t simuDiskSectors()
+{
+  return RAM_DISK_SECTORS;
+}
+
+class DiskCacheTest : public testing::Test
+{
+  protected:
+    void SetUp() override
+    {
+      diskCache.clear();
+      memset(ramDisk, 0, sizeof(ramDisk));
+    }
+
+    static void fillSector(uint8_t * buff, uint8_t value, UINT count=1)
+    {
+      memset(buff, value, count * BLOCK_SIZE);
+    }
+
+    static bool diskSectorIs(DWORD sector, uint8_t value)
+    {
+      for (int i=0; i<BLOCK_SIZE; i++) {
+        if (ramDisk[sector * BLOCK_SIZE + i] != value)
+          return false;
+      }
+      return true;
+    }
+
+    uint8_t buffer[2 * DISK_CACHE_BLOCK_SIZE];
+};
+
+TEST_F(DiskCacheTest, readAfterWrite)
+{
+  // the block is cached, the write is deferred
+  EXPECT_EQ(RES_OK, diskCache.read(0, buffer, 5, 1));
+  fillSector(buffer, 0x55);
+  EXPECT_EQ(RES_OK, diskCache.write(0, buffer, 5, 1));
+  EXPECT_TRUE(diskSectorIs(5, 0));
+
+  // the cached copy is read
+  fillSector(buffer, 0);
+  EXPECT_EQ(RES_OK, diskCache.read(0, buffer, 4, 2));
+  EXPECT_EQ(0x00, buffer[0]);
+  EXPECT_EQ(0x55, buffer[BLOCK_SIZE]);
+
+  // a read bypassing the cache writes the pending sectors first
+  EXPECT_EQ(RES_OK, diskCache.read(0, buffer, 0, 2 * DISK_CACHE_BLOCK_SECTORS));
+  EXPECT_EQ(0x55, buffer[5 * BLOCK_SIZE]);
+  EXPECT_TRUE(diskSectorIs(5, 0x55));
+
+  // a write bypassing the cache updates the cached copy
+  fillSector(buffer, 0xAA, 2 * DISK_CACHE_BLOCK_SECTORS);
+  EXPECT_EQ(RES_OK, diskCache.write(0, buffer, 0, 2 * DISK_CACHE_BLOCK_SECTORS));
+  fillSector(buffer, 0);
+  EXPECT_EQ(RES_OK, diskCache.read(0, buffer, 5, 1));
+  EXPECT_EQ(0xAA, buffer[0]);
+}
+
+TEST_F(DiskCacheTest, fileSystemWrittenThrough)
+{
+  EXPECT_EQ(RES_OK, diskCache.read(0, buffer, 0, 1));
+  fillSector(buffer, 0x55);
+  EXPECT_EQ(RES_OK, diskCache.write(0, buffer, 3, 1));
+  EXPECT_TRUE(diskSectorIs(3, 0));
+
+  // a FAT or directory sector reaches the card at once, after the file data
+  fillSector(g_FATFS_Obj.win, 0xAA);
+  EXPECT_EQ(RES_OK, diskCache.write(0, g_FATFS_Obj.win, 1, 1));
+  EXPECT_TRUE(diskSectorIs(1, 0xAA));
+  EXPECT_TRUE(diskSectorIs(3, 0x55));
+}
+
+TEST_F(DiskCacheTest, flushOnClear)
+{
+  EXPECT_EQ(RES_OK, diskCache.read(0, buffer, 16, 1));
+  fillSector(buffer, 0x55);
+  EXPECT_EQ(RES_OK, diskCache.write(0, buffer, 20, 1));
+  EXPECT_TRUE(diskSectorIs(20, 0));
+
+  diskCache.clear();
+  EXPECT_TRUE(diskSectorIs(20, 0x55));
+
+  // nothing is cached anymore, the card content is read
+  memset(&ramDisk[20 * BLOCK_SIZE], 0xAA, BLOCK_SIZE);
+  EXPECT_EQ(RES_OK, diskCache.read(0, buffer, 20, 1));
+  EXPECT_EQ(0xAA, buffer[0]);
+}
+
+TEST_F(DiskCacheTest, writeBackDelay)
+{
+  EXPECT_EQ(RES_OK, diskCache.read(0, buffer, 0, 1));
+  fillSector(buffer, 0x55);
+  EXPECT_EQ(RES_OK, diskCache.write(0, buffer, 2, 1));
+
+  diskCache.wakeup(0);
+  EXPECT_TRUE(diskSectorIs(2, 0));
+
+  g_tmr10ms += DISK_CACHE_WRITE_BACK_DELAY;
+  diskCache.wakeup(0);
+  EXPECT_TRUE(diskSectorIs(2, 0x55));
+}
+
+#endif // #if defined(DISK_CACHE)
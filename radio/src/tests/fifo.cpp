@@ -0,0 +1,101 @@
+/*
+ * Copyright (C) OpenTX
+ *
+ * Based on code named
+ *   th9x - http://code.google.com/p/th9x 
+ *   er9x - http://code.google.com/p/er9x
+ *   gruvin9x - http://code.google.com/p/gruvin9x
+ *
+ * License GPLv2: http://www.gnu.org/licenses/gpl-2.0.html
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#include "gtests.h"
+#include "fifo.h"
+
+TEST(Fifo, pushPop)
+{
+  Fifo<uint8_t, 8> fifo;
+  uint8_t byte;
+
+  EXPECT_FALSE(fifo.pop(byte));
+  for (int i = 0; i < 10; i++) {
+    fifo.push(i);
+  }
+  EXPECT_TRUE(fifo.isFull());
+  EXPECT_EQ(7u, fifo.size());
+  EXPECT_EQ(3u, fifo.getOverflows());
+  EXPECT_EQ(7u, fifo.getHighWater());
+
+  for (int i = 0; i < 7; i++) {
+    EXPECT_TRUE(fifo.pop(byte));
+    EXPECT_EQ(i, byte);
+  }
+  EXPECT_TRUE(fifo.isEmpty());
+
+  fifo.resetStats();
+  EXPECT_EQ(0u, fifo.getOverflows());
+  EXPECT_EQ(0u, fifo.getHighWater());
+}
+
+TEST(Fifo, pushManyPopMany)
+{
+  Fifo<uint8_t, 16> fifo;
+  uint8_t data[20];
+  for (int i = 0; i < 20; i++) {
+    data[i] = i;
+  }
+
+  // move the indexes so that the next pushes wrap
+  EXPECT_EQ(10u, fifo.pushMany(data, 10));
+  uint8_t result[20];
+  EXPECT_EQ(10u, fifo.popMany(result, 20));
+  EXPECT_EQ(0, memcmp(data, result, 10));
+
+  EXPECT_EQ(15u, fifo.pushMany(data, 20));
+  EXPECT_EQ(5u, fifo.getOverflows());
+  EXPECT_EQ(0u, fifo.freeSpace());
+
+  EXPECT_EQ(4u, fifo.popMany(result, 4));
+  EXPECT_EQ(0, memcmp(data, result, 4));
+  EXPECT_EQ(11u, fifo.popMany(result, 20));
+  EXPECT_EQ(0, memcmp(data + 4, result, 11));
+  EXPECT_TRUE(fifo.isEmpty());
+}
+
+TEST(Fifo, span)
+{
+  Fifo<uint8_t, 16> fifo;
+  uint8_t data[12];
+  for (int i = 0; i < 12; i++) {
+    data[i] = i;
+  }
+
+  fifo.pushMany(data, 12);
+  fifo.skip(12);
+  fifo.pushMany(data, 12);
+
+  // the data wraps, it comes in 2 spans
+  uint32_t count;
+  const uint8_t * span = fifo.span(count);
+  EXPECT_EQ(4u, count);
+  EXPECT_EQ(0, memcmp(data, span, 4));
+  fifo.skip(count);
+
+  span = fifo.span(count);
+  EXPECT_EQ(8u, count);
+  EXPECT_EQ(0, memcmp(data + 4, span, 8));
+  fifo.skip(count);
+
+  span = fifo.span(count);
+  EXPECT_EQ(0u, count);
+  EXPECT_TRUE(fifo.isEmpty());
+}
@@ -496,3 +496,39 @@ TEST(FrSkySPORT, frskyCurrent)
   EXPECT_EQ(telemetryItems[0].valueMax, 505);
 }
 
+
+TEST(FrSkySPORT, sensorsIndexFollowsEdits)
+{
+  MODEL_RESET();
+  TELEMETRY_RESET();
+  telemetryStreaming = TELEMETRY_TIMEOUT10ms;
+  telemetryData.telemetryValid = 0x07;
+  allowNewSensors = true;
+
+  // same id from two different physical ids
+  setTelemetryValue(PROTOCOL_TELEMETRY_FRSKY_SPORT, RPM_FIRST_ID, 0, 1, 1000, UNIT_RPMS, 0);
+  setTelemetryValue(PROTOCOL_TELEMETRY_FRSKY_SPORT, RPM_FIRST_ID, 0, 2, 2000, UNIT_RPMS, 0);
+  EXPECT_EQ(telemetryItems[0].value, 1000);
+  EXPECT_EQ(telemetryItems[1].value, 2000);
+  EXPECT_EQ(lastUsedTelemetryIndex(), 1);
+
+  // the second sensor is edited
+  allowNewSensors = false;
+  g_model.telemetrySensors[1].id = RPM_FIRST_ID + 1;
+  storageDirty(EE_MODEL);
+
+  setTelemetryValue(PROTOCOL_TELEMETRY_FRSKY_SPORT, RPM_FIRST_ID + 1, 0, 2, 3000, UNIT_RPMS, 0);
+  setTelemetryValue(PROTOCOL_TELEMETRY_FRSKY_SPORT, RPM_FIRST_ID, 0, 2, 4000, UNIT_RPMS, 0);
+  setTelemetryValue(PROTOCOL_TELEMETRY_FRSKY_SPORT, RPM_FIRST_ID, 0, 1, 5000, UNIT_RPMS, 0);
+  EXPECT_EQ(telemetryItems[0].value, 5000);
+  EXPECT_EQ(telemetryItems[1].value, 3000);
+
+  // model reset without any notification, discovery must not duplicate sensors
+  MODEL_RESET();
+  TELEMETRY_RESET();
+  allowNewSensors = true;
+  setTelemetryValue(PROTOCOL_TELEMETRY_FRSKY_SPORT, RPM_FIRST_ID, 0, 2, 6000, UNIT_RPMS, 0);
+  setTelemetryValue(PROTOCOL_TELEMETRY_FRSKY_SPORT, RPM_FIRST_ID, 0, 2, 7000, UNIT_RPMS, 0);
+  EXPECT_EQ(telemetryItems[0].value, 7000);
+  EXPECT_EQ(lastUsedTelemetryIndex(), 0);
+}
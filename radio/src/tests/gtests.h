@@ -79,6 +79,7 @@ inline void MIXER_RESET()
   mixerCurrentFlightMode = lastFlightMode = 0;
   lastAct = 0;
   logicalSwitchesReset();
+  invalidateMixerPlan();
 }
 
 inline void TELEMETRY_RESET()
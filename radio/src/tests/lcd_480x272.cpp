@@ -181,4 +181,60 @@ TEST(Lcd_480x272, fonts)
 }
 
 
+TEST(Lcd_480x272, dirtyRegion)
+{
+  lcd->clearDirtyRegion();
+  EXPECT_TRUE(lcd->getDirtyRegion().isEmpty());
+
+  // touching rectangles are merged
+  lcdDrawSolidFilledRect(10, 10, 20, 20, TEXT_COLOR);
+  lcdDrawSolidFilledRect(30, 10, 10, 20, TEXT_COLOR);
+  EXPECT_EQ(lcd->getDirtyRegion().getCount(), 1);
+  EXPECT_EQ(lcd->getDirtyRegion().getRect(0).left, 10);
+  EXPECT_EQ(lcd->getDirtyRegion().getRect(0).right, 40);
+  EXPECT_EQ(lcd->getDirtyRegion().getArea(), 30u * 20u);
+
+  // already covered
+  lcdDrawSolidHorizontalLine(15, 15, 10, TEXT_COLOR);
+  EXPECT_EQ(lcd->getDirtyRegion().getCount(), 1);
+
+  // clipped to the screen
+  lcdDrawSolidFilledRect(LCD_W-5, LCD_H-5, 20, 20, TEXT_COLOR);
+  EXPECT_EQ(lcd->getDirtyRegion().getCount(), 2);
+  EXPECT_EQ(lcd->getDirtyRegion().getArea(), 30u * 20u + 5u * 5u);
+
+  // the number of rectangles is bounded, the region still covers all the drawings
+  lcd->clearDirtyRegion();
+  for (int i=0; i<DIRTY_RECTS_MAX+4; i++) {
+    lcdDrawSolidFilledRect(i*20, 100 + (i%3)*30, 4, 4, TEXT_COLOR);
+  }
+  const DirtyRegion & region = lcd->getDirtyRegion();
+  EXPECT_LE(region.getCount(), DIRTY_RECTS_MAX);
+  for (int i=0; i<DIRTY_RECTS_MAX+4; i++) {
+    bool covered = false;
+    for (uint8_t j=0; j<region.getCount(); j++) {
+      const DirtyRegion::Rect & rect = region.getRect(j);
+      if (rect.left <= i*20 && rect.right >= i*20+4 && rect.top <= 100 + (i%3)*30 && rect.bottom >= 104 + (i%3)*30) {
+        covered = true;
+      }
+    }
+    EXPECT_TRUE(covered);
+  }
+
+  // single pixels, by coordinates or by address
+  lcd->clearDirtyRegion();
+  lcd->drawPixel(100, 50, 0);
+  EXPECT_EQ(lcd->getDirtyRegion().getArea(), 1u);
+  EXPECT_EQ(lcd->getDirtyRegion().getRect(0).left, 100);
+  EXPECT_EQ(lcd->getDirtyRegion().getRect(0).top, 50);
+  lcd->clearDirtyRegion();
+  lcd->drawPixel(lcd->getPixelPtr(200, 60), 0);
+  EXPECT_EQ(lcd->getDirtyRegion().getArea(), 1u);
+  EXPECT_EQ(lcd->getDirtyRegion().getRect(0).left, 200);
+  EXPECT_EQ(lcd->getDirtyRegion().getRect(0).top, 60);
+
+  lcd->invalidate();
+  EXPECT_EQ(lcd->getDirtyRegion().getArea(), uint32_t(LCD_W * LCD_H));
+}
+
 #endif
@@ -0,0 +1,136 @@
+/*
+ * Copyright (C) OpenTX
+ *
+ * Based on code named
+ *   th9x - http://code.google.com/p/th9x
+ *   er9x - http://code.google.com/p/er9x
+ *   gruvin9x - http://code.google.com/p/gruvin9x
+ *
+ * License GPLv2: http://www.gnu.org/licenses/gpl-2.0.html
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#include "gtests.h"
+
+#if defined(LOGS_BINARY) && defined(RTCLOCK) && (defined(PCBTARANIS) || defined(PCBHORUS))
+
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include "binarylog.h"
+
+const char * logsOpen();
+bool logsWriteRecord(tmr10ms_t tmr10ms);
+int getSwitchState(uint8_t swtch);
+uint32_t getLogicalSwitchesStates(uint8_t first);
+
+// the line the CSV logs writer gives for the current state
+static QString csvRecord(const char * time, const char * altitude)
+{
+  QString line = QString("%1,%2,").arg(time).arg(altitude);
+  for (uint8_t i=0; i<NUM_STICKS+NUM_POTS+NUM_SLIDERS; i++) {
+    line += QString("%1,").arg(calibratedAnalogs[i]);
+  }
+  for (uint8_t i=0; i<NUM_SWITCHES; i++) {
+    if (SWITCH_EXISTS(i)) {
+      line += QString("%1,").arg(getSwitchState(i));
+    }
+  }
+  line += "0x" + QString("%1%2,").arg(getLogicalSwitchesStates(32), 8, 16, QChar('0')).arg(getLogicalSwitchesStates(0), 8, 16, QChar('0')).toUpper();
+  line += QString("%1.%2").arg(g_vbat100mV / 10).arg(g_vbat100mV % 10);
+  return line;
+}
+
+class LogsTest : public OpenTxTest {};
+
+TEST_F(LogsTest, binaryRoundTrip)
+{
+  extern std::string simuSdDirectory;
+
+  TELEMETRY_RESET();
+  str2zchar(g_model.header.name, "log", sizeof(g_model.header.name));
+  TelemetrySensor & sensor = g_model.telemetrySensors[0];
+  str2zchar(sensor.label, "Alt", TELEM_LABEL_LEN);
+  sensor.unit = UNIT_METERS;
+  sensor.prec = 1;
+  sensor.logs = 1;
+
+  char tmpl[] = "/tmp/opentx-logs-XXXXXX";
+  ASSERT_NE(nullptr, mkdtemp(tmpl));
+  std::string sdDirectory = simuSdDirectory;
+  simuSdDirectory = tmpl;
+
+  QStringList expected;
+
+  // 2020-05-01 10:00:00.10 UTC
+  g_rtcTime = 1588327200;
+  g_ms100 = 10;
+  telemetryItems[0].value = 123;
+  for (uint8_t i=0; i<NUM_STICKS+NUM_POTS+NUM_SLIDERS; i++) {
+    calibratedAnalogs[i] = i * 100 - 200;
+  }
+  g_vbat100mV = 82;
+  EXPECT_EQ(nullptr, logsOpen());
+  EXPECT_TRUE(logsWriteRecord(0));
+  expected << csvRecord("2020-05-01,10:00:00.100", "12.3");
+
+  // only the sensor and the time change
+  g_ms100 = 20;
+  telemetryItems[0].value = -123;
+  EXPECT_TRUE(logsWriteRecord(0));
+  expected << csvRecord("2020-05-01,10:00:00.200", "-12.3");
+
+  // large deltas, more than one sector of records
+  for (int i=0; i<500; i++) {
+    g_rtcTime += 3600;
+    telemetryItems[0].value = (i & 1) ? -100000 * i : 100000 * i;
+    calibratedAnalogs[0] = (i & 1) ? -1024 : 1024;
+    g_vbat100mV = 60 + i % 30;
+    EXPECT_TRUE(logsWriteRecord(0));
+    expected << csvRecord(QDateTime::fromTime_t(g_rtcTime, Qt::UTC).toString("yyyy-MM-dd,HH:mm:ss.200").toLatin1().constData(),
+                          QString("%1%2.0").arg(i & 1 ? "-" : "").arg(10000 * i).toLatin1().constData());
+  }
+  logsClose();
+
+  // the file is appended to, after a new schema all the values start again from 0
+  g_rtcTime = 1588327200;
+  g_ms100 = 0;
+  EXPECT_EQ(nullptr, logsOpen());
+  EXPECT_TRUE(logsWriteRecord(0));
+  expected << csvRecord("2020-05-01,10:00:00.000", "-4990000.0");
+  logsClose();
+
+  QDir logs(QString(tmpl) + LOGS_PATH);
+  QStringList files = logs.entryList(QDir::Files);
+  ASSERT_EQ(1, files.size());
+  QFile file(logs.filePath(files.at(0)));
+  ASSERT_TRUE(file.open(QIODevice::ReadOnly));
+  QByteArray content = file.readAll();
+  file.close();
+
+  BinaryLogReader reader;
+  QStringList lines;
+  EXPECT_TRUE(reader.toCsv(content, lines));
+  ASSERT_EQ(expected.size() + 1, lines.size());
+
+  // the same schema is only given once
+  EXPECT_TRUE(lines.at(0).startsWith("Date,Time,Alt(m),"));
+  EXPECT_TRUE(lines.at(0).endsWith(",LSW,TxBat(V)"));
+  EXPECT_EQ(expected.at(0).count(','), lines.at(0).count(','));
+  for (int i=0; i<expected.size(); i++) {
+    EXPECT_EQ(expected.at(i).toStdString(), lines.at(i + 1).toStdString());
+  }
+
+  simuSdDirectory = sdDirectory;
+  EXPECT_TRUE(QDir(tmpl).removeRecursively());
+}
+
+#endif // #if defined(LOGS_BINARY) && defined(RTCLOCK) && (defined(PCBTARANIS) || defined(PCBHORUS))
@@ -19,6 +19,8 @@
  */
 
 #include <math.h>
+#include <sys/stat.h>
+#include <utime.h>
 #include "gtests.h"
 
 #if defined(LUA)
@@ -163,4 +165,339 @@ TEST(Lua, testModelInputs)
 
 }
 
+TEST(Lua, testReadOnlyTables)
+{
+  luaExecStr("if lcd == nil or model == nil or math == nil then error('tables') end");
+  luaExecStr("if lcd.clear == nil or model.getInfo == nil or math.floor == nil or string.format == nil then error('functions') end");
+  luaExecStr("if getValue == nil or print == nil or tostring == nil then error('globals') end");
+  luaExecStr("if EVT_EXIT_BREAK == nil or math.abs(math.pi - 3.14159265) > 0.0001 then error('values') end");
+  luaExecStr("if unknownGlobal ~= nil or lcd.unknownFunction ~= nil then error('unknown') end");
+  luaExecStr("myGlobal = 42 if myGlobal ~= 42 then error('user global') end");
+}
+
+static int luaTestFunction1(lua_State * L) { return 1; }
+static int luaTestFunction2(lua_State * L) { return 2; }
+
+struct RotableEntry {
+  int type;
+  const void * pointer;
+  lua_Number number;
+
+  bool operator == (const RotableEntry & other) const
+  {
+    return type == other.type && pointer == other.pointer && number == other.number;
+  }
+};
+
+static RotableEntry rotableEntry(luaR_result found, const TValue & val)
+{
+  if (!found)
+    return { LUA_TNIL, nullptr, 0 };
+  if (ttislightfunction(&val))
+    return { LUA_TLIGHTFUNCTION, lfvalue(&val), 0 };
+  if (ttisrotable(&val))
+    return { LUA_TROTABLE, rvalue(&val), 0 };
+  return { LUA_TNUMBER, nullptr, nvalue(&val) };
+}
+
+// linear search of a key in a table, functions first
+static RotableEntry rotableFindEntry(const luaR_table * table, const char * key)
+{
+  for (const luaL_Reg * pf = table->pfuncs; pf && pf->name; pf++) {
+    if (!strcmp(pf->name, key))
+      return { LUA_TLIGHTFUNCTION, (const void *)pf->func, 0 };
+  }
+  for (const luaR_value_entry * pv = table->pvalues; pv && pv->name; pv++) {
+    if (!strcmp(pv->name, key))
+      return { LUA_TNUMBER, nullptr, pv->value };
+  }
+  return { LUA_TNIL, nullptr, 0 };
+}
+
+// linear search of a global, the tables and the entries of the "__" tables in their order
+static RotableEntry rotableFindGlobal(const luaR_table * tables, const char * name)
+{
+  for (const luaR_table * table = tables; table->name; table++) {
+    if (!strcmp(table->name, name))
+      return { LUA_TROTABLE, table, 0 };
+    if (!strncmp(table->name, "__", 2)) {
+      RotableEntry entry = rotableFindEntry(table, name);
+      if (entry.type != LUA_TNIL)
+        return entry;
+    }
+  }
+  return { LUA_TNIL, nullptr, 0 };
+}
+
+// the index gives the same results as a linear search, for all the names of the tables
+static void checkReadOnlyTablesIndex(const luaR_table * tables)
+{
+  TValue val;
+  for (const luaR_table * table = tables; table->name; table++) {
+    luaR_result found = luaR_findglobal(table->name, &val);
+    EXPECT_TRUE(rotableFindGlobal(tables, table->name) == rotableEntry(found, val)) << table->name;
+    for (const luaL_Reg * pf = table->pfuncs; pf && pf->name; pf++) {
+      found = luaR_findentry((void *)table, pf->name, &val);
+      EXPECT_TRUE(rotableFindEntry(table, pf->name) == rotableEntry(found, val)) << table->name << "." << pf->name;
+      found = luaR_findglobal(pf->name, &val);
+      EXPECT_TRUE(rotableFindGlobal(tables, pf->name) == rotableEntry(found, val)) << pf->name;
+    }
+    for (const luaR_value_entry * pv = table->pvalues; pv && pv->name; pv++) {
+      found = luaR_findentry((void *)table, pv->name, &val);
+      EXPECT_TRUE(rotableFindEntry(table, pv->name) == rotableEntry(found, val)) << table->name << "." << pv->name;
+      found = luaR_findglobal(pv->name, &val);
+      EXPECT_TRUE(rotableFindGlobal(tables, pv->name) == rotableEntry(found, val)) << pv->name;
+    }
+  }
+}
+
+TEST(Lua, testReadOnlyTablesPriorities)
+{
+  static const luaL_Reg firstFunctions[] = { {"shadowed", luaTestFunction1}, {"dup", luaTestFunction1}, {"dup", luaTestFunction2}, {nullptr, nullptr} };
+  static const luaR_value_entry firstValues[] = { {"dup", 3}, {"value", 1}, {"value", 2}, {nullptr, 0} };
+  static const luaL_Reg tableFunctions[] = { {"f", luaTestFunction2}, {nullptr, nullptr} };
+  static const luaL_Reg lastFunctions[] = { {"other", luaTestFunction2}, {"late", luaTestFunction1}, {nullptr, nullptr} };
+  static const luaR_table tables[] = {
+    {"__first", firstFunctions, firstValues},
+    {"shadowed", tableFunctions, nullptr},
+    {"other", tableFunctions, nullptr},
+    {"other", nullptr, firstValues},
+    {"__last", lastFunctions, nullptr},
+    {nullptr, nullptr, nullptr}
+  };
+  TValue val;
+
+  luaR_setrotables(tables);
+
+  // a "__" table shadows the tables after it, not the ones before it
+  EXPECT_TRUE(rotableEntry(luaR_findglobal("shadowed", &val), val) == (RotableEntry{ LUA_TLIGHTFUNCTION, (const void *)luaTestFunction1, 0 }));
+  EXPECT_TRUE(rotableEntry(luaR_findglobal("other", &val), val) == (RotableEntry{ LUA_TROTABLE, &tables[2], 0 }));
+  EXPECT_TRUE(rotableEntry(luaR_findglobal("late", &val), val) == (RotableEntry{ LUA_TLIGHTFUNCTION, (const void *)luaTestFunction1, 0 }));
+  EXPECT_TRUE(rotableEntry(luaR_findglobal("value", &val), val) == (RotableEntry{ LUA_TNUMBER, nullptr, 1 }));
+
+  // in a table the functions come first, then the first duplicate wins
+  EXPECT_TRUE(rotableEntry(luaR_findentry((void *)&tables[0], "dup", &val), val) == (RotableEntry{ LUA_TLIGHTFUNCTION, (const void *)luaTestFunction1, 0 }));
+  EXPECT_TRUE(rotableEntry(luaR_findentry((void *)&tables[3], "value", &val), val) == (RotableEntry{ LUA_TNUMBER, nullptr, 1 }));
+  EXPECT_FALSE(luaR_findentry((void *)&tables[3], "f", &val));
+  EXPECT_FALSE(luaR_findglobal("f", &val));
+
+  checkReadOnlyTablesIndex(tables);
+
+  luaR_setrotables(lua_rotable);
+  checkReadOnlyTablesIndex(lua_rotable);
+}
+
+TEST(Lua, testGetUsage)
+{
+  luaExecStr("usage, duration, allocated = getUsage()");
+  luaExecStr("if type(usage) ~= 'number' or type(duration) ~= 'number' or type(allocated) ~= 'number' then error('getUsage()') end");
+  luaExecStr("if duration ~= 0 or allocated ~= 0 then error('outside of a run') end");
+
+  LuaScriptUsage usage = {};
+  simuSetVirtualTimer(true);
+
+  // a first run which allocates a table and takes 2ms
+  luaStartUsage(usage, "test", 4);
+  luaExecStr("local t = {} for i = 1, 100 do t[i] = i end");
+  simuAdvanceVirtualTimer(2000);
+  luaStopUsage();
+
+  // the next run sees the longest run and the memory allocated by the previous one
+  luaStartUsage(usage, "test", 4);
+  luaExecStr("usage, duration, allocated = getUsage()");
+  luaStopUsage();
+  luaExecStr("if duration ~= 2000 then error('duration: ' .. duration) end");
+  luaExecStr("if allocated < 100 * 8 then error('allocated: ' .. allocated) end");
+
+  simuSetVirtualTimer(false);
+}
+
+TEST(Lua, testUsageDuration)
+{
+  LuaScriptUsage usage = {};
+  simuSetVirtualTimer(true);
+
+  // longer than a 2MHz timer period
+  luaStartUsage(usage, "slow_script", 11);
+  simuAdvanceVirtualTimer(40000);
+  luaStopUsage();
+  EXPECT_EQ(40000u, usage.duration);
+  EXPECT_EQ(40000u, luaGetMaxScriptDuration());
+  // the name is truncated to LUA_USAGE_NAME_LEN
+  EXPECT_STREQ("slow_scrip", luaGetMaxScriptName());
+
+  // a shorter run of another script doesn't change the longest one
+  LuaScriptUsage other = {};
+  luaStartUsage(other, "fast", 4);
+  simuAdvanceVirtualTimer(100);
+  luaStopUsage();
+  EXPECT_EQ(100u, other.duration);
+  EXPECT_STREQ("slow_scrip", luaGetMaxScriptName());
+
+  // the longest run of each script is reset with the statistics
+  luaResetUsage();
+  EXPECT_EQ(0u, luaGetMaxScriptDuration());
+  EXPECT_STREQ("", luaGetMaxScriptName());
+  luaStartUsage(usage, "slow_script", 11);
+  simuAdvanceVirtualTimer(1000);
+  luaStopUsage();
+  EXPECT_EQ(1000u, usage.duration);
+  EXPECT_EQ(1000u, luaGetMaxScriptDuration());
+
+  simuSetVirtualTimer(false);
+}
+
+TEST(Lua, testFindFieldByName)
+{
+  LuaField field;
+  MODEL_RESET();
+  TELEMETRY_RESET();
+
+  EXPECT_TRUE(luaFindFieldByName("ail", field));
+  EXPECT_EQ(MIXSRC_Ail, field.id);
+  EXPECT_TRUE(luaFindFieldByName("thr", field));
+  EXPECT_EQ(MIXSRC_Thr, field.id);
+  EXPECT_TRUE(luaFindFieldByName("tx-voltage", field));
+  EXPECT_EQ(MIXSRC_TX_VOLTAGE, field.id);
+  EXPECT_TRUE(luaFindFieldByName("ch12", field));
+  EXPECT_EQ(MIXSRC_CH1 + 11, field.id);
+  EXPECT_FALSE(luaFindFieldByName("tx", field));
+  EXPECT_FALSE(luaFindFieldByName("RxBt", field));
+
+  str2zchar(g_model.telemetrySensors[2].label, "RxBt", TELEM_LABEL_LEN);
+  str2zchar(g_model.telemetrySensors[5].label, "A", TELEM_LABEL_LEN);
+  str2zchar(g_model.telemetrySensors[7].label, "A-", TELEM_LABEL_LEN);
+  str2zchar(g_model.telemetrySensors[9].label, "RxBt", TELEM_LABEL_LEN);
+  invalidateTelemetrySensorsIndex();
+
+  EXPECT_TRUE(luaFindFieldByName("RxBt", field));
+  EXPECT_EQ(MIXSRC_FIRST_TELEM + 3*2, field.id);
+  EXPECT_TRUE(luaFindFieldByName("RxBt-", field));
+  EXPECT_EQ(MIXSRC_FIRST_TELEM + 3*2 + 1, field.id);
+  EXPECT_TRUE(luaFindFieldByName("RxBt+", field));
+  EXPECT_EQ(MIXSRC_FIRST_TELEM + 3*2 + 2, field.id);
+  EXPECT_TRUE(luaFindFieldByName("A-", field));
+  EXPECT_EQ(MIXSRC_FIRST_TELEM + 3*5 + 1, field.id);
+  EXPECT_FALSE(luaFindFieldByName("RxB", field));
+  EXPECT_FALSE(luaFindFieldByName("RxBt2", field));
+
+  // renamed sensor
+  str2zchar(g_model.telemetrySensors[2].label, "VFAS", TELEM_LABEL_LEN);
+  invalidateTelemetrySensorsIndex();
+  EXPECT_TRUE(luaFindFieldByName("RxBt", field));
+  EXPECT_EQ(MIXSRC_FIRST_TELEM + 3*9, field.id);
+  EXPECT_TRUE(luaFindFieldByName("VFAS", field));
+  EXPECT_EQ(MIXSRC_FIRST_TELEM + 3*2, field.id);
+
+  TELEMETRY_RESET();
+  invalidateTelemetrySensorsIndex();
+}
+
+#if defined(LUA_COMPILER) && defined(SIMU)
+static void writeTestScript(const char * path, const char * content)
+{
+  FIL file;
+  UINT written;
+  ASSERT_EQ(FR_OK, f_open(&file, path, FA_WRITE | FA_CREATE_ALWAYS));
+  f_write(&file, content, strlen(content), &written);
+  f_close(&file);
+}
+
+static int countCachedScripts()
+{
+  int count = 0;
+  DIR dir;
+  FILINFO fno;
+  if (f_opendir(&dir, SCRIPTS_CACHE_PATH) == FR_OK) {
+    while (f_readdir(&dir, &fno) == FR_OK && fno.fname[0]) {
+      if (strstr(fno.fname, SCRIPT_BIN_EXT))
+        count++;
+    }
+    f_closedir(&dir);
+  }
+  return count;
+}
+
+TEST(Lua, testCompiledScriptsCache)
+{
+  extern lua_State * lsScripts;
+  extern std::string simuSdDirectory;
+  if (!lsScripts) luaInit();
+  ASSERT_NE(nullptr, lsScripts);
+
+  char tmpl[] = "/tmp/opentx-luacache-XXXXXX";
+  ASSERT_NE(nullptr, mkdtemp(tmpl));
+  std::string sdDirectory = simuSdDirectory;
+  simuSdDirectory = tmpl;
+  f_mkdir(SCRIPTS_PATH);
+  const char * source = SCRIPTS_PATH "/cached" SCRIPT_EXT;
+  FILINFO fno;
+
+  // first load compiles the script into the cache, nothing is written beside the source
+  writeTestScript(source, "return 1");
+  EXPECT_EQ(SCRIPT_OK, luaLoadScriptFileToState(lsScripts, SCRIPTS_PATH "/cached", "bt"));
+  lua_pop(lsScripts, 1);
+  EXPECT_EQ(1, countCachedScripts());
+  EXPECT_NE(FR_OK, f_stat(SCRIPTS_PATH "/cached" SCRIPT_BIN_EXT, &fno));
+
+  // unchanged source: the cached version is loaded
+  EXPECT_EQ(SCRIPT_OK, luaLoadScriptFileToState(lsScripts, SCRIPTS_PATH "/cached", "bt"));
+  lua_pop(lsScripts, 1);
+  EXPECT_EQ(1, countCachedScripts());
+
+  // a new content gets its own compiled version, whatever the file dates, and replaces the previous one
+  writeTestScript(source, "return 22");
+  EXPECT_EQ(SCRIPT_OK, luaLoadScriptFileToState(lsScripts, SCRIPTS_PATH "/cached", "bt"));
+  EXPECT_EQ(LUA_OK, lua_pcall(lsScripts, 0, 1, 0));
+  EXPECT_EQ(22, lua_tointeger(lsScripts, -1));
+  lua_pop(lsScripts, 1);
+  EXPECT_EQ(1, countCachedScripts());
+
+  // a debug version of the same content is kept beside it
+  EXPECT_EQ(SCRIPT_OK, luaLoadScriptFileToState(lsScripts, SCRIPTS_PATH "/cached", "btd"));
+  lua_pop(lsScripts, 1);
+  EXPECT_EQ(2, countCachedScripts());
+
+  // the cached version is the one which is loaded again
+  EXPECT_EQ(SCRIPT_OK, luaLoadScriptFileToState(lsScripts, SCRIPTS_PATH "/cached", "bt"));
+  EXPECT_EQ(LUA_OK, lua_pcall(lsScripts, 0, 1, 0));
+  EXPECT_EQ(22, lua_tointeger(lsScripts, -1));
+  lua_pop(lsScripts, 1);
+
+  // an edit which keeps the size and the date of the file is seen
+  struct stat st;
+  std::string sourcePath = std::string(tmpl) + source;
+  ASSERT_EQ(0, stat(sourcePath.c_str(), &st));
+  writeTestScript(source, "return 44");
+  struct utimbuf times = { st.st_atime, st.st_mtime };
+  ASSERT_EQ(0, utime(sourcePath.c_str(), &times));
+  EXPECT_EQ(SCRIPT_OK, luaLoadScriptFileToState(lsScripts, SCRIPTS_PATH "/cached", "bt"));
+  EXPECT_EQ(LUA_OK, lua_pcall(lsScripts, 0, 1, 0));
+  EXPECT_EQ(44, lua_tointeger(lsScripts, -1));
+  lua_pop(lsScripts, 1);
+  EXPECT_EQ(1, countCachedScripts());
+
+  // the compiled version of a content used by another script is kept
+  const char * other = SCRIPTS_PATH "/other" SCRIPT_EXT;
+  writeTestScript(other, "return 44");
+  EXPECT_EQ(SCRIPT_OK, luaLoadScriptFileToState(lsScripts, SCRIPTS_PATH "/other", "bt"));
+  lua_pop(lsScripts, 1);
+  EXPECT_EQ(1, countCachedScripts());
+
+  // no automatic compilation with "x", the outdated version is kept for the other script
+  writeTestScript(source, "return 333");
+  EXPECT_EQ(SCRIPT_OK, luaLoadScriptFileToState(lsScripts, SCRIPTS_PATH "/cached", "btx"));
+  lua_pop(lsScripts, 1);
+  EXPECT_EQ(1, countCachedScripts());
+  writeTestScript(other, "return 5555");
+  EXPECT_EQ(SCRIPT_OK, luaLoadScriptFileToState(lsScripts, SCRIPTS_PATH "/other", "btx"));
+  lua_pop(lsScripts, 1);
+  EXPECT_EQ(0, countCachedScripts());
+
+  simuSdDirectory = sdDirectory;
+  std::string command = std::string("rm -rf ") + tmpl;
+  EXPECT_EQ(0, system(command.c_str()));
+}
+#endif
+
 #endif   // #if defined(LUA)
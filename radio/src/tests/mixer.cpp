@@ -476,6 +476,31 @@ TEST(Curves, LinearIntpol)
   EXPECT_EQ(applyCustomCurve(-192, 0), -192);
 }
 
+TEST(Curves, SmoothCurveFollowsEdits)
+{
+  SYSTEM_RESET();
+  MODEL_RESET();
+  MIXER_RESET();
+  modelDefault(0);
+  g_model.curves[0].smooth = 1;
+  for (int8_t i=-2; i<=2; i++) {
+    g_model.points[2+i] = 50*i;
+  }
+  loadCurves();
+  updateCurvesCache();
+  EXPECT_EQ(applyCustomCurve(-1024, 0), -1024);
+  EXPECT_EQ(applyCustomCurve(-192, 0), -192);
+  EXPECT_EQ(applyCustomCurve(1024, 0), 1024);
+
+  // points edited, the tangents are computed on the fly until the cache is rebuilt
+  g_model.points[1] = 0;
+  storageDirty(EE_MODEL);
+  int computed = applyCustomCurve(-384, 0);
+  updateCurvesCache();
+  EXPECT_EQ(applyCustomCurve(-384, 0), computed);
+  EXPECT_EQ(applyCustomCurve(-512, 0), 0);
+}
+
 
 
 TEST_F(MixerTest, InfiniteRecursiveChannels)
@@ -821,6 +846,91 @@ TEST_F(MixerTest, flightModeOverflow)
   CHECK_FLIGHT_MODE_TRANSITION(0, 1000, 1024, 1024);
 }
 
+TEST_F(MixerTest, flightModeTransitionSharedChannels)
+{
+  SYSTEM_RESET();
+  MODEL_RESET();
+  MIXER_RESET();
+  modelDefault(0);
+  g_model.flightModeData[1].swtch = TR(SWSRC_ID2, SWSRC_SA2);
+  g_model.flightModeData[0].fadeIn = 100;
+  g_model.flightModeData[0].fadeOut = 100;
+  g_model.flightModeData[1].fadeIn = 100;
+  g_model.flightModeData[1].fadeOut = 100;
+  g_model.mixData[0].destCh = 0;
+  g_model.mixData[0].mltpx = MLTPX_REP;
+  g_model.mixData[0].srcRaw = MIXSRC_CH3;
+  g_model.mixData[0].weight = 100;
+  g_model.mixData[1].destCh = 1;
+  g_model.mixData[1].mltpx = MLTPX_REP;
+  g_model.mixData[1].srcRaw = MIXSRC_MAX;
+  g_model.mixData[1].weight = 50;
+  g_model.mixData[2].destCh = 2;
+  g_model.mixData[2].mltpx = MLTPX_REP;
+  g_model.mixData[2].srcRaw = MIXSRC_MAX;
+  g_model.mixData[2].flightModes = 0b11110;
+  g_model.mixData[2].weight = 100;
+  g_model.mixData[3].destCh = 2;
+  g_model.mixData[3].mltpx = MLTPX_REP;
+  g_model.mixData[3].srcRaw = MIXSRC_MAX;
+  g_model.mixData[3].flightModes = 0b11101;
+  g_model.mixData[3].weight = -10;
+  evalMixes(1);
+  simuSetSwitch(0, 1);
+  for (int i = 0; i <= 1100; i++) {
+    evalMixes(1);
+    GTEST_ASSERT_LE(abs(channelOutputs[0] - channelOutputs[2]), 1);
+    GTEST_ASSERT_EQ(channelOutputs[1], 512);
+  }
+  EXPECT_LE(abs(channelOutputs[0] + 102), 1);
+  EXPECT_EQ(channelOutputs[2], -102);
+}
+
+TEST_F(MixerTest, planFollowsMixEdits)
+{
+  // CH1 reads CH2, which is computed first
+  g_model.mixData[0].destCh = 0;
+  g_model.mixData[0].srcRaw = MIXSRC_CH2;
+  g_model.mixData[0].weight = 100;
+  g_model.mixData[1].destCh = 1;
+  g_model.mixData[1].srcRaw = MIXSRC_MAX;
+  g_model.mixData[1].weight = 50;
+  evalFlightModeMixes(e_perout_mode_normal, 0);
+  EXPECT_EQ(chans[0], CHANNEL_MAX/2);
+  EXPECT_EQ(chans[1], CHANNEL_MAX/2);
+
+  // the CH2 line is moved to CH3, CH1 reads an empty channel
+  g_model.mixData[1].destCh = 2;
+  storageDirty(EE_MODEL);
+  evalFlightModeMixes(e_perout_mode_normal, 0);
+  EXPECT_EQ(chans[0], 0);
+  EXPECT_EQ(chans[1], 0);
+  EXPECT_EQ(chans[2], CHANNEL_MAX/2);
+
+  // CH1 now reads CH3, which has to be computed before it, as in the mix lines order with several passes
+  g_model.mixData[0].srcRaw = MIXSRC_CH3;
+  storageDirty(EE_MODEL);
+  evalFlightModeMixes(e_perout_mode_normal, 0);
+  EXPECT_EQ(chans[0], CHANNEL_MAX/2);
+  EXPECT_EQ(chans[2], CHANNEL_MAX/2);
+
+  // channels loop: CH3 reads CH1 as well
+  g_model.mixData[1].srcRaw = MIXSRC_CH1;
+  g_model.mixData[1].weight = 100;
+  storageDirty(EE_MODEL);
+  evalFlightModeMixes(e_perout_mode_normal, 0);
+  EXPECT_EQ(chans[0], 0);
+  EXPECT_EQ(chans[2], 0);
+
+  // the same model loaded in a reset mixer gives the same outputs
+  int32_t outputs[3] = { chans[0], chans[1], chans[2] };
+  MIXER_RESET();
+  evalFlightModeMixes(e_perout_mode_normal, 0);
+  EXPECT_EQ(outputs[0], chans[0]);
+  EXPECT_EQ(outputs[1], chans[1]);
+  EXPECT_EQ(outputs[2], chans[2]);
+}
+
 TEST_F(TrimsTest, throttleTrimWithCrossTrims)
 {
   g_model.thrTrim = 1;
@@ -969,3 +1079,63 @@ TEST_F(TrimsTest, invertedThrottlePlusThrottleTrimWithCrossTrims)
   EXPECT_EQ(channelOutputs[2], +1024);
   EXPECT_EQ(channelOutputs[1], 0);
 }
+
+TEST(MixerScheduler, waitTime)
+{
+  uint32_t now = 1000;
+  for (uint8_t i=0; i<NUM_MODULES; i++) {
+    nextMixerTime[i] = now + 100;
+  }
+  // no deadline soon
+  EXPECT_EQ((uint32_t)MIXER_TASK_MAX_WAIT_MS, getMixerTaskWaitTime(now));
+
+  // the earliest deadline
+  nextMixerTime[EXTERNAL_MODULE] = now + 3;
+  EXPECT_EQ(min<uint32_t>(3, MIXER_TASK_MAX_WAIT_MS), getMixerTaskWaitTime(now));
+
+  // a deadline already passed, wait as little as possible
+  nextMixerTime[EXTERNAL_MODULE] = now - 3;
+  EXPECT_EQ(1u, getMixerTaskWaitTime(now));
+
+  // across the wrap of the ms counter
+  now = UINT32_MAX - 1;
+  for (uint8_t i=0; i<NUM_MODULES; i++) {
+    nextMixerTime[i] = now + 100;
+  }
+  EXPECT_EQ((uint32_t)MIXER_TASK_MAX_WAIT_MS, getMixerTaskWaitTime(now));
+  nextMixerTime[EXTERNAL_MODULE] = now + 3;
+  EXPECT_EQ(min<uint32_t>(3, MIXER_TASK_MAX_WAIT_MS), getMixerTaskWaitTime(now));
+}
+
+TEST(MixerScheduler, deadlines)
+{
+  uint8_t protocol = moduleState[EXTERNAL_MODULE].protocol;
+  simuSetVirtualTimer(true);
+  uint32_t now = RTOS_GET_MS();
+
+  // synchronous module: one period after the previous deadline
+  moduleState[EXTERNAL_MODULE].protocol = PROTOCOL_CHANNELS_CROSSFIRE;
+  nextMixerTime[EXTERNAL_MODULE] = now;
+  scheduleNextMixerCalculation(EXTERNAL_MODULE, 4);
+  EXPECT_EQ(now + 4, nextMixerTime[EXTERNAL_MODULE]);
+
+  // more than a period late: one period from now
+  simuAdvanceVirtualTimer(10000);
+  scheduleNextMixerCalculation(EXTERNAL_MODULE, 4);
+  EXPECT_EQ(now + 10 + 4, nextMixerTime[EXTERNAL_MODULE]);
+
+  // asynchronous module: the mixer is done before the next frame
+  moduleState[EXTERNAL_MODULE].protocol = PROTOCOL_CHANNELS_PPM;
+  mixerDurationAverage = 3000;  // 1.5ms, rounded up
+  scheduleNextMixerCalculation(EXTERNAL_MODULE, 20);
+  EXPECT_EQ(now + 10 + 20 - 2, nextMixerTime[EXTERNAL_MODULE]);
+
+  // a mixer longer than the period still leaves 1ms
+  mixerDurationAverage = 20000;  // 10ms
+  scheduleNextMixerCalculation(EXTERNAL_MODULE, 4);
+  EXPECT_EQ(now + 10 + 1, nextMixerTime[EXTERNAL_MODULE]);
+
+  mixerDurationAverage = 0;
+  simuSetVirtualTimer(false);
+  moduleState[EXTERNAL_MODULE].protocol = protocol;
+}
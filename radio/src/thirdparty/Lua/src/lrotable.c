@@ -1,5 +1,6 @@
 /* Read-only tables for Lua */
 
+#include <stdlib.h>
 #include <string.h>
 #include "lua.h"
 #include "lauxlib.h"
@@ -9,6 +10,129 @@
 #define LUAR_FINDFUNCTION     0
 #define LUAR_FINDVALUE        1
 
+/*
+** Hash index of the names of all the read-only tables and of all their
+** entries. The tables are constant, so the index is built once, on first use.
+** Entries are numbered in lua_rotable order: first the table names, then for
+** each table its functions followed by its values.
+** The hash heads are static (512 bytes), the chains and the tables limits are
+** allocated once with the number of entries (2 bytes per entry and table).
+*/
+#define LUAR_HASH_SIZE        256   /* power of 2 */
+#define LUAR_NO_ENTRY         0xFFFF
+
+#define LUAR_INDEX_NONE       0
+#define LUAR_INDEX_VALID      1
+#define LUAR_INDEX_FAILED     2     /* no memory for the index, linear search is used */
+
+static const luaR_table * luaR_tables = lua_rotable;
+static uint8_t luaR_indexState = LUAR_INDEX_NONE;
+static uint16_t luaR_tablesCount;
+static uint16_t luaR_hash[LUAR_HASH_SIZE];
+static uint16_t * luaR_firstFunction;   /* luaR_tablesCount + 1 items */
+static uint16_t * luaR_firstValue;      /* luaR_tablesCount items */
+static uint16_t * luaR_next;            /* one item per entry */
+
+/* the table number is part of the hash, the table names use luaR_tablesCount */
+static unsigned luaR_hashkey(const char * key, unsigned table) {
+  unsigned h = 5381;
+  while (*key)
+    h = ((h << 5) + h) ^ (unsigned char)*key++;
+  return (h + table * 0x9E3779B1u) & (LUAR_HASH_SIZE - 1);
+}
+
+static void luaR_addentry(uint16_t entry, const char * name, unsigned table) {
+  unsigned h = luaR_hashkey(name, table);
+  luaR_next[entry] = luaR_hash[h];
+  luaR_hash[h] = entry;
+}
+
+static void luaR_buildindex(void) {
+  unsigned table, count = 0, tables;
+  const luaL_Reg * pf;
+  const luaR_value_entry * pv;
+  uint16_t * index;
+
+  for (table = 0; luaR_tables[table].name; table++)
+    count++;
+  tables = count;
+
+  for (table = 0; table < tables; table++) {
+    for (pf = luaR_tables[table].pfuncs; pf && pf->name; pf++)
+      count++;
+    for (pv = luaR_tables[table].pvalues; pv && pv->name; pv++)
+      count++;
+  }
+
+  index = count < LUAR_NO_ENTRY ? (uint16_t *)malloc((2 * tables + 1 + count) * sizeof(uint16_t)) : NULL;
+  if (!index) {
+    TRACE_ERROR("luaR_buildindex(): no memory for %d entries, linear search used\n", count);
+    luaR_indexState = LUAR_INDEX_FAILED;
+    return;
+  }
+  luaR_tablesCount = tables;
+  luaR_firstFunction = index;
+  luaR_firstValue = index + tables + 1;
+  luaR_next = index + 2 * tables + 1;
+
+  /* chains are built backwards, so that the first entry of a name wins as with a linear search */
+  memset(luaR_hash, 0xFF, sizeof(luaR_hash));
+  luaR_firstFunction[luaR_tablesCount] = count;
+  for (table = luaR_tablesCount; table-- > 0; ) {
+    const luaR_table * t = &luaR_tables[table];
+    unsigned functions = 0, values = 0;
+    for (pf = t->pfuncs; pf && pf->name; pf++)
+      functions++;
+    for (pv = t->pvalues; pv && pv->name; pv++)
+      values++;
+    count -= values;
+    luaR_firstValue[table] = count;
+    while (values-- > 0)
+      luaR_addentry(count + values, t->pvalues[values].name, table);
+    count -= functions;
+    luaR_firstFunction[table] = count;
+    while (functions-- > 0)
+      luaR_addentry(count + functions, t->pfuncs[functions].name, table);
+  }
+  for (table = luaR_tablesCount; table-- > 0; )
+    luaR_addentry(table, luaR_tables[table].name, luaR_tablesCount);
+
+  TRACE_LUA_INTERNALS("luaR_buildindex() %d entries", luaR_firstFunction[luaR_tablesCount]);
+  luaR_indexState = LUAR_INDEX_VALID;
+}
+
+#if defined(GTESTS)
+/* Replaces the read-only tables, the index is built again on next use */
+void luaR_setrotables(const luaR_table * tables) {
+  free(luaR_firstFunction);
+  luaR_firstFunction = luaR_firstValue = luaR_next = NULL;
+  luaR_tables = tables;
+  luaR_indexState = LUAR_INDEX_NONE;
+}
+#endif
+
+/* Find a key in a given table with the index, returns the entry number or LUAR_NO_ENTRY */
+static uint16_t luaR_findindex(unsigned table, const char * key) {
+  uint16_t entry = luaR_hash[luaR_hashkey(key, table)];
+  while (entry != LUAR_NO_ENTRY) {
+    const char * name = NULL;
+    if (table == luaR_tablesCount) {
+      if (entry < luaR_tablesCount)
+        name = luaR_tables[entry].name;
+    }
+    else if (entry >= luaR_firstFunction[table] && entry < luaR_firstFunction[table + 1]) {
+      if (entry < luaR_firstValue[table])
+        name = luaR_tables[table].pfuncs[entry - luaR_firstFunction[table]].name;
+      else
+        name = luaR_tables[table].pvalues[entry - luaR_firstValue[table]].name;
+    }
+    if (name && !strcmp(name, key))
+      return entry;
+    entry = luaR_next[entry];
+  }
+  return LUAR_NO_ENTRY;
+}
+
 /* Utility function: find a key in a given table (of functions or constants) */
 static luaR_result luaR_findkey(const void * where, const char * key, int type, TValue * found) {
   const char *pname;
@@ -42,16 +166,35 @@ luaR_result luaR_findglobal(const char * name, TValue * val) {
     TRACE_LUA_INTERNALS("luaR_findglobal('%s') = NAME TOO LONG", name);
     return 0;
   }
-  for (i=0; lua_rotable[i].name; i++) {
-    void * table = (void *)(&lua_rotable[i]);
-    if (!strcmp(lua_rotable[i].name, name)) {
+  if (luaR_indexState == LUAR_INDEX_NONE)
+    luaR_buildindex();
+  if (luaR_indexState == LUAR_INDEX_VALID) {
+    /* same priorities as the linear search below */
+    uint16_t entry = luaR_findindex(luaR_tablesCount, name);
+    for (i=0; i<luaR_tablesCount && i!=entry; i++) {
+      if (luaR_tables[i].name[0] == '_' && luaR_tables[i].name[1] == '_' && luaR_findentry((void *)(&luaR_tables[i]), name, val)) {
+        TRACE_LUA_INTERNALS("luaR_findglobal('%s') = FOUND in table '%s'", name, luaR_tables[i].name);
+        return 1;
+      }
+    }
+    if (entry != LUAR_NO_ENTRY) {
+      setrvalue(val, (void *)(&luaR_tables[entry]));
+      TRACE_LUA_INTERNALS("luaR_findglobal('%s') = TABLE %p (%s)", name, &luaR_tables[entry], luaR_tables[entry].name);
+      return 1;
+    }
+    TRACE_LUA_INTERNALS("luaR_findglobal() '%s' = NOT FOUND", name);
+    return 0;
+  }
+  for (i=0; luaR_tables[i].name; i++) {
+    void * table = (void *)(&luaR_tables[i]);
+    if (!strcmp(luaR_tables[i].name, name)) {
       setrvalue(val, table);
-      TRACE_LUA_INTERNALS("luaR_findglobal('%s') = TABLE %p (%s)", name, table, lua_rotable[i].name);
+      TRACE_LUA_INTERNALS("luaR_findglobal('%s') = TABLE %p (%s)", name, table, luaR_tables[i].name);
       return 1;
     }
-    if (!strncmp(lua_rotable[i].name, "__", 2)) {
+    if (!strncmp(luaR_tables[i].name, "__", 2)) {
       if (luaR_findentry(table, name, val)) {
-        TRACE_LUA_INTERNALS("luaR_findglobal('%s') = FOUND in table '%s'", name, lua_rotable[i].name);
+        TRACE_LUA_INTERNALS("luaR_findglobal('%s') = FOUND in table '%s'", name, luaR_tables[i].name);
         return 1;
       }
     }
@@ -63,6 +206,25 @@ luaR_result luaR_findglobal(const char * name, TValue * val) {
 
 luaR_result luaR_findentry(void *data, const char * key, TValue * val) {
   luaR_table * table = (luaR_table *)data;
+  if (luaR_indexState == LUAR_INDEX_NONE)
+    luaR_buildindex();
+  if (luaR_indexState == LUAR_INDEX_VALID) {
+    unsigned t = table - luaR_tables;
+    uint16_t entry = luaR_findindex(t, key);
+    if (entry == LUAR_NO_ENTRY) {
+      TRACE_LUA_INTERNALS("luaR_findentry(%p[%s], '%s') = NOT FOUND", table, table->name, key);
+      return 0;
+    }
+    if (entry < luaR_firstValue[t]) {
+      setlfvalue(val, table->pfuncs[entry - luaR_firstFunction[t]].func);
+      TRACE_LUA_INTERNALS("luaR_findentry(%p[%s], '%s') = FUNCTION %p", table, table->name, key, lfvalue(val));
+    }
+    else {
+      setnvalue(val, table->pvalues[entry - luaR_firstValue[t]].value);
+      TRACE_LUA_INTERNALS("luaR_findentry(%p[%s], '%s') = NUMBER %g", table, table->name, key, nvalue(val));
+    }
+    return 1;
+  }
   /* First look at the functions */
   if (luaR_findkey(table->pfuncs, key, LUAR_FINDFUNCTION, val)) {
     TRACE_LUA_INTERNALS("luaR_findentry(%p[%s], '%s') = FUNCTION %p", table, table->name, key, lfvalue(val));
@@ -33,5 +33,8 @@ extern const luaR_table lua_rotable[];
 
 luaR_result luaR_findglobal(const char * name, TValue * val);
 luaR_result luaR_findentry(void * data, const char * key, TValue * val);
+#if defined(GTESTS)
+void luaR_setrotables(const luaR_table * tables);
+#endif
 
 #endif
@@ -0,0 +1,187 @@
+#!/usr/bin/env python
+# -*- coding: utf-8 -*-
+
+# This program converts binary .otl logs (firmware built with LOGS_BINARY=YES) to the CSV logs format
+
+from __future__ import division, print_function
+
+import argparse
+import datetime
+import sys
+
+
+LOGS_MAGIC = b"OTLG"
+LOGS_BINARY_VERSION = 1
+
+LOGS_BLOCK_SCHEMA = ord('S')
+LOGS_BLOCK_RECORD = ord('R')
+LOGS_SCHEMA_END = 0xFF
+
+LOGS_FIELD_VALUE = 0
+LOGS_FIELD_TIME = 1
+LOGS_FIELD_RTC = 2
+LOGS_FIELD_GPS = 3
+LOGS_FIELD_DATETIME = 4
+LOGS_FIELD_SWITCHES = 5
+
+FIELD_VALUES_COUNT = {
+    LOGS_FIELD_VALUE: 1,
+    LOGS_FIELD_TIME: 1,
+    LOGS_FIELD_RTC: 2,
+    LOGS_FIELD_GPS: 2,
+    LOGS_FIELD_DATETIME: 2,
+    LOGS_FIELD_SWITCHES: 2,
+}
+
+
+class LogFormatError(Exception):
+    pass
+
+
+def formatPrec(value, prec):
+    if prec == 0:
+        return "%d" % value
+    divider = 10 ** prec
+    sign = "-" if value < 0 else ""
+    return "%s%d.%0*d" % (sign, abs(value) // divider, prec, abs(value) % divider)
+
+
+def formatGps(value):
+    sign = "-" if value < 0 else ""
+    return "%s%d.%06d" % (sign, abs(value) // 1000000, abs(value) % 1000000)
+
+
+def formatField(field, values):
+    fieldType, prec, label = field
+    if fieldType == LOGS_FIELD_TIME:
+        return "%d" % values[0]
+    elif fieldType == LOGS_FIELD_RTC:
+        t = datetime.datetime(1970, 1, 1) + datetime.timedelta(seconds=values[0])
+        return "%4d-%02d-%02d,%02d:%02d:%02d.%02d0" % (t.year, t.month, t.day, t.hour, t.minute, t.second, values[1])
+    elif fieldType == LOGS_FIELD_GPS:
+        if values[0] and values[1]:
+            return "%s %s" % (formatGps(values[0]), formatGps(values[1]))
+        return ""
+    elif fieldType == LOGS_FIELD_DATETIME:
+        packed = values[1]
+        return "%4d-%02d-%02d %02d:%02d:%02d" % (values[0], (packed >> 22) & 0x0F, (packed >> 17) & 0x1F, (packed >> 12) & 0x1F, (packed >> 6) & 0x3F, packed & 0x3F)
+    elif fieldType == LOGS_FIELD_SWITCHES:
+        return "0x%08X%08X" % (values[0] & 0xFFFFFFFF, values[1] & 0xFFFFFFFF)
+    else:
+        return formatPrec(values[0], prec)
+
+
+class LogReader:
+    def __init__(self, data):
+        self.data = bytearray(data)
+        self.pos = 0
+
+    def byte(self):
+        if self.pos >= len(self.data):
+            raise EOFError()
+        result = self.data[self.pos]
+        self.pos += 1
+        return result
+
+    def varint(self):
+        result = 0
+        shift = 0
+        while True:
+            b = self.byte()
+            result |= (b & 0x7F) << shift
+            if not b & 0x80:
+                return result
+            shift += 7
+
+    def schema(self):
+        fields = []
+        while True:
+            fieldType = self.byte()
+            if fieldType == LOGS_SCHEMA_END:
+                return fields
+            if fieldType not in FIELD_VALUES_COUNT:
+                raise LogFormatError("unknown field type %d at offset %d" % (fieldType, self.pos - 1))
+            prec = self.byte()
+            label = bytearray()
+            while True:
+                c = self.byte()
+                if c == 0:
+                    break
+                label.append(c)
+            fields.append((fieldType, prec, label.decode("latin-1")))
+
+    def record(self, values):
+        count = len(values)
+        changed = [self.byte() for i in range((count + 7) // 8)]
+        for i in range(count):
+            if changed[i // 8] & (1 << (i % 8)):
+                zigzag = self.varint()
+                delta = (zigzag >> 1) ^ -(zigzag & 1)
+                values[i] = ((values[i] + delta + 0x80000000) & 0xFFFFFFFF) - 0x80000000
+
+
+def convert(data, output):
+    if data[:len(LOGS_MAGIC)] != LOGS_MAGIC:
+        raise LogFormatError("not a binary log file")
+    if bytearray(data)[len(LOGS_MAGIC)] != LOGS_BINARY_VERSION:
+        raise LogFormatError("unsupported binary log version %d" % bytearray(data)[len(LOGS_MAGIC)])
+
+    reader = LogReader(data)
+    reader.pos = len(LOGS_MAGIC) + 1
+    fields = None
+    values = []
+    header = None
+    records = 0
+
+    try:
+        while reader.pos < len(reader.data):
+            start = reader.pos
+            block = reader.byte()
+            if block == LOGS_BLOCK_SCHEMA:
+                fields = reader.schema()
+                values = [0] * sum(FIELD_VALUES_COUNT[field[0]] for field in fields)
+                newHeader = ",".join(field[2] for field in fields)
+                if newHeader != header:
+                    header = newHeader
+                    output.write(header + "\n")
+            elif block == LOGS_BLOCK_RECORD and fields is not None:
+                reader.record(values)
+                columns = []
+                index = 0
+                for field in fields:
+                    count = FIELD_VALUES_COUNT[field[0]]
+                    columns.append(formatField(field, values[index:index + count]))
+                    index += count
+                output.write(",".join(columns) + "\n")
+                records += 1
+            else:
+                raise LogFormatError("unexpected block 0x%02X at offset %d" % (block, start))
+    except EOFError:
+        # the last record was not completely written (radio switched off while logging)
+        print("Warning: truncated record at offset %d" % start, file=sys.stderr)
+
+    return records
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Convert binary OpenTX logs to CSV")
+    parser.add_argument("input", help="binary log file (.otl)")
+    parser.add_argument("output", nargs="?", help="CSV file (default: stdout)")
+    args = parser.parse_args()
+
+    with open(args.input, "rb") as f:
+        data = f.read()
+
+    try:
+        if args.output:
+            with open(args.output, "w") as output:
+                convert(data, output)
+        else:
+            convert(data, sys.stdout)
+    except LogFormatError as e:
+        print("Error: %s" % e, file=sys.stderr)
+        sys.exit(1)
+
+
+if __name__ == "__main__":
+    main()